@@ -0,0 +1,47 @@
+// Assembly.h
+#ifndef _Assembly_HeaderFile
+#define _Assembly_HeaderFile
+
+#include <QString>
+#include <QVector>
+#include <TDocStd_Document.hxx>
+#include <TopLoc_Location.hxx>
+#include <TopoDS_Shape.hxx>
+
+#include "Tessellation.h"
+
+//! Assembly kept as unique parts (prototypes) plus located references to them.
+//! A part used N times is stored, meshed and presented once; an instance only adds a location.
+struct CadAssembly {
+    struct Prototype {
+        TopoDS_Shape shape;         // part without placement
+        QString name;
+        int instanceCount = 0;
+    };
+    struct Instance {
+        int prototype = -1;
+        TopLoc_Location location;   // absolute placement in the model
+    };
+
+    Handle(TDocStd_Document) document;  // XCAF document with names and product structure
+    QVector<Prototype> prototypes;
+    QVector<Instance> instances;
+
+    bool isEmpty() const { return instances.isEmpty(); }
+
+    //! Flatten the product tree of an XCAF document into prototypes and instances
+    static CadAssembly fromDocument(const Handle(TDocStd_Document)& theDoc);
+
+    //! XCAF documents are registered with the shared application; these serialize that access
+    static Handle(TDocStd_Document) newDocument();
+    static void closeDocument(const Handle(TDocStd_Document)& theDoc);
+
+    //! Mesh every prototype once, prototypes in parallel.
+    //! A model-relative deflection refers to the placed assembly, not to each part.
+    void meshPrototypes(const MeshParameters& theParams) const;
+
+    //! Compound of all instances; shares the prototype geometry instead of copying it
+    TopoDS_Shape toShape() const;
+};
+
+#endif // _Assembly_HeaderFile
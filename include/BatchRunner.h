@@ -0,0 +1,30 @@
+// BatchRunner.h
+#ifndef _BatchRunner_HeaderFile
+#define _BatchRunner_HeaderFile
+
+#include <QString>
+#include <QStringList>
+
+//! Headless load, measure and export run behind `CADViewer --batch in/*.step --out results/`.
+//! No window or GL context is created: files are read with the worker-safe CadModelManager
+//! readers, measured with the MeasurementManager helpers and processed concurrently
+//! (STEP/IGES transfers one at a time with OCCT before 7.8, see TransferLock).
+//! Each input gets the CSV written by File > Export CSV; summary.csv lists every file with timings.
+class BatchRunner
+{
+public:
+    //! True if the command line asks for batch mode; checked before any application object exists
+    static bool isRequested(int theArgc, char* theArgv[]);
+
+    //! Parse the arguments of the running QCoreApplication and process every input.
+    //! Returns the process exit code: 0 all files measured, 1 some failed, 2 usage error.
+    static int run(const QStringList& theArguments);
+
+    //! Supported files from the arguments; directories contribute their top-level CAD files
+    static QStringList collectInputs(const QStringList& theArguments, QStringList& theSkipped);
+    //! Output base name per file, suffixed where inputs from different folders share a name
+    //! or a name is in theReserved (case-insensitive)
+    static QStringList outputNames(const QStringList& theFiles, const QStringList& theReserved);
+};
+
+#endif // _BatchRunner_HeaderFile
@@ -3,23 +3,251 @@
 #define _CadModel_HeaderFile
 
 #include <QString>
+#include <QThreadPool>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QVector>
+#include <QElapsedTimer>
 #include <TopoDS_Shape.hxx>
+#include <Message_ProgressRange.hxx>
+
+#include "Assembly.h"
+#include "LazyAssembly.h"
+#include "LevelOfDetail.h"
+#include "LoadProgress.h"
+#include "Measurement.h"
+#include "MeshImport.h"
+#include "ShapeHealing.h"
+#include "StepPrescan.h"
+#include "Tessellation.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
 
 class OcctQWidgetViewer; // Forward declaration
 
+//! Receives each transferred root as soon as it exists; may be called from several threads
+using CadRootCallback = std::function<void(const TopoDS_Shape&)>;
+
+//! Loader settings, copied into each load so worker threads never touch the manager
+struct CadLoadOptions {
+    bool parallelTransfer = false;  // STEP with OCCT 7.8+: transfer roots concurrently into one compound
+    bool streamingDisplay = false;  // STEP/IGES: show each root as soon as it is transferred
+    bool assemblyInstancing = false; // STEP: XCAF product structure, each unique part meshed once
+    bool lazyAssembly = false;      // STEP: placeholders first, subassemblies transferred on request
+    bool useModelCache = true;      // STEP/IGES: reuse transferred shapes from the BinTools cache
+    bool shapeHealing = false;      // STEP/IGES: ShapeFix/ShapeUpgrade pass after the transfer, cached
+    qint64 healTimeBudgetMs = 60000; // parts not started by then stay as read, 0 = no limit
+    QString cacheDirectory;         // empty = ModelCache::defaultDirectory()
+    qint64 cacheMaxBytes = qint64(4) * 1024 * 1024 * 1024;
+    MeshParameters mesh;            // display tessellation, selects the cached triangulation level
+    bool progressiveMesh = false;   // coarse mesh first, finer levels swapped in from the background
+    bool levelOfDetail = false;     // coarser tessellations of every solid, picked by screen size
+    qint64 maxStepEntities = 0;     // refuse larger STEP files after the pre-scan, 0 = no limit
+    qint64 expectedEntities = 0;    // pre-scan hints weighting the progress of read vs transfer
+    qint64 expectedFaces = 0;
+};
+
+//! Wall time of each load pipeline stage in ms, -1 = stage did not run for this model.
+//! Read to mass properties run on the worker, topology and display on the GUI thread.
+struct CadStageTimings {
+    qint64 read = -1;           // file parse, or model cache load
+    qint64 transfer = -1;       // STEP/IGES entities to B-Rep
+    qint64 heal = -1;           // optional ShapeFix/ShapeUpgrade pass
+    qint64 mesh = -1;           // display tessellation
+    qint64 lod = -1;            // coarser per-solid tessellations for the level of detail
+    qint64 massProps = -1;      // origin, area, volume and bounding box of the whole model
+    qint64 topology = -1;       // face/edge index used by selection and measurements
+    qint64 display = -1;        // presentations and selection activation
+
+    QString summary() const;
+};
+
+//! Outcome of one load, filled on the worker thread and reported on the GUI thread
+struct CadLoadReport {
+    enum CacheState { CacheDisabled, CacheHit, CacheMiss };
+    CacheState cache = CacheDisabled;
+    QString cacheKey;               // content key of the source file, empty if uncached
+    bool meshFromCache = false;     // triangulation restored, display meshing is skipped
+    bool meshFromFile = false;      // STL/OBJ/PLY: the file is the triangulation, no B-Rep at all
+    MeshImportStats meshStats;
+    QVector<TopoDS_Shape> meshLevels; // progressive: unmeshed topology copies, one per refinement level
+    QVector<LodPart> lodParts;      // level of detail: the model's solids with their coarse levels
+    ShapeHealReport heal;           // valid when stages.heal >= 0 or heal.fromCache
+    CadStageTimings stages;
+    ModelMassProperties massProps;  // computed once per model, reused by every measurement update
+    StepPrescanResult prescan;      // STEP only
+    QString error;                  // user-facing reason when no shape is returned
+
+    QString summary() const;
+};
+
 class CadModelManager
 {
 public:
     explicit CadModelManager(OcctQWidgetViewer* viewer);
+    ~CadModelManager();
 
     bool loadCADModel(const QString& theFilePath);
     bool loadSTEPFile(const QString& theFilePath);
     bool loadIGESFile(const QString& theFilePath);
     bool loadBREPFile(const QString& theFilePath);
-    QString getFileFormatFromExtension(const QString& theFilePath) const;
+    static QString getFileFormatFromExtension(const QString& theFilePath);
+
+    // --- Asynchronous loading ---
+    //! Read and transfer the file on a worker thread; only the display step runs on the GUI thread.
+    //! The previous model stays displayed and interactive until the new one is ready.
+    bool loadCADModelAsync(const QString& theFilePath);
+    //! Load several files concurrently on a bounded pool into one scene, one presentation per file;
+    //! STEP/IGES transfers take turns with OCCT before 7.8, see TransferLock.
+    //! Throughput (files/s, MB/s) is reported through loadReport at the end.
+    bool loadCADModelsAsync(const QStringList& theFilePaths);
+    void cancelLoad();
+    bool isLoading() const { return !m_progress.IsNull(); }
+
+    const CadLoadOptions& loadOptions() const { return m_options; }
+    void setParallelTransfer(bool theEnabled) { m_options.parallelTransfer = theEnabled; }
+    void setStreamingDisplay(bool theEnabled) { m_options.streamingDisplay = theEnabled; }
+    void setAssemblyInstancing(bool theEnabled) { m_options.assemblyInstancing = theEnabled; }
+    void setLazyAssembly(bool theEnabled) { m_options.lazyAssembly = theEnabled; }
+    void setProgressiveMesh(bool theEnabled) { m_options.progressiveMesh = theEnabled; }
+
+    // --- Display quality ---
+    //! Scale the display deflection by theFactor (< 1 is finer). The displayed model is re-meshed
+    //! in the background on a copy, keeping the faces that meet the new tolerance already, and
+    //! swapped in place; the last few levels stay in memory so going back is immediate.
+    void setMeshQuality(double theFactor);
+    //! Drop the stored levels of the displayed model (it is being cleared)
+    void releaseMeshLevels();
+
+    // --- On-demand subassemblies (lazy assembly mode) ---
+    //! Transfer, mesh and display one placeholder in the background
+    void loadAssemblyNode(int theIndex);
+    void releaseLazyAssembly();
+    void setModelCacheEnabled(bool theEnabled) { m_options.useModelCache = theEnabled; }
+    void setShapeHealing(bool theEnabled) { m_options.shapeHealing = theEnabled; }
+    void setHealTimeBudget(qint64 theMs) { m_options.healTimeBudgetMs = theMs; }
+    void setMaxStepEntities(qint64 theMax) { m_options.maxStepEntities = theMax; }
+    void clearModelCache();
+
+    // --- Worker-safe readers (no viewer access) ---
+    //! Model cache lookup, falling back to the translator (and filling the cache) on a miss.
+    //! With shape healing the healed shape has cache entries of its own, next to the plain one.
+    //! theOnRoot only sees roots of a real transfer; a cache hit returns the whole shape at once.
+    static TopoDS_Shape loadShape(const QString& theFilePath, const QString& theFormat,
+                                  const CadLoadOptions& theOptions,
+                                  const Message_ProgressRange& theProgress,
+                                  CadLoadReport& theReport,
+                                  const CadRootCallback& theOnRoot = CadRootCallback());
+    //! Worker stages after the transfer: display mesh (unless the triangulation came with the
+    //! shape) and whole-model mass properties, timed into theReport. With progressive meshing
+    //! only a coarse level is built here, plus the copies the finer levels are meshed on.
+    static void prepareLoadedShape(const TopoDS_Shape& theShape, const CadLoadOptions& theOptions,
+                                   CadLoadReport& theReport);
+    //! Memory-mapped STEP pre-scan; fills progress hints and applies the complexity limit
+    static bool prescanStep(const QString& theFilePath, CadLoadOptions& theOptions, CadLoadReport& theReport);
+    //! STEP, IGES or BREP; mesh formats go through loadShape() alone. theStages, if given,
+    //! receives the read and transfer times
+    static TopoDS_Shape readShape(const QString& theFilePath, const QString& theFormat,
+                                  const CadLoadOptions& theOptions,
+                                  const Message_ProgressRange& theProgress,
+                                  const CadRootCallback& theOnRoot = CadRootCallback(),
+                                  CadStageTimings* theStages = nullptr);
+    static TopoDS_Shape readSTEPShape(const QString& theFilePath, const CadLoadOptions& theOptions,
+                                      const Message_ProgressRange& theProgress,
+                                      const CadRootCallback& theOnRoot = CadRootCallback(),
+                                      CadStageTimings* theStages = nullptr);
+    static TopoDS_Shape readIGESShape(const QString& theFilePath, const CadLoadOptions& theOptions,
+                                      const Message_ProgressRange& theProgress,
+                                      const CadRootCallback& theOnRoot = CadRootCallback(),
+                                      CadStageTimings* theStages = nullptr);
+    static TopoDS_Shape readBREPShape(const QString& theFilePath, const Message_ProgressRange& theProgress);
+    //! STEP through STEPCAFControl_Reader, prototypes meshed at the display deflection.
+    //! Bypasses the model cache, which holds flat shapes only.
+    static CadAssembly loadSTEPAssembly(const QString& theFilePath, const CadLoadOptions& theOptions,
+                                        const Message_ProgressRange& theProgress,
+                                        CadLoadReport& theReport);
 
 private:
+    bool checkFilePath(const QString& theFilePath);
+    //! Writes theShape on a worker thread: pass a copy, never the displayed shape
+    void storeMeshLevel(const QString& theKey, const TopoDS_Shape& theShape, const MeshParameters& theParams);
+    void displayLoadedModel(const QString& theFilePath, const TopoDS_Shape& theShape,
+                            const CadLoadReport& theReport);
+    void displayLoadedAssembly(const QString& theFilePath, const CadAssembly& theAssembly,
+                               const CadLoadReport& theReport);
+    void completeLoadedModel(const QString& theFilePath, const TopoDS_Shape& theShape,
+                             const CadLoadReport& theReport);
+    void onStreamedRoot(int theGeneration, const TopoDS_Shape& theRoot);
+    //! Mesh the report's level copies one after the other, each swapped into theShape when done
+    void refineMeshLevels(const QString& theCacheKey, const TopoDS_Shape& theShape,
+                          const QVector<TopoDS_Shape>& theLevels);
+    void onMeshLevelReady(int theGeneration, const QString& theCacheKey, const TopoDS_Shape& theShape,
+                          const TopoDS_Shape& theLevel, const MeshParameters& theParams, bool theIsFinal);
+    void stopMeshRefinement();
+
+    //! A display quality level meshed on a topology copy of the displayed model
+    struct MeshQualityLevel {
+        MeshParameters params;
+        TopoDS_Shape level;
+        int faces = 0;
+        int remeshedFaces = 0;
+        bool isFromCache = false;   // read from the model cache, not meshed
+        qint64 elapsedMs = 0;
+    };
+    void onMeshQualityReady(const TopoDS_Shape& theModel, const MeshQualityLevel& theLevel);
+    //! Start over with the levels of theModel, shown with theShown; a null model has none
+    void resetMeshLevels(const TopoDS_Shape& theModel, const MeshParameters& theShown, const QString& theCacheKey);
+    void rememberMeshLevel(const QString& theLevelKey, const TopoDS_Shape& theLevel);
+    void onLazyAssemblyOpened(int theGeneration, const QString& theFilePath,
+                              const std::shared_ptr<LazyStepAssembly>& theAssembly,
+                              const CadLoadReport& theReport, bool theIsCancelled);
+    void onBatchFileLoaded(int theGeneration, const QString& theFilePath, const TopoDS_Shape& theShape,
+                           qint64 theFileSize);
+    void onAssemblyNodeLoaded(const std::shared_ptr<LazyStepAssembly>& theAssembly, int theIndex,
+                              const TopoDS_Shape& theShape);
+    void onAsyncLoadDone(int theGeneration, const QString& theFilePath,
+                         const TopoDS_Shape& theShape, const CadAssembly& theAssembly,
+                         const CadLoadReport& theReport, bool theIsCancelled);
+
     OcctQWidgetViewer* m_viewer;
+
+    CadLoadOptions m_options;
+    QThreadPool m_loadPool;
+    Handle(LoadProgressIndicator) m_progress;
+    int m_loadGeneration = 0;
+    int m_streamedGeneration = 0;   // load whose pieces are on screen, 0 = none
+    QElapsedTimer m_loadTimer;
+
+    // Progressive meshing of the displayed model
+    QThreadPool m_refinePool;       // one level at a time, the mesher itself is parallel
+    std::shared_ptr<std::atomic_bool> m_refineCancel;
+    QThreadPool m_cachePool;        // triangulation cache writes, one at a time and never in a load's way
+    qint64 m_firstFrameMs = -1;
+
+    // Display quality levels of the displayed model, as meshed topology copies of it
+    TopoDS_Shape m_levelModel;      // model the levels belong to, null = not re-meshable
+    QString m_levelCacheKey;
+    MeshParameters m_shownMesh;     // tessellation on screen
+    QHash<QString, TopoDS_Shape> m_levelStore; // by MeshParameters::levelKey()
+    QStringList m_levelOrder;       // least recently shown first
+
+    // Multi-file load in flight
+    struct BatchState {
+        int total = 0;
+        int remaining = 0;
+        qint64 bytes = 0;
+        QVector<TopoDS_Shape> shapes;
+        QStringList failed;
+    };
+    BatchState m_batch;
+    QThreadPool m_batchPool;
+
+    std::shared_ptr<LazyStepAssembly> m_lazyAssembly;
+    QThreadPool m_nodePool;         // subassembly transfers, serialized by the assembly anyway
+    QSet<int> m_pendingNodes;
 };
 
 #endif // _CadModel_HeaderFile
@@ -4,6 +4,7 @@
 
 #include <QWidget>
 #include <QString>
+#include <QStringList>
 #include <QVector>
 #include <TopoDS_Face.hxx>
 #include <V3d_Viewer.hxx>
@@ -17,11 +18,15 @@
 #include <BRepAdaptor_Curve.hxx>
 #include <GeomAbs_CurveType.hxx>
 #include <TopTools_IndexedMapOfShape.hxx>
-#include <BRepMesh_IncrementalMesh.hxx>
 #include <AIS_TextLabel.hxx>
 #include <AIS_InteractiveObject.hxx>
 #include <gp_Pnt.hxx>
 
+#include "FrameScheduler.h"
+#include "Input.h"
+#include "StepPrescan.h"
+#include "Tessellation.h"
+
 class AIS_ViewCube;
 class QMouseEvent;
 class QKeyEvent;
@@ -76,9 +81,42 @@ public:
     bool loadIGESFile(const QString& theFilePath);
     bool loadBREPFile(const QString& theFilePath);
 
-    void meshShape(const TopoDS_Shape& theShape, double theDeflection = 0.05);
-    double getMeshDeflection() const { return myMeshLinearDeflection; }
-    void setMeshDeflection(double theDeflection) { myMeshLinearDeflection = theDeflection; }
+    // --- Asynchronous loading (progress via loadProgress signal) ---
+    bool loadCADModelAsync(const QString& theFilePath);
+    bool loadCADModelsAsync(const QStringList& theFilePaths);
+    void cancelLoad();
+    bool isLoading() const;
+    void setParallelTransfer(bool theEnabled);
+    void setStreamingDisplay(bool theEnabled);
+    void setAssemblyInstancing(bool theEnabled);
+    void setLazyAssembly(bool theEnabled);
+    void setProgressiveMesh(bool theEnabled);
+    void loadAssemblyNode(int theIndex);
+    void setModelCacheEnabled(bool theEnabled);
+    void setShapeHealing(bool theEnabled);
+    void setHealTimeBudget(qint64 theMs);
+    void clearModelCache();
+    void setMaxStepEntities(qint64 theMax);
+
+    //! Re-tessellate with the current mesh parameters; a displayed shape is redrawn
+    void meshShape(const TopoDS_Shape& theShape);
+    //! Linear deflection in the unit of the current MeshParameters::mode
+    double getMeshDeflection() const;
+    void setMeshDeflection(double theDeflection);
+    //! Used by the next display, load or meshShape() call
+    const MeshParameters& meshParameters() const;
+    void setMeshParameters(const MeshParameters& theParams);
+    //! Display deflection times theFactor; the displayed model is re-meshed in the background
+    void setMeshQuality(double theFactor);
+    //! Draw each solid at a tessellation level chosen from its size on screen (next load on)
+    void setLevelOfDetail(bool theEnabled);
+    //! Skip objects smaller than thePixels on screen (0 = off), optionally only while navigating
+    void setSizeCulling(double thePixels, bool theOnlyWhileMoving);
+    //! Draw a light representation while navigating when full frames are too slow
+    void setInteractionDegradation(bool theEnabled);
+    //! Lower MSAA and render resolution while navigating to hold theTargetMs per frame,
+    //! 0 for the display refresh interval
+    void setDynamicResolution(bool theEnabled, double theTargetMs);
 
     void clearAllShapes();
     void fitViewToModel();
@@ -91,6 +129,11 @@ public:
     QString getFileFormatFromExtension(const QString& theFilePath) const;
     void displayShape(const TopoDS_Shape& theShape);
     void updateView();
+    //! Frames drawn against redraws requested, and CPU use while idle
+    const FrameStats& frameStats() const;
+    //! Hover picks against cursor moves, with pick latency percentiles
+    HoverPickStats hoverStats() const;
+    void resetFrameStats();
 
     MeasurementData getMeasurements() const;
     QString getMeasurementString() const;
@@ -108,6 +151,13 @@ signals:
     void modelLoaded(const QString& theFileName);
     void errorOccurred(const QString& theMessage);
     void measurementsUpdated(const ModelProperties& props, const QString& pointData);
+    void loadStarted(const QString& theFileName);
+    void loadProgress(int thePercent, const QString& theStep);
+    void loadFinished(bool theSuccess);
+    void loadReport(const QString& theSummary);
+    void stepPrescanned(const StepPrescanResult& theResult);
+    void assemblyOpened(const QStringList& theNodeNames);  // lazy mode: placeholders shown
+    void assemblyNodeLoaded(int theIndex, bool theSuccess);
 
 protected:
     void initializeGL();
@@ -136,7 +186,6 @@ private:
     InputManager* m_input;
     EventManager* m_event;
 
-    Handle(BRepMesh_IncrementalMesh) myMesher;
     TopTools_IndexedMapOfShape myFaceMap;
     TopTools_IndexedMapOfShape myEdgeMap;
 
@@ -156,9 +205,8 @@ private:
 
     Handle(TDocStd_Document) myCADDocument;
     TopoDS_Shape myLoadedShape;
-    QVector<Handle(AIS_Shape)> myDisplayedShapes;
+    QVector<Handle(AIS_InteractiveObject)> myDisplayedShapes;  // AIS_Shape, or instances of assembly parts
 
-    double myMeshLinearDeflection = 0.05;
     QString myGlInfo;
     bool myHasTouchInput = false;
     bool myIsCoreProfile = true;
@@ -0,0 +1,76 @@
+// FrameScheduler.h
+#ifndef _FrameScheduler_HeaderFile
+#define _FrameScheduler_HeaderFile
+
+#include <QElapsedTimer>
+#include <QString>
+#include <QTimer>
+
+class QWidget;
+
+//! Frame counters since the last reset
+struct FrameStats {
+    qint64 requested = 0;       // redraws asked for, input and animation alike
+    qint64 coalesced = 0;       // requests merged into a frame already pending
+    qint64 rendered = 0;        // frames drawn
+    qint64 animationFrames = 0; // frames the view asked for itself (animation, inertia)
+    qint64 idleMs = 0;          // wall time with no frame pending
+    qint64 idleCpuMs = 0;       // process CPU time meanwhile, worker threads included
+    qint64 degradedFrames = 0;  // frames drawn in the light representation while navigating
+    int culled = 0;             // presentations skipped by size culling in the last frame
+
+    double idleCpuPercent() const { return idleMs > 0 ? 100.0 * idleCpuMs / idleMs : 0.0; }
+    QString summary() const;
+};
+
+//! Turns redraw requests into widget repaints: however many arrive, at most one frame per
+//! display refresh is drawn, frames the view asks for on its own are paced at the animation
+//! rate, and with nothing to draw no repaint (and no timer) is issued at all.
+class FrameScheduler
+{
+public:
+    explicit FrameScheduler(QWidget* theWidget);
+
+    //! The scene or camera changed
+    void requestFrame();
+    //! The view wants to go on drawing (view animation, smooth zoom, ...)
+    void requestAnimationFrame();
+
+    //! Bracket every paint of the widget
+    void frameStarted();
+    void frameFinished();
+    //! The paint returned without drawing (no view or GL window yet): retry a refresh later
+    void frameSkipped();
+
+    double maxAnimationFps() const { return myMaxAnimationFps; }
+    void setMaxAnimationFps(double theFps) { myMaxAnimationFps = theFps; }
+
+    const FrameStats& stats() const { return myStats; }
+    void resetStats();
+    void setCulled(int theCount) { myStats.culled = theCount; }
+    void countDegradedFrame() { ++myStats.degradedFrames; }
+
+    //! Wall time between frameStarted() and frameFinished() of the last frame
+    double lastFrameMs() const { return myLastFrameMs; }
+
+    //! One display refresh of the widget's screen
+    double refreshIntervalMs() const;
+
+private:
+    void schedule(double theIntervalMs);
+    void endIdle();
+
+    QWidget* myWidget;
+    QTimer myTimer;             // single shot, holds back a frame that would come too early
+    QElapsedTimer myClock;
+    qint64 myLastFrameNs = -1;
+    double myLastFrameMs = 0.0;
+    bool myIsPending = false;   // a repaint is on its way
+    bool myIsIdle = false;
+    qint64 myIdleStartMs = 0;
+    qint64 myIdleStartCpuMs = 0;
+    double myMaxAnimationFps = 60.0;
+    FrameStats myStats;
+};
+
+#endif // _FrameScheduler_HeaderFile
@@ -0,0 +1,31 @@
+// GlbExport.h
+#ifndef _GlbExport_HeaderFile
+#define _GlbExport_HeaderFile
+
+#include <QString>
+#include <TopoDS_Shape.hxx>
+
+struct GlbExportOptions {
+    bool quantize = false;      // KHR_mesh_quantization: int16 positions, int8 normals
+    double unitScale = 0.001;   // model units (mm) to glTF metres, applied on the root node
+};
+
+struct GlbExportStats {
+    int meshes = 0;
+    qint64 vertices = 0;
+    qint64 triangles = 0;
+    int skippedFaces = 0;       // faces without a triangulation
+    qint64 bytes = 0;
+};
+
+//! Binary glTF writer for the display triangulation of a shape.
+//! One mesh per solid (faces outside solids form one extra mesh), vertices welded per mesh.
+//! Meshes are streamed to disk one at a time; only the solid being written is held in memory.
+class GlbExport
+{
+public:
+    static bool write(const TopoDS_Shape& theShape, const QString& theFileName,
+                      const GlbExportOptions& theOptions, GlbExportStats& theStats, QString& theError);
+};
+
+#endif // _GlbExport_HeaderFile
@@ -2,11 +2,31 @@
 #ifndef _Input_HeaderFile
 #define _Input_HeaderFile
 
+#include <QElapsedTimer>
+#include <QString>
+#include <QTimer>
+#include <SelectMgr_EntityOwner.hxx>
+
+#include <vector>
+
 class OcctQWidgetViewer;
 class QKeyEvent;
 class QMouseEvent;
 class QWheelEvent;
 
+//! Hover preselection counters since the last reset
+struct HoverPickStats {
+    qint64 moves = 0;           // cursor moves without a button
+    qint64 picks = 0;           // MoveTo() runs; fewer than moves, the latest position wins
+    qint64 changes = 0;         // picks that detected another owner and redrew
+    double p50Ms = 0.0;         // latency from the cursor move to the pick result, recent picks
+    double p95Ms = 0.0;
+    double p99Ms = 0.0;
+    double maxMs = 0.0;
+
+    QString summary() const;
+};
+
 class InputManager
 {
 public:
@@ -18,8 +38,28 @@ public:
     void mouseMoveEvent(QMouseEvent* theEvent);
     void wheelEvent(QWheelEvent* theEvent);
 
+    HoverPickStats hoverStats() const;
+    void resetHoverStats();
+
 private:
+    //! Remember the cursor and pick at most once per display refresh
+    void scheduleHoverPick(int theX, int theY);
+    //! Preselect at the last cursor position; redraw only if the detected owner changed
+    void pickHover();
+    void cancelHoverPick();
+
     OcctQWidgetViewer* m_viewer;
+
+    QTimer myHoverTimer;                // single shot, paces the picks
+    QElapsedTimer myHoverClock;
+    int myHoverX = 0;
+    int myHoverY = 0;
+    qint64 myHoverMoveNs = 0;           // time of the move being picked
+    qint64 myLastPickNs = -1;
+    Handle(SelectMgr_EntityOwner) myHoveredOwner;
+    HoverPickStats myHoverStats;        // counters; percentiles are filled in by hoverStats()
+    std::vector<double> myPickLatencies; // ring of the most recent picks, ms
+    size_t myNextLatency = 0;
 };
 
 #endif // _Input_HeaderFile
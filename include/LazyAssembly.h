@@ -0,0 +1,53 @@
+// LazyAssembly.h
+#ifndef _LazyAssembly_HeaderFile
+#define _LazyAssembly_HeaderFile
+
+#include <QString>
+#include <QVector>
+#include <Bnd_Box.hxx>
+#include <Message_ProgressRange.hxx>
+#include <STEPControl_Reader.hxx>
+#include <TopoDS_Shape.hxx>
+
+#include "Tessellation.h"
+
+#include <memory>
+#include <mutex>
+
+//! Placeholder for one subassembly (a direct child of the top product)
+struct LazyAssemblyNode {
+    QString name;
+    Bnd_Box box;            // model units, from the points of the subtree; empty if none found
+    int partCount = 0;      // product occurrences in the subtree, the node itself included
+    bool isLoaded = false;  // GUI thread only
+};
+
+//! Parsed STEP model whose top-level subassemblies are transferred on demand.
+//! Opening builds only the product structure and point bounds of each subassembly;
+//! B-Rep construction and meshing happen per node when it is requested.
+class LazyStepAssembly
+{
+public:
+    //! Read the file and split it at the top product; null if there is nothing to split
+    static std::shared_ptr<LazyStepAssembly> open(const QString& theFilePath,
+                                                  const Message_ProgressRange& theProgress);
+
+    const QVector<LazyAssemblyNode>& nodes() const { return myNodes; }
+    void setLoaded(int theIndex) { myNodes[theIndex].isLoaded = true; }
+
+    //! Transfer and mesh one subassembly, placed in the top product.
+    //! Callable from any thread; transfers are serialized and parts shared between
+    //! subassemblies are built once.
+    //! A model-relative deflection refers to the extent of all placeholders.
+    TopoDS_Shape transferNode(int theIndex, const MeshParameters& theParams);
+
+private:
+    LazyStepAssembly() = default;
+
+    std::mutex myMutex;
+    STEPControl_Reader myReader;
+    QVector<Handle(Standard_Transient)> myUsages;  // NEXT_ASSEMBLY_USAGE_OCCURRENCE per node
+    QVector<LazyAssemblyNode> myNodes;
+};
+
+#endif // _LazyAssembly_HeaderFile
@@ -0,0 +1,73 @@
+// LevelOfDetail.h
+#ifndef _LevelOfDetail_HeaderFile
+#define _LevelOfDetail_HeaderFile
+
+#include <AIS_Shape.hxx>
+#include <Bnd_Box.hxx>
+#include <Graphic3d_Camera.hxx>
+#include <TopoDS_Shape.hxx>
+#include <QVector>
+
+#include <vector>
+
+#include "Tessellation.h"
+
+//! One solid of the model (or everything outside solids) with coarser tessellations of it
+struct LodPart {
+    TopoDS_Shape shape;                 // sub-shape of the model, selected and drawn at level 0
+    std::vector<TopoDS_Shape> levels;   // meshed topology copies with shape's placement, coarsest last
+    Bnd_Box box;                        // of shape, from its triangulation
+};
+
+//! AIS_Shape of one solid drawing one of its tessellation levels. Level 0 is the shape's own
+//! triangulation (the usual shaded mode, with face boundaries); level k > 0 is display mode
+//! THE_FIRST_LOD_MODE + k - 1, computed from LodPart::levels ahead of use (or on first use)
+//! and kept, so switching back and forth costs no recomputation. Selection always uses the shape itself.
+class LodShape : public AIS_Shape
+{
+    DEFINE_STANDARD_RTTI_INLINE(LodShape, AIS_Shape)
+
+public:
+    static const int THE_FIRST_LOD_MODE = 10;
+
+    explicit LodShape(const LodPart& thePart);
+
+    int level() const { return myLevel; }
+    int nbLevels() const { return int(myLevels.size()) + 1; }
+
+    //! Level for the current projected size of the solid; leaves the current level only once
+    //! the size is clearly past a threshold, so a solid hovering around it does not pop
+    int levelForSize(double thePixels) const;
+    void setLevel(int theLevel) { myLevel = theLevel; }
+    int displayModeOf(int theLevel) const { return theLevel == 0 ? AIS_Shaded : THE_FIRST_LOD_MODE + theLevel - 1; }
+
+    //! Diameter of the solid's bounding sphere on screen, in pixels of a viewport theHeight high
+    double projectedSize(const Handle(Graphic3d_Camera)& theCamera, int theHeight) const;
+
+    virtual Standard_Boolean AcceptDisplayMode(const Standard_Integer theMode) const Standard_OVERRIDE;
+
+protected:
+    virtual void Compute(const Handle(PrsMgr_PresentationManager)& thePrsMgr,
+                         const Handle(Prs3d_Presentation)& thePrs,
+                         const Standard_Integer theMode) Standard_OVERRIDE;
+
+private:
+    std::vector<TopoDS_Shape> myLevels;
+    gp_Pnt myCenter;
+    double myRadius = 0.0;
+    int myLevel = 0;
+};
+
+class LevelOfDetail
+{
+public:
+    //! Split theShape into its solids plus one part for the rest, and mesh coarser copies of
+    //! each unique solid in parallel. theShape must be meshed already (its triangulation gives
+    //! the boxes), and must not be displayed yet: copying reads its edges.
+    static QVector<LodPart> buildParts(const TopoDS_Shape& theShape, const MeshParameters& theParams);
+
+    //! Solids drawn at each level, finest first
+    static QString summary(const QVector<int>& theLevelCounts);
+};
+
+#endif // _LevelOfDetail_HeaderFile
@@ -0,0 +1,37 @@
+// LoadProgress.h
+#ifndef _LoadProgress_HeaderFile
+#define _LoadProgress_HeaderFile
+
+#include <Message_ProgressIndicator.hxx>
+#include <atomic>
+
+class OcctQWidgetViewer;
+
+//! Progress indicator bridging OCCT translator progress to the viewer.
+//! Show() may be called from a worker thread; updates are forwarded to the
+//! GUI thread as OcctQWidgetViewer::loadProgress() through queued invocation.
+class LoadProgressIndicator : public Message_ProgressIndicator
+{
+    DEFINE_STANDARD_RTTI_INLINE(LoadProgressIndicator, Message_ProgressIndicator)
+
+public:
+    explicit LoadProgressIndicator(OcctQWidgetViewer* theViewer);
+
+    //! Request cancellation; checked by OCCT algorithms through UserBreak().
+    void Cancel() { myIsCancelled = true; }
+    bool IsCancelled() const { return myIsCancelled; }
+
+    virtual Standard_Boolean UserBreak() override { return myIsCancelled; }
+
+protected:
+    virtual void Show(const Message_ProgressScope& theScope,
+                      const Standard_Boolean isForce) override;
+    virtual void Reset() override;
+
+private:
+    OcctQWidgetViewer* myViewer;
+    std::atomic<bool> myIsCancelled;
+    std::atomic<int>  myLastPercent;
+};
+
+#endif // _LoadProgress_HeaderFile
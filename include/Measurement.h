@@ -4,8 +4,21 @@
 
 #include <QString>
 #include <TopoDS_Shape.hxx>
+#include <gp_Pnt.hxx>
+#include <Bnd_Box.hxx>
 
 class OcctQWidgetViewer;
+struct ModelProperties;
+
+//! Whole-model results that do not depend on the selection
+struct ModelMassProperties {
+    bool hasOrigin = false;
+    gp_Pnt origin;      // centre of mass by volume, else by area, else by length
+    double area = 0.0;    // solids only with computeMassProperties(..., true)
+    double volume = 0.0;
+    double length = 0.0;  // wire models only
+    Bnd_Box box;        // from the triangulation when there is one
+};
 
 struct MeasurementData {
     QString type;           // "FACE", "EDGE", "SOLID"
@@ -27,10 +40,29 @@ public:
     MeasurementData getMeasurements() const { return m_data; }
     void extractMeshTopology();
     void clearLabels();
+    //! Mass properties computed by the load pipeline; calculateMeasurements() reuses them for theShape
+    void setModelMassProperties(const TopoDS_Shape& theShape, const ModelMassProperties& theProps);
+
+    // --- Viewer-independent helpers (safe on worker threads) ---
+    //! File name, size and folder; "-" for an empty path
+    static void fillFileProperties(const QString& theFilePath, ModelProperties& theProps);
+    //! Origin, volume and box of the whole shape, and its area for surface models or with
+    //! theWithArea; expensive, run once per model
+    static ModelMassProperties computeMassProperties(const TopoDS_Shape& theShape, bool theWithArea = false);
+    //! File metadata, origin, and area/volume of the whole model instead of a selection
+    static void computeModelProperties(const TopoDS_Shape& theShape, const QString& theFilePath,
+                                       ModelProperties& theProps);
+    //! Inspection CSV: metadata block, then one row per "ID|X|Y|Z|Distance|Curve" point line
+    static bool writeCSV(const QString& theFileName, const ModelProperties& theProps,
+                         const QString& thePointData);
 
 private:
     OcctQWidgetViewer* m_viewer;
     MeasurementData m_data;
+
+    // Whole-model cache, valid while the loaded shape is m_massShape
+    TopoDS_Shape m_massShape;
+    ModelMassProperties m_mass;
 };
 
 #endif // _Measurement_HeaderFile
@@ -0,0 +1,44 @@
+// MeshImport.h
+#ifndef _MeshImport_HeaderFile
+#define _MeshImport_HeaderFile
+
+#include <QString>
+#include <Message_ProgressRange.hxx>
+#include <Poly_Triangulation.hxx>
+#include <TopoDS_Shape.hxx>
+
+struct MeshImportStats {
+    qint64 fileSize = 0;
+    qint64 inputVertices = 0;   // as stored in the file (3 per facet for STL)
+    qint64 vertices = 0;        // after welding
+    qint64 triangles = 0;
+    qint64 parseMs = 0;
+    qint64 weldMs = 0;
+
+    double megabytesPerSecond() const;
+    QString summary() const;
+};
+
+//! STL (ASCII/binary), OBJ and PLY (ASCII/binary) reader for scan meshes.
+//! The file is memory-mapped, ASCII numbers use a dedicated float parser and coincident
+//! vertices are welded on a hash grid. No B-Rep is built: the result is a single
+//! Poly_Triangulation, wrapped in a surface-less face so that display, selection,
+//! measurement and export treat it like any other model.
+class MeshImport
+{
+public:
+    static bool isMeshFormat(const QString& theFormat);
+
+    static Handle(Poly_Triangulation) readTriangulation(const QString& theFilePath, const QString& theFormat,
+                                                        const Message_ProgressRange& theProgress,
+                                                        MeshImportStats& theStats, QString& theError);
+
+    static TopoDS_Shape read(const QString& theFilePath, const QString& theFormat,
+                             const Message_ProgressRange& theProgress,
+                             MeshImportStats& theStats, QString& theError);
+
+    //! Read an STL with this importer and with RWStl; one line with the MB/s of each
+    static QString benchmarkAgainstRWStl(const QString& theFilePath);
+};
+
+#endif // _MeshImport_HeaderFile
@@ -0,0 +1,53 @@
+// ModelCache.h
+#ifndef _ModelCache_HeaderFile
+#define _ModelCache_HeaderFile
+
+#include <QString>
+#include <TopoDS_Shape.hxx>
+#include <Message_ProgressRange.hxx>
+
+//! On-disk cache of transferred shapes in OCCT binary BRep format (BinTools).
+//! Entries are keyed by source file size, modification time and SHA-1 of the content.
+//! The entry file time doubles as LRU stamp, so the cache keeps no index and can be
+//! used from several worker threads at once.
+class ModelCache
+{
+public:
+    ModelCache(const QString& theDirectory, qint64 theMaxBytes);
+
+    //! Default location under the user cache directory
+    static QString defaultDirectory();
+
+    //! Cache key of a source file, empty if the file cannot be read
+    static QString keyForFile(const QString& theFilePath);
+
+    //! Key of a tessellated level of a model (MeshParameters::levelKey()); several levels per model coexist
+    static QString meshKey(const QString& theKey, const QString& theLevel);
+
+    //! Key of the healed geometry of a model; its tessellated levels derive from this key
+    static QString healedKey(const QString& theKey);
+
+    //! Read a cached shape; a corrupt entry is dropped and reported as a miss
+    bool load(const QString& theKey, TopoDS_Shape& theShape,
+              const Message_ProgressRange& theProgress = Message_ProgressRange()) const;
+
+    //! Write a shape and evict old entries above the size cap.
+    //! With theWithTriangles the face triangulations and edge polygons are stored too.
+    bool store(const QString& theKey, const TopoDS_Shape& theShape,
+               bool theWithTriangles = false) const;
+
+    //! Remove least recently used entries until the cache fits the size cap
+    void evict() const;
+
+    void clear() const;
+    qint64 totalBytes() const;
+    const QString& directory() const { return myDirectory; }
+
+private:
+    QString entryPath(const QString& theKey) const;
+
+    QString myDirectory;
+    qint64  myMaxBytes;
+};
+
+#endif // _ModelCache_HeaderFile
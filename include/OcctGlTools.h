@@ -81,7 +81,7 @@ private:
     //! Get native window handle from current GL context
     Aspect_Drawable GetGlNativeWindow(Aspect_Drawable theNativeWin);
 
-    //! Initialize GL window for view
+    //! Initialize GL window for view; theNativeWin 0 wraps the drawable the current context is bound to
     bool InitializeGlWindow(const Handle(V3d_View)& theView,
                            const Aspect_Drawable theNativeWin,
                            const Graphic3d_Vec2i& theSize,
@@ -10,6 +10,8 @@
 #include <QCheckBox>
 #include <QFileDialog>
 #include <QMessageBox>
+#include <QProgressBar>
+#include <QTreeWidget>
 #include "Core.h"
 
 class OcctQMainWindowSample : public QMainWindow
@@ -29,34 +31,59 @@ private slots:
     // --- NEW: Export Slots ---
     void exportToCSV();
     void exportToPDF();
+    void exportToGLB();
     // -------------------------
 
+    void onLoadStarted(const QString& theFileName);
+    void onLoadProgress(int thePercent, const QString& theStep);
+    void onLoadFinished(bool theSuccess);
+    void onStepPrescanned(const StepPrescanResult& theResult);
+
 private:
     void createMenuBar();
     void createLayoutOverViewer();
     void createDockWidgets();
     void loadCADModel();
+    void loadCADDirectory();
+    //! Row of the Info table, skipped when theValue is empty
+    void addPropertyRow(const QString& theName, const QString& theValue);
+    void appendPrescanRows();
     void clearAllShapes();
 
     // Member widgets
     OcctQWidgetViewer* myViewer = nullptr;
     QLabel* myStatusLabel = nullptr;
+    QProgressBar* myLoadProgressBar = nullptr;
+    QAction* myCancelLoadAction = nullptr;
 
     QDockWidget* myDockDescription = nullptr;
     QDockWidget* myDockModelData = nullptr;
     QDockWidget* myDockTools = nullptr;
+    QDockWidget* myDockAssembly = nullptr;
+    QTreeWidget* myAssemblyTree = nullptr;
 
     QTableWidget* myPropertiesTable = nullptr;
     QTableWidget* myPointsTable = nullptr;
     QTableWidget* mySelectionDataTable = nullptr;
     QCheckBox* mySelectionLockBox = nullptr;
     QCheckBox* myOriginVisBox = nullptr;
+    QCheckBox* myParallelTransferBox = nullptr;
+    QCheckBox* myStreamingDisplayBox = nullptr;
+    QCheckBox* myAssemblyInstancingBox = nullptr;
+    QCheckBox* myLazyAssemblyBox = nullptr;
+    QCheckBox* myModelCacheBox = nullptr;
+    QCheckBox* myShapeHealingBox = nullptr;
+    QCheckBox* myProgressiveMeshBox = nullptr;
+    QCheckBox* myLevelOfDetailBox = nullptr;
 
 
     // --- NEW: Data Storage for Export ---
     QString myLastPointData;
     ModelProperties myLastProps;
     // ------------------------------------
+
+    StepPrescanResult myLastPrescan;
+    QString myLastPrescanFile;
 };
 
 #endif // _OcctQMainWindowSample_HeaderFile
@@ -6,8 +6,22 @@
 #include <AIS_InteractiveContext.hxx>
 #include <V3d_View.hxx>
 #include <AIS_InteractiveObject.hxx> // Added for Handle(AIS_InteractiveObject)
+#include <AIS_Shape.hxx>
+#include <AIS_TextLabel.hxx>
+#include <Bnd_Box.hxx>
+#include <QTimer>
+#include <QVector>
+
+#include <vector>
+
+#include "FrameScheduler.h"
+#include "LevelOfDetail.h"
+#include "Tessellation.h"
 
 class OcctQWidgetViewer;
+struct CadAssembly;
+struct LazyAssemblyNode;
+struct CadStageTimings;
 class QPaintEvent;
 class QResizeEvent;
 class gp_Pnt;
@@ -20,30 +34,150 @@ public:
     void initializeGL();
     void paintEvent(QPaintEvent* theEvent);
     void resizeEvent(QResizeEvent* theEvent);
-    void displayShape(const TopoDS_Shape& theShape);
+    //! Replaces the current model; meshes only if no triangulation is attached yet, or never
+    //! when theToMesh is false (a coarse progressive level). theStages, if given, receives the
+    //! mesh, topology and display times. Every part of theLodParts, built by the load pipeline
+    //! with level of detail on, becomes a LodShape; without them the model is one AIS_Shape.
+    void displayShape(const TopoDS_Shape& theShape, CadStageTimings* theStages = nullptr, bool theToMesh = true,
+                      const QVector<LodPart>& theLodParts = QVector<LodPart>());
+    //! One presentation per unique part, instances connected to it with their placement
+    void displayAssembly(const CadAssembly& theAssembly);
     void clearAllShapes();
     void fitViewToModel();
+    //! Bounding box computed by the load pipeline, reused by fitViewToModel() for theShape
+    void setModelBox(const TopoDS_Shape& theShape, const Bnd_Box& theBox);
     void displayOriginAxis(); // Global 0,0,0
 
     // --- NEW: Display specific model origin ---
     void displayModelOrigin(const gp_Pnt& thePnt);
     // ------------------------------------------
 
-    void meshShape(const TopoDS_Shape& theShape, double theDeflection);
+    //! Tessellate with the current parameters and redisplay theShape if it is on screen
+    void meshShape(const TopoDS_Shape& theShape);
+    //! Swap the triangulation of theLevel, a meshed copy of theShape, into theShape and redisplay it
+    bool applyMeshLevel(const TopoDS_Shape& theShape, const TopoDS_Shape& theLevel);
     void dumpGlInfo(bool theIsBasic, bool theToPrint);
+    //! Ask for a redraw; requests are merged by the frame scheduler
     void updateView();
     void handleViewRedraw(const Handle(AIS_InteractiveContext)& theCtx,
                           const Handle(V3d_View)& theView);
     void setOriginTrihedronVisible(bool theVisible);
 
+    // --- Streaming display: one presentation per transferred root ---
+    void beginStreamedDisplay();
+    void appendStreamedShape(const TopoDS_Shape& thePiece);      // expects a meshed piece
+    void finishStreamedDisplay(const TopoDS_Shape& theWholeShape);
+
+    // --- Lazy assemblies: bounding box placeholders replaced by geometry on demand ---
+    void displayPlaceholders(const QVector<LazyAssemblyNode>& theNodes);
+    void replacePlaceholder(int theIndex, const TopoDS_Shape& theShape);  // expects a meshed shape
+
+    // Tessellation settings as configured in the Tools dock
+    const MeshParameters& meshParameters() const { return myMeshParams; }
+    void setMeshParameters(const MeshParameters& theParams) { myMeshParams = theParams; }
+    //! Deflection factor of the display quality, < 1 is finer than configured
+    double meshQuality() const { return myMeshQuality; }
+    void setMeshQuality(double theFactor) { myMeshQuality = theFactor; }
+    //! Tessellation used by displayShape() and the load pipeline; also keys the triangulation cache levels
+    MeshParameters displayMeshParameters() const { return myMeshParams.coarsened(myMeshQuality); }
+    //! theShape is on screen through its own presentations (a plain model or its LOD parts)
+    bool isModelDisplayed(const TopoDS_Shape& theShape) const;
+
+    const FrameStats& frameStats() const { return myScheduler.stats(); }
+    double refreshIntervalMs() const { return myScheduler.refreshIntervalMs(); }
+    void resetFrameStats() { myScheduler.resetStats(); }
+
+    //! Skip presentations whose projected bounding box is below thePixels, 0 = never;
+    //! with theOnlyWhileMoving everything is drawn again once the camera comes to rest
+    void setSizeCulling(double thePixels, bool theOnlyWhileMoving);
+
+    //! While navigating, draw a model slower than frameBudgetMs() lighter: opaque, LOD parts
+    //! at their coarsest level without face boundaries, far parts as boxes if that is still slow
+    void setInteractionDegradation(bool theEnabled);
+
+    //! While navigating, lower MSAA and then the render resolution to hold theTargetMs per
+    //! frame (0 = the display refresh, see frameBudgetMs()), the image upscaled to the window;
+    //! at rest one full-quality frame is drawn
+    void setDynamicResolution(bool theEnabled, double theTargetMs);
+
+    // View-dependent level of detail per solid, applied from the next load on
+    bool isLevelOfDetail() const { return myIsLodEnabled; }
+    void setLevelOfDetail(bool theEnabled) { myIsLodEnabled = theEnabled; }
 
 private:
+    Handle(AIS_Shape) createModelPresentation(const TopoDS_Shape& theShape) const;
+    void styleModelPresentation(const Handle(AIS_Shape)& theShapeAIS) const;
+    //! Pick each solid's level from its projected size; a no-op while camera and viewport stay put
+    void updateLevelsOfDetail(const Handle(V3d_View)& theView);
+    //! Compute the coarse presentations of the next LOD parts, a time slice per call
+    void precomputeLevelsOfDetail();
+    void activateModelSelection(const Handle(AIS_InteractiveObject)& theObject);
+    //! Rebuild the presentations of theShape from its current triangulation
+    void redisplayModel(const TopoDS_Shape& theShape);
+    //! Camera changed since the last frame: navigating until it rests for a moment
+    void updateNavigationState(const Handle(V3d_View)& theView);
+    void onNavigationChanged();
+    void applySizeCulling();
+    //! Culled presentations of the frame just drawn, from the OpenGL frame statistics
+    void updateCulledCount(const Handle(V3d_View)& theView);
+    //! Smoothed frame times at full quality and degraded, they decide the next switch
+    void recordFrameTime(double theMs);
+    void setDegraded(bool theIsDegraded);
+    //! Display mode of theLod in the light representation
+    int degradedDisplayMode(const Handle(LodShape)& theLod, double thePixels) const;
+    //! Resolution scale and MSAA of the view: the adapted ones while navigating, full at rest
+    void applyRenderResolution();
+    void adaptRenderResolution(double theMs);
+    //! Frame time that counts as keeping up: one display refresh (or a frame of the animation rate
+    //! cap, if longer) with some headroom, the buffer swap being part of every measured frame
+    double frameBudgetMs() const;
+
     OcctQWidgetViewer* m_viewer;
+    FrameScheduler myScheduler;
 
     // Track the specific object to allow updating it
     Handle(AIS_InteractiveObject) myModelOriginVis;
     bool myIsOriginVisible; // <--- ADD THIS
 
+    MeshParameters myMeshParams;
+    double myMeshQuality = 1.0;
+
+    Bnd_Box myStreamedBox;  // extent of the pieces streamed so far
+    TopoDS_Shape myBoxShape;  // shape myModelBox was computed for
+    Bnd_Box myModelBox;
+    QVector<Handle(AIS_Shape)> myPlaceholders;  // per lazy assembly node, null once loaded
+
+    bool myIsLodEnabled = false;
+    QVector<Handle(LodShape)> myLodShapes;      // also in myDisplayedShapes
+    Graphic3d_WorldViewProjState myLodCameraState;  // camera the levels were chosen for
+    int myLodViewHeight = 0;
+    QTimer myLodPrecomputeTimer;                // runs until every coarse level is computed
+    int myLodPrecomputed = 0;                   // parts of myLodShapes with all levels computed
+
+    Graphic3d_WorldViewProjState myNavCameraState;  // camera of the previous frame
+    QTimer myNavigationTimer;                       // single shot: the camera came to rest
+    bool myIsNavigating = false;
+    double myCullingPixels = 0.0;
+    bool myIsCullingWhileMoving = true;
+    bool myIsCullingActive = false;
+
+    bool myIsDegradationEnabled = false;
+    bool myIsDegraded = false;          // the light representation is on screen
+    bool myIsBoxingFarParts = false;    // even the coarsest meshes missed the frame budget
+    bool myIsFullRedraw = false;        // the frame being drawn redraws the whole scene
+    double myFullFrameMs = 0.0;
+    double myDegradedFrameMs = 0.0;     // coarse meshes, before any part became a box
+    std::vector<std::pair<Handle(AIS_Shape), double>> myFullTransparency;  // restored at rest
+    QTimer myRestoreTimer;              // single shot: full quality once the camera has rested
+
+    bool myIsDynamicResolution = false;
+    double myTargetFrameMs = 0.0;       // 0 = frameBudgetMs()
+    int myFullMsaa = 0;                 // the view's own MSAA, restored at rest
+    double myMotionScale = 1.0;         // kept for the next navigation, which starts from it
+    int myMotionMsaa = 0;
+    int myNbFastFrames = 0;             // in a row below the upscale threshold
+    Handle(AIS_TextLabel) myResolutionLabel;  // current scale, lower left corner of the view
+
 };
 
 #endif // _Render_HeaderFile
@@ -0,0 +1,43 @@
+// ShapeHealing.h
+#ifndef _ShapeHealing_HeaderFile
+#define _ShapeHealing_HeaderFile
+
+#include <QString>
+#include <Message_ProgressRange.hxx>
+#include <TopoDS_Shape.hxx>
+
+struct ShapeHealReport {
+    bool fromCache = false;     // healed shape restored from the model cache, nothing ran
+    int parts = 0;              // unique solids, free shells and free faces
+    int healedParts = 0;        // parts changed by ShapeFix or ShapeUpgrade
+    int skippedParts = 0;       // not started before the time budget ran out, left as read
+    int failedParts = 0;        // healing threw, left as read
+    int fixedSolids = 0;        // healed parts by kind
+    int fixedShells = 0;
+    int fixedFaces = 0;
+    int facesBefore = 0;
+    int facesAfter = 0;         // more than before when C0 surfaces were split
+    double maxToleranceBefore = 0.0;    // over the parts that ran
+    double maxToleranceAfter = 0.0;
+    qint64 elapsedMs = 0;
+
+    //! Every part was healed or found sound; only complete results are cached
+    bool isComplete() const { return skippedParts == 0 && failedParts == 0; }
+    QString summary() const;
+};
+
+//! ShapeFix / ShapeUpgrade pass for imported STEP and IGES geometry.
+//! Solids, shells outside solids and faces outside shells are healed independently on
+//! OSD_Parallel and substituted back with BRepTools_ReShape, so the model hierarchy and
+//! the placement of shared parts are kept. Each part is copied before fixing, which keeps
+//! in-place tolerance updates from racing on sub-shapes shared between parts.
+class ShapeHealing
+{
+public:
+    //! theTimeBudgetMs bounds when parts may start; a part already being fixed finishes.
+    //! 0 = no budget. Returns theShape itself when nothing needed a fix.
+    static TopoDS_Shape heal(const TopoDS_Shape& theShape, qint64 theTimeBudgetMs,
+                             const Message_ProgressRange& theProgress, ShapeHealReport& theReport);
+};
+
+#endif // _ShapeHealing_HeaderFile
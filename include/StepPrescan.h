@@ -0,0 +1,42 @@
+// StepPrescan.h
+#ifndef _StepPrescan_HeaderFile
+#define _StepPrescan_HeaderFile
+
+#include <QString>
+#include <QStringList>
+#include <QMap>
+#include <QVector>
+#include <QPair>
+
+//! Lightweight STEP summary gathered without building the StepData model
+struct StepPrescanResult {
+    bool isValid = false;
+    QString filePath;
+    qint64 fileSize = 0;
+    qint64 entityCount = 0;
+    QMap<QString, qint64> typeHistogram;  // entity type -> instances (complex parts counted each)
+    QStringList productNames;             // first PRODUCT names, see StepPrescan::MaxProductNames
+    qint64 productCount = 0;
+    QString schema;
+    QString lengthUnits;                  // e.g. "mm", "INCH"; several if the file mixes them
+    QString originatingSystem;
+    qint64 scanMs = 0;
+
+    //! Faces to be transferred, the dominant transfer cost
+    qint64 faceCount() const;
+
+    //! Most frequent types, largest first
+    QVector<QPair<QString, qint64>> topTypes(int theCount) const;
+};
+
+//! Single-pass scan of a memory-mapped STEP file (HEADER and DATA sections).
+//! Only statement boundaries, entity type names, PRODUCT names and units are parsed.
+class StepPrescan
+{
+public:
+    static const int MaxProductNames = 200;
+
+    static StepPrescanResult scan(const QString& theFilePath);
+};
+
+#endif // _StepPrescan_HeaderFile
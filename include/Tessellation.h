@@ -0,0 +1,100 @@
+// Tessellation.h
+#ifndef _Tessellation_HeaderFile
+#define _Tessellation_HeaderFile
+
+#include <QString>
+#include <Bnd_Box.hxx>
+#include <TopoDS_Shape.hxx>
+
+//! Display tessellation settings; copied into load workers like the rest of CadLoadOptions
+struct MeshParameters {
+    enum DeflectionMode {
+        AbsoluteDeflection, // deflection in model units
+        ModelRelative,      // fraction of the bounding box diagonal of the whole model
+        SolidRelative,      // fraction of the bounding box diagonal of each solid
+        TriangleBudget      // deflection and angle fitted to triangleBudget for the whole shape
+    };
+    DeflectionMode mode = ModelRelative;
+    double deflection = 0.0005;
+    double angle = 0.5;             // radians
+    qint64 triangleBudget = 5000000; // TriangleBudget only; deflection and angle are ignored
+    int threads = 0;                // 0 = all cores, 1 = no parallel meshing; caps separate parts only
+
+    //! Same parameters with ModelRelative turned into an absolute deflection for theModelBox;
+    //! used when pieces of a larger model are meshed one by one
+    MeshParameters resolvedFor(const Bnd_Box& theModelBox) const;
+    //! A coarser level: deflection times theFactor, and twice the angle (up to 1 rad) if theFactor > 1,
+    //! the angle times sqrt(theFactor) if it is < 1; a triangle budget is divided by theFactor instead
+    MeshParameters coarsened(double theFactor) const;
+    //! Names the cached triangulation level these parameters produce
+    QString levelKey() const;
+    QString summary() const;
+};
+
+struct MeshRunStats {
+    int parts = 0;                  // meshed independently of each other
+    double minDeflection = 0.0;     // absolute chord deflection used, over the parts
+    double maxDeflection = 0.0;
+    qint64 triangles = 0;           // whole shape after the run
+    int threads = 0;                // actually used: the cap, or all cores inside BRepMesh
+    qint64 elapsedMs = 0;
+
+    QString summary() const;
+};
+
+//! How a triangle budget was turned into a deflection and an angle
+struct MeshBudgetFit {
+    qint64 budget = 0;
+    double sampleDeflection = 0.0;  // of the sample mesh, absolute
+    qint64 sampleTriangles = 0;
+    qint64 fixedTriangles = 0;      // planar faces, about as many at any deflection
+    int curvedFaces = 0;
+    double deflection = 0.0;        // fitted, absolute
+    double angle = 0.0;
+    qint64 estimatedTriangles = 0;
+    qint64 elapsedMs = 0;
+
+    QString summary() const;
+};
+
+//! BRepMesh driven by IMeshTools_Parameters, with deflection relative to the model or to each solid.
+//! Solids (and faces outside solids) that share no edges are meshed concurrently on at most
+//! MeshParameters::threads threads; a shape that is a single part (or whose parts share edges)
+//! uses BRepMesh's own face-parallel mode, which runs on the whole default OSD_ThreadPool and
+//! cannot be capped, so there the setting only chooses between one thread and all cores.
+//! Parts used several times are meshed once.
+class Tessellation
+{
+public:
+    //! Mesh theShape in place and log triangle count and wall time; faces whose
+    //! triangulation already meets the tolerance are kept
+    static bool mesh(const TopoDS_Shape& theShape, const MeshParameters& theParams, MeshRunStats& theStats);
+    static bool mesh(const TopoDS_Shape& theShape, const MeshParameters& theParams);
+
+    //! Every face carries a triangulation at least as fine as theParams asks for
+    static bool isMeshed(const TopoDS_Shape& theShape, const MeshParameters& theParams);
+
+    //! Absolute chord deflection for theShape as a whole; not defined for a triangle budget
+    static double absoluteDeflection(const TopoDS_Shape& theShape, const MeshParameters& theParams);
+
+    //! theParams with ModelRelative and TriangleBudget turned into an absolute deflection for
+    //! theShape as a whole, for meshing pieces of it one by one
+    static MeshParameters resolve(const TopoDS_Shape& theShape, const MeshParameters& theParams);
+
+    //! Absolute deflection and angle expected to give theShape theParams.triangleBudget triangles.
+    //! A coarse sample mesh of a copy measures each face: planar faces cost a fixed count, curved
+    //! ones scale with 1 / deflection by what the sample, or their area times curvature if the
+    //! sample is too coarse to tell, says. One deflection over the model then spreads the budget
+    //! in proportion to area and curvature; the angle follows the deflection.
+    static MeshParameters fitToBudget(const TopoDS_Shape& theShape, const MeshParameters& theParams,
+                                      MeshBudgetFit& theFit);
+
+    static qint64 countTriangles(const TopoDS_Shape& theShape);
+
+    //! Replace the face triangulations and edge polygons of theTo by those of theFrom,
+    //! a topology copy of it (BRepBuilderAPI_Copy). Lets a level be meshed on a copy in the
+    //! background while theTo stays displayed and selectable; the swap itself is cheap.
+    static bool transferTriangulation(const TopoDS_Shape& theFrom, const TopoDS_Shape& theTo);
+};
+
+#endif // _Tessellation_HeaderFile
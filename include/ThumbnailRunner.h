@@ -0,0 +1,30 @@
+// ThumbnailRunner.h
+#ifndef _ThumbnailRunner_HeaderFile
+#define _ThumbnailRunner_HeaderFile
+
+#include <QString>
+#include <QStringList>
+
+//! Headless PNG thumbnails behind `CADViewer --thumbnails in/ --out thumbs/ --size 256 --view iso`.
+//! Files are loaded and meshed concurrently on a worker pool (STEP/IGES transfers one at a time
+//! with OCCT before 7.8, see TransferLock); one offscreen GL context, view and
+//! framebuffer object render them one after the other on the main thread, so GL setup is paid
+//! once per run. Meshes go through the model cache at a deflection matched to the image size,
+//! so a second run over the same files skips the transfer and the meshing.
+//! No window is created; on a server without a display run it under xvfb-run (Mesa llvmpipe is
+//! fine), or use an OCCT build with EGL and QT_QPA_PLATFORM=eglfs.
+class ThumbnailRunner
+{
+public:
+    //! True if the command line asks for thumbnails; checked before any application object exists
+    static bool isRequested(int theArgc, char* theArgv[]);
+
+    //! Qt platform and GL format for offscreen rendering; call before the QGuiApplication
+    static void platformSetup();
+
+    //! Parse the arguments of the running QGuiApplication and render every input.
+    //! Returns the process exit code: 0 all thumbnails written, 1 some failed, 2 usage or GL error.
+    static int run(const QStringList& theArguments);
+};
+
+#endif // _ThumbnailRunner_HeaderFile
@@ -0,0 +1,27 @@
+// TransferLock.h
+#ifndef _TransferLock_HeaderFile
+#define _TransferLock_HeaderFile
+
+#include <mutex>
+
+//! Serializes STEP and IGES transfers across files. Up to OCCT 7.7 a STEP transfer keeps the
+//! length and angle units of each representation context in the process-wide
+//! StepData_GlobalFactors, and IGES transfers set static unit factors in every version, so two
+//! files with different units (mm and inch) must not transfer at once. Reading and meshing
+//! stay concurrent: hold the lock around the transfer call only.
+class TransferLock
+{
+public:
+    enum Format { Step, Iges };
+
+    //! Blocks until no other transfer that shares unit state is running
+    explicit TransferLock(Format theFormat);
+
+    //! Roots of one file may be transferred concurrently (STEP with OCCT 7.8 or later)
+    static bool isParallelSafe(Format theFormat);
+
+private:
+    std::unique_lock<std::mutex> myLock;
+};
+
+#endif // _TransferLock_HeaderFile
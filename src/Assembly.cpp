@@ -0,0 +1,156 @@
+// Assembly.cpp
+#include "Assembly.h"
+#include "OcctQtTools.h"
+
+#include <BRep_Builder.hxx>
+#include <BRepBndLib.hxx>
+#include <Message.hxx>
+#include <NCollection_DataMap.hxx>
+#include <TDataStd_Name.hxx>
+#include <TDF_LabelMapHasher.hxx>
+#include <TDF_LabelSequence.hxx>
+#include <TopoDS_Compound.hxx>
+#include <XCAFApp_Application.hxx>
+#include <XCAFDoc_DocumentTool.hxx>
+#include <XCAFDoc_ShapeTool.hxx>
+
+#include <QElapsedTimer>
+
+#include <mutex>
+#include <vector>
+
+namespace
+{
+    std::mutex THE_XCAF_APP_MUTEX;
+
+    typedef NCollection_DataMap<TDF_Label, int, TDF_LabelMapHasher> LabelIndexMap;
+
+    QString labelName(const TDF_Label& theLabel)
+    {
+        Handle(TDataStd_Name) aName;
+        if (theLabel.FindAttribute(TDataStd_Name::GetID(), aName)) {
+            return OcctQtTools::qtStringFromOcctExt(aName->Get());
+        }
+        return QString();
+    }
+
+    void collectInstances(const TDF_Label& theLabel, const TopLoc_Location& theParentLoc,
+                          CadAssembly& theAssembly, LabelIndexMap& thePrototypeIndex)
+    {
+        TDF_Label aLabel = theLabel;
+        TopLoc_Location aLoc = theParentLoc;
+        if (XCAFDoc_ShapeTool::IsReference(aLabel)) {
+            TDF_Label aReferred;
+            if (!XCAFDoc_ShapeTool::GetReferredShape(aLabel, aReferred)) return;
+            aLoc = theParentLoc * XCAFDoc_ShapeTool::GetLocation(aLabel);
+            aLabel = aReferred;
+        }
+
+        if (XCAFDoc_ShapeTool::IsAssembly(aLabel)) {
+            TDF_LabelSequence aComponents;
+            XCAFDoc_ShapeTool::GetComponents(aLabel, aComponents, Standard_False);
+            for (TDF_LabelSequence::Iterator anIter(aComponents); anIter.More(); anIter.Next()) {
+                collectInstances(anIter.Value(), aLoc, theAssembly, thePrototypeIndex);
+            }
+            return;
+        }
+
+        const TopoDS_Shape aShape = XCAFDoc_ShapeTool::GetShape(aLabel);
+        if (aShape.IsNull()) return;
+
+        int anIndex = -1;
+        if (!thePrototypeIndex.Find(aLabel, anIndex)) {
+            anIndex = theAssembly.prototypes.size();
+            thePrototypeIndex.Bind(aLabel, anIndex);
+
+            CadAssembly::Prototype aPrototype;
+            aPrototype.shape = aShape.Located(TopLoc_Location());
+            aPrototype.name = labelName(aLabel);
+            theAssembly.prototypes.append(aPrototype);
+        }
+        ++theAssembly.prototypes[anIndex].instanceCount;
+
+        CadAssembly::Instance anInstance;
+        anInstance.prototype = anIndex;
+        anInstance.location = aLoc * aShape.Location();
+        theAssembly.instances.append(anInstance);
+    }
+}
+
+CadAssembly CadAssembly::fromDocument(const Handle(TDocStd_Document)& theDoc)
+{
+    CadAssembly anAssembly;
+    anAssembly.document = theDoc;
+    if (theDoc.IsNull()) return anAssembly;
+
+    Handle(XCAFDoc_ShapeTool) aShapeTool = XCAFDoc_DocumentTool::ShapeTool(theDoc->Main());
+    TDF_LabelSequence aFreeShapes;
+    aShapeTool->GetFreeShapes(aFreeShapes);
+
+    LabelIndexMap aPrototypeIndex;
+    for (TDF_LabelSequence::Iterator anIter(aFreeShapes); anIter.More(); anIter.Next()) {
+        collectInstances(anIter.Value(), TopLoc_Location(), anAssembly, aPrototypeIndex);
+    }
+
+    Message::SendInfo() << "Assembly: " << anAssembly.instances.size() << " instances of "
+                        << anAssembly.prototypes.size() << " unique parts";
+    return anAssembly;
+}
+
+Handle(TDocStd_Document) CadAssembly::newDocument()
+{
+    std::lock_guard<std::mutex> aLock(THE_XCAF_APP_MUTEX);
+    Handle(TDocStd_Document) aDoc;
+    XCAFApp_Application::GetApplication()->NewDocument("MDTV-XCAF", aDoc);
+    return aDoc;
+}
+
+void CadAssembly::closeDocument(const Handle(TDocStd_Document)& theDoc)
+{
+    if (theDoc.IsNull()) return;
+
+    std::lock_guard<std::mutex> aLock(THE_XCAF_APP_MUTEX);
+    XCAFApp_Application::GetApplication()->Close(theDoc);
+}
+
+void CadAssembly::meshPrototypes(const MeshParameters& theParams) const
+{
+    QElapsedTimer aTimer;
+    aTimer.start();
+
+    Bnd_Box aModelBox;
+    if (theParams.mode == MeshParameters::ModelRelative) {
+        std::vector<Bnd_Box> aPartBoxes(prototypes.size());
+        for (int anIdx = 0; anIdx < prototypes.size(); ++anIdx) {
+            BRepBndLib::Add(prototypes.at(anIdx).shape, aPartBoxes[anIdx], Standard_False);
+        }
+        for (const Instance& anInstance : instances) {
+            const Bnd_Box& aPartBox = aPartBoxes[anInstance.prototype];
+            if (!aPartBox.IsVoid()) aModelBox.Add(aPartBox.Transformed(anInstance.location.Transformation()));
+        }
+    }
+
+    // One run over all prototypes: the mesher spreads their solids over the threads
+    BRep_Builder aBuilder;
+    TopoDS_Compound aPrototypes;
+    aBuilder.MakeCompound(aPrototypes);
+    for (const Prototype& aPrototype : prototypes) {
+        aBuilder.Add(aPrototypes, aPrototype.shape);
+    }
+    Tessellation::mesh(aPrototypes, theParams.resolvedFor(aModelBox));
+    Message::SendInfo() << "Meshed " << prototypes.size() << " unique parts for "
+                        << instances.size() << " instances in " << aTimer.elapsed() << " ms";
+}
+
+TopoDS_Shape CadAssembly::toShape() const
+{
+    if (isEmpty()) return TopoDS_Shape();
+
+    BRep_Builder aBuilder;
+    TopoDS_Compound aCompound;
+    aBuilder.MakeCompound(aCompound);
+    for (const Instance& anInstance : instances) {
+        aBuilder.Add(aCompound, prototypes.at(anInstance.prototype).shape.Located(anInstance.location));
+    }
+    return aCompound;
+}
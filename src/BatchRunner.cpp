@@ -0,0 +1,296 @@
+// BatchRunner.cpp
+#include "BatchRunner.h"
+#include "CadModel.h"
+#include "Core.h"
+#include "Measurement.h"
+#include "MeshImport.h"
+#include "TransferLock.h"
+
+#include <Message.hxx>
+#include <Message_Messenger.hxx>
+#include <Message_Printer.hxx>
+#include <Standard_Failure.hxx>
+
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+    struct BatchFileResult {
+        QString filePath;
+        QString csvPath;
+        bool isDone = false;
+        QString error;
+        qint64 fileSize = 0;
+        qint64 loadMs = 0;
+        qint64 measureMs = 0;
+        ModelProperties props;
+    };
+
+    QString csvField(const QString& theValue)
+    {
+        if (theValue.contains(',') || theValue.contains('"') || theValue.contains('\n')) {
+            QString aQuoted = theValue;
+            aQuoted.replace("\"", "\"\"");
+            return "\"" + aQuoted + "\"";
+        }
+        return theValue;
+    }
+
+    bool writeSummary(const QString& theFileName, const std::vector<BatchFileResult>& theResults)
+    {
+        QFile aFile(theFileName);
+        if (!aFile.open(QIODevice::WriteOnly | QIODevice::Text)) return false;
+
+        QTextStream out(&aFile);
+        out << "File,Status,Size (bytes),Load (ms),Measure (ms),Origin X,Origin Y,Origin Z,"
+               "Area,Volume,CSV,Error\n";
+        for (const BatchFileResult& aResult : theResults) {
+            out << csvField(aResult.filePath) << ","
+                << (aResult.isDone ? "ok" : "failed") << ","
+                << aResult.fileSize << ","
+                << aResult.loadMs << ","
+                << aResult.measureMs << ",";
+            if (aResult.isDone) {
+                out << QString::number(aResult.props.originX, 'f', 6) << ","
+                    << QString::number(aResult.props.originY, 'f', 6) << ","
+                    << QString::number(aResult.props.originZ, 'f', 6) << ","
+                    << QString::number(aResult.props.area, 'f', 6) << ","
+                    << QString::number(aResult.props.volume, 'f', 6) << ","
+                    << csvField(aResult.csvPath) << ",";
+            } else {
+                out << ",,,,,,";
+            }
+            out << csvField(aResult.error) << "\n";
+        }
+        aFile.close();
+        return aFile.error() == QFileDevice::NoError;
+    }
+}
+
+QStringList BatchRunner::collectInputs(const QStringList& theArguments, QStringList& theSkipped)
+{
+    QStringList aFiles;
+    for (const QString& anArg : theArguments) {
+        const QFileInfo anInfo(anArg);
+        if (anInfo.isDir()) {
+            const QDir aDir(anArg);
+            const QStringList aNames = aDir.entryList(QStringList() << "*.step" << "*.stp" << "*.iges"
+                                                                    << "*.igs" << "*.brep" << "*.stl"
+                                                                    << "*.obj" << "*.ply",
+                                                      QDir::Files, QDir::Name);
+            for (const QString& aName : aNames) aFiles << aDir.absoluteFilePath(aName);
+        } else if (anInfo.isFile() && CadModelManager::getFileFormatFromExtension(anArg) != "UNKNOWN") {
+            aFiles << anInfo.absoluteFilePath();
+        } else {
+            theSkipped << anArg;
+        }
+    }
+    aFiles.removeDuplicates();
+    return aFiles;
+}
+
+QStringList BatchRunner::outputNames(const QStringList& theFiles, const QStringList& theReserved)
+{
+    QSet<QString> aUsedNames;
+    for (const QString& aName : theReserved) aUsedNames.insert(aName.toLower());
+
+    QStringList aNames;
+    for (const QString& aFile : theFiles) {
+        const QString aBase = QFileInfo(aFile).completeBaseName();
+        QString aName = aBase;
+        for (int aSuffix = 2; aUsedNames.contains(aName.toLower()); ++aSuffix) {
+            aName = QString("%1_%2").arg(aBase).arg(aSuffix);
+        }
+        aUsedNames.insert(aName.toLower());
+        aNames << aName;
+    }
+    return aNames;
+}
+
+bool BatchRunner::isRequested(int theArgc, char* theArgv[])
+{
+    for (int anIdx = 1; anIdx < theArgc; ++anIdx) {
+        if (std::strcmp(theArgv[anIdx], "--batch") == 0) return true;
+    }
+    return false;
+}
+
+int BatchRunner::run(const QStringList& theArguments)
+{
+    QCommandLineParser aParser;
+    aParser.setApplicationDescription("Load, measure and export CAD files without a display.");
+    aParser.addHelpOption();
+    const QCommandLineOption aBatchOption("batch", "Run headless on the given files or directories.");
+    const QCommandLineOption anOutOption(QStringList() << "o" << "out", "Directory for the CSV files.", "dir");
+    const QCommandLineOption aJobsOption(QStringList() << "j" << "jobs",
+                                         "Files processed concurrently (default: CPU cores); with OCCT before 7.8 "
+                                         "STEP/IGES transfers still run one at a time.", "n");
+    const QCommandLineOption aNoCacheOption("no-cache", "Bypass the model cache.");
+    const QCommandLineOption aVerboseOption("verbose", "Print the reader messages.");
+    const QCommandLineOption aBenchMeshOption("bench-mesh", "After the batch, time the STL reader against OCCT's RWStl on each STL input, one file at a time.");
+    const QCommandLineOption aHealOption("heal", "Heal STEP/IGES shapes after the transfer (cached).");
+    aParser.addOptions({ aBatchOption, anOutOption, aJobsOption, aNoCacheOption, aVerboseOption, aBenchMeshOption,
+                         aHealOption });
+    aParser.addPositionalArgument("inputs", "STEP, IGES, BREP, STL, OBJ or PLY files, or directories containing them.",
+                                  "[inputs...]");
+    aParser.process(theArguments);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QStringList aSkipped;
+    const QStringList aFiles = collectInputs(aParser.positionalArguments(), aSkipped);
+    for (const QString& aPath : aSkipped) {
+        err << "Skipped (not a supported CAD file): " << aPath << "\n";
+    }
+    if (aFiles.isEmpty() || !aParser.isSet(anOutOption)) {
+        err << (aFiles.isEmpty() ? "No input files.\n" : "Missing --out directory.\n");
+        err << aParser.helpText();
+        return 2;
+    }
+
+    const QDir anOutDir(aParser.value(anOutOption));
+    if (!anOutDir.mkpath(".")) {
+        err << "Cannot create output directory " << anOutDir.path() << "\n";
+        return 2;
+    }
+
+    int aJobs = QThread::idealThreadCount();
+    if (aParser.isSet(aJobsOption)) {
+        bool isOk = false;
+        aJobs = aParser.value(aJobsOption).toInt(&isOk);
+        if (!isOk || aJobs < 1) {
+            err << "Invalid --jobs value: " << aParser.value(aJobsOption) << "\n";
+            return 2;
+        }
+    }
+
+    // The per-file lines are the progress output; reader chatter only on request
+    if (!aParser.isSet(aVerboseOption)) {
+        const Message_SequenceOfPrinters& aPrinters = Message::DefaultMessenger()->Printers();
+        for (Message_SequenceOfPrinters::Iterator anIter(aPrinters); anIter.More(); anIter.Next()) {
+            anIter.Value()->SetTraceLevel(Message_Warning);
+        }
+    }
+
+    const bool isBenchMesh = aParser.isSet(aBenchMeshOption);
+    CadLoadOptions anOptions;
+    anOptions.useModelCache = !aParser.isSet(aNoCacheOption);
+    anOptions.shapeHealing = aParser.isSet(aHealOption);
+    // Files are the unit of parallelism, as in the interactive multi-file open
+    anOptions.parallelTransfer = false;
+
+    // Output names are fixed up-front so same-named inputs from different folders do not collide
+    std::vector<BatchFileResult> aResults(aFiles.size());
+    const QStringList aNames = outputNames(aFiles, QStringList() << "summary");
+    for (int anIdx = 0; anIdx < aFiles.size(); ++anIdx) {
+        aResults[anIdx].filePath = aFiles.at(anIdx);
+        aResults[anIdx].csvPath = anOutDir.absoluteFilePath(aNames.at(anIdx) + ".csv");
+    }
+
+    out << "Processing " << aFiles.size() << " files on " << aJobs << " threads\n";
+    out.flush();
+
+    std::mutex anOutputMutex;
+    int aFinished = 0;
+    QElapsedTimer aTotalTimer;
+    aTotalTimer.start();
+
+    QThreadPool aPool;
+    aPool.setMaxThreadCount(aJobs);
+    for (int anIdx = 0; anIdx < aFiles.size(); ++anIdx) {
+        aPool.start([&, anIdx]() {
+            BatchFileResult& aResult = aResults[anIdx];
+            const QString aFormat = CadModelManager::getFileFormatFromExtension(aResult.filePath);
+            aResult.fileSize = QFileInfo(aResult.filePath).size();
+
+            QElapsedTimer aTimer;
+            aTimer.start();
+            try {
+                CadLoadOptions aLoadOptions = anOptions;
+                CadLoadReport aReport;
+                TopoDS_Shape aShape;
+                if (aFormat != "STEP" || CadModelManager::prescanStep(aResult.filePath, aLoadOptions, aReport)) {
+                    aShape = CadModelManager::loadShape(aResult.filePath, aFormat, aLoadOptions,
+                                                        Message_ProgressRange(), aReport);
+                }
+                aResult.loadMs = aTimer.restart();
+
+                if (aShape.IsNull()) {
+                    aResult.error = aReport.error.isEmpty() ? QString("No shape could be read") : aReport.error;
+                } else {
+                    MeasurementManager::computeModelProperties(aShape, aResult.filePath, aResult.props);
+                    if (MeasurementManager::writeCSV(aResult.csvPath, aResult.props, QString())) {
+                        aResult.isDone = true;
+                    } else {
+                        aResult.error = "Could not write " + aResult.csvPath;
+                    }
+                    aResult.measureMs = aTimer.elapsed();
+                }
+            } catch (const Standard_Failure& e) {
+                aResult.error = QString("OCCT error: ") + e.GetMessageString();
+            }
+
+            std::lock_guard<std::mutex> aLock(anOutputMutex);
+            ++aFinished;
+            out << QString("[%1/%2] %3 %4 ms (load %5, measure %6)  %7")
+                       .arg(aFinished, QString::number(aFiles.size()).size())
+                       .arg(aFiles.size())
+                       .arg(aResult.isDone ? QString("ok    ") : QString("FAILED"))
+                       .arg(aResult.loadMs + aResult.measureMs, 7)
+                       .arg(aResult.loadMs)
+                       .arg(aResult.measureMs)
+                       .arg(QFileInfo(aResult.filePath).fileName());
+            if (!aResult.isDone) out << "  " << aResult.error;
+            out << "\n";
+            out.flush();
+        });
+    }
+    aPool.waitForDone();
+
+    int aNbDone = 0;
+    qint64 aBytes = 0;
+    for (const BatchFileResult& aResult : aResults) {
+        if (aResult.isDone) ++aNbDone;
+        aBytes += aResult.fileSize;
+    }
+
+    const QString aSummaryPath = anOutDir.absoluteFilePath("summary.csv");
+    if (!writeSummary(aSummaryPath, aResults)) {
+        err << "Could not write " << aSummaryPath << "\n";
+    }
+
+    const double aSeconds = std::max(aTotalTimer.elapsed(), qint64(1)) / 1000.0;
+    out << QString("%1 of %2 files in %3 s, %4 files/s, %5 MB/s%6; summary: %7\n")
+               .arg(aNbDone).arg(aFiles.size())
+               .arg(aSeconds, 0, 'f', 1)
+               .arg(aFiles.size() / aSeconds, 0, 'f', 1)
+               .arg(aBytes / (1024.0 * 1024.0) / aSeconds, 0, 'f', 1)
+               .arg(TransferLock::isParallelSafe(TransferLock::Step) ? QString()
+                                                                     : QString(" (STEP/IGES transfers serialized)"))
+               .arg(aSummaryPath);
+
+    // One at a time once the pool is idle: timings taken next to other loads would measure contention
+    if (isBenchMesh) {
+        for (const BatchFileResult& aResult : aResults) {
+            if (CadModelManager::getFileFormatFromExtension(aResult.filePath) != "STL") continue;
+            out << QFileInfo(aResult.filePath).fileName() << ": "
+                << MeshImport::benchmarkAgainstRWStl(aResult.filePath) << "\n";
+            out.flush();
+        }
+    }
+    return aNbDone == aFiles.size() ? 0 : 1;
+}
@@ -2,23 +2,236 @@
 #include "CadModel.h"
 #include "Core.h"
 #include "OcctQtTools.h"
+#include "ModelCache.h"
+#include "Render.h"
+#include "ShapeHealing.h"
+#include "StepPrescan.h"
+#include "TransferLock.h"
 
 // OCCT File I/O Headers
 #include <BRep_Builder.hxx>
 #include <STEPControl_Reader.hxx>
+#include <STEPCAFControl_Reader.hxx>
 #include <IGESControl_Reader.hxx>
 #include <IFSelect_ReturnStatus.hxx>
 #include <BRepTools.hxx>
+#include <BRepBuilderAPI_Copy.hxx>
+#include <BRep_Tool.hxx>
+#include <TopExp.hxx>
+#include <TopoDS.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <TopoDS_Compound.hxx>
+#include <XSControl_WorkSession.hxx>
+#include <Interface_InterfaceModel.hxx>
 #include <Message.hxx>
+#include <Message_ProgressScope.hxx>
 #include <OSD.hxx>
+#include <OSD_Parallel.hxx>
 #include <QFileInfo>
+#include <QMetaObject>
+#include <QElapsedTimer>
+#include <QThread>
+
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <vector>
+
+namespace
+{
+    //! Progressive meshing: the first frame uses the display deflection times the coarse factor,
+    //! then one background level per refine factor, the last one being the display quality
+    const double THE_COARSE_MESH_FACTOR = 16.0;
+    const double THE_REFINE_FACTORS[] = { 4.0, 1.0 };
+
+    //! Display quality levels kept in memory per model, the shown one included
+    const int THE_MAX_MESH_LEVELS = 4;
+
+    //! theFiner asks for at least the detail of theCoarser, so a mesh of theCoarser can be refined
+    //! in place; otherwise (coarser, or another mode) the faces are meshed from scratch
+    bool isAtLeastAsFine(const MeshParameters& theFiner, const MeshParameters& theCoarser)
+    {
+        if (theFiner.mode != theCoarser.mode) return false;
+        if (theFiner.mode == MeshParameters::TriangleBudget) {
+            return theFiner.triangleBudget >= theCoarser.triangleBudget;
+        }
+        return theFiner.deflection <= theCoarser.deflection && theFiner.angle <= theCoarser.angle;
+    }
+
+    //! ReadFile() reports no progress; without a pre-scan weight it as a quarter of the load,
+    //! otherwise from entity and face counts at rough single-core rates
+    void stepProgressWeights(const CadLoadOptions& theOptions, double& theReadWeight, double& theTransferWeight)
+    {
+        theReadWeight = 1.0;
+        theTransferWeight = 3.0;
+        if (theOptions.expectedEntities > 0) {
+            theReadWeight = theOptions.expectedEntities / 250000.0;
+            theTransferWeight = std::max<qint64>(theOptions.expectedFaces, 1) / 2000.0;
+        }
+    }
+
+    //! Transfer the roots of an already read model concurrently, where TransferLock::isParallelSafe().
+    //! Each task gets its own work session and TransientProcess over the same model, so no
+    //! transfer state is shared between threads; an entity shared between roots (a part used in
+    //! several of them) is therefore built once per task that meets it, not once overall.
+    //! Roots are interleaved across tasks to balance uneven root sizes. theOnRoot, if set, runs
+    //! on the task threads.
+    template<class ReaderType>
+    TopoDS_Shape transferRootsInParallel(ReaderType& theReader, const Message_ProgressRange& theProgress,
+                                         const CadRootCallback& theOnRoot)
+    {
+        const Handle(Interface_InterfaceModel) aModel = theReader.Model();
+        const Standard_Integer aNbRoots = theReader.NbRootsForTransfer();
+        if (aNbRoots <= 1) {
+            theReader.TransferRoots(theProgress);
+            const TopoDS_Shape aShape = theReader.OneShape();
+            if (theOnRoot && !aShape.IsNull()) theOnRoot(aShape);
+            return aShape;
+        }
+
+        const int aNbTasks = std::min<int>(aNbRoots, OSD_Parallel::NbLogicalProcessors() * 4);
+        Message::SendInfo() << "Parallel transfer: " << aNbRoots << " roots in " << aNbTasks << " tasks";
+
+        // Ranges must be created up-front to be used from several threads
+        Message_ProgressScope aPS(theProgress, "Transferring roots", aNbRoots);
+        std::vector<Message_ProgressRange> aRanges;
+        aRanges.reserve(aNbRoots);
+        for (Standard_Integer aRoot = 1; aRoot <= aNbRoots; ++aRoot) {
+            aRanges.push_back(aPS.Next());
+        }
+
+        std::vector<TopoDS_Shape> aShapes(aNbRoots);
+        std::vector<qint64> aTimesMs(aNbRoots, 0);
+
+        OSD_Parallel::For(0, aNbTasks, [&](int theTask) {
+            Handle(XSControl_WorkSession) aWS = new XSControl_WorkSession();
+            ReaderType aWorker(aWS, Standard_True);
+            aWS->SetModel(aModel, Standard_False);
+            aWS->InitTransferReader(4);
+            aWorker.NbRootsForTransfer();
+
+            for (Standard_Integer aRoot = theTask + 1; aRoot <= aNbRoots; aRoot += aNbTasks) {
+                Message_ProgressRange& aRange = aRanges[aRoot - 1];
+                if (aRange.UserBreak()) return;
+
+                QElapsedTimer aTimer;
+                aTimer.start();
+                try {
+                    OCC_CATCH_SIGNALS
+                    if (aWorker.TransferOneRoot(aRoot, aRange)) {
+                        aShapes[aRoot - 1] = aWorker.Shape(aWorker.NbShapes());
+                    }
+                } catch (const Standard_Failure&) {
+                    // Reported below through the null result, keep the other roots going
+                }
+                aTimesMs[aRoot - 1] = aTimer.elapsed();
+                if (theOnRoot && !aShapes[aRoot - 1].IsNull()) theOnRoot(aShapes[aRoot - 1]);
+            }
+        });
+
+        if (aPS.UserBreak()) return TopoDS_Shape();
+
+        // Per-root timings, slowest first (logged here to keep worker output unmixed)
+        std::vector<int> anOrder(aNbRoots);
+        std::iota(anOrder.begin(), anOrder.end(), 0);
+        std::sort(anOrder.begin(), anOrder.end(),
+                  [&](int a, int b) { return aTimesMs[a] > aTimesMs[b]; });
+        for (int anIdx : anOrder) {
+            Message::SendInfo() << "  Root " << (anIdx + 1) << ": " << aTimesMs[anIdx] << " ms"
+                                << (aShapes[anIdx].IsNull() ? " (no shape)" : "");
+        }
+
+        BRep_Builder aBuilder;
+        TopoDS_Compound aCompound;
+        aBuilder.MakeCompound(aCompound);
+        int aNbShapes = 0;
+        for (const TopoDS_Shape& aShape : aShapes) {
+            if (aShape.IsNull()) continue;
+            aBuilder.Add(aCompound, aShape);
+            ++aNbShapes;
+        }
+        Message::SendInfo() << "Parallel transfer produced " << aNbShapes << " of " << aNbRoots << " roots";
+        return aNbShapes > 0 ? TopoDS_Shape(aCompound) : TopoDS_Shape();
+    }
+
+    bool isHealingApplied(const QString& theFormat, const CadLoadOptions& theOptions)
+    {
+        return theOptions.shapeHealing && (theFormat == "STEP" || theFormat == "IGES");
+    }
+
+    //! Optional healing after the transfer, timed as a stage of its own; a null result means cancelled
+    TopoDS_Shape healTransferredShape(const TopoDS_Shape& theShape, const CadLoadOptions& theOptions,
+                                      const Message_ProgressRange& theProgress, CadLoadReport& theReport)
+    {
+        QElapsedTimer aTimer;
+        aTimer.start();
+        TopoDS_Shape aShape;
+        try {
+            aShape = ShapeHealing::heal(theShape, theOptions.healTimeBudgetMs, theProgress, theReport.heal);
+        } catch (const Standard_Failure& e) {
+            Message::SendWarning() << "Shape healing failed, using the shape as read: " << e.GetMessageString();
+            theReport.heal.failedParts = std::max(theReport.heal.parts, 1);
+            aShape = theShape;
+        }
+        theReport.stages.heal = aTimer.elapsed();
+        return aShape;
+    }
+
+    //! Sequential transfer handing out every root as soon as it is done. The transfer lock is
+    //! held per root only, theOnRoot (which meshes) runs after it is released.
+    template<class ReaderType>
+    TopoDS_Shape transferRootsOneByOne(ReaderType& theReader, TransferLock::Format theFormat,
+                                       const Message_ProgressRange& theProgress, const CadRootCallback& theOnRoot)
+    {
+        const Standard_Integer aNbRoots = theReader.NbRootsForTransfer();
+        Message_ProgressScope aPS(theProgress, "Transferring roots", aNbRoots);
+        for (Standard_Integer aRoot = 1; aRoot <= aNbRoots && aPS.More(); ++aRoot) {
+            const Standard_Integer aNbShapes = theReader.NbShapes();
+            try {
+                OCC_CATCH_SIGNALS
+                bool isTransferred = false;
+                {
+                    const TransferLock aTransferLock(theFormat);
+                    isTransferred = theReader.TransferOneRoot(aRoot, aPS.Next()) && theReader.NbShapes() > aNbShapes;
+                }
+                if (isTransferred) theOnRoot(theReader.Shape(theReader.NbShapes()));
+            } catch (const Standard_Failure& e) {
+                Message::SendWarning() << "Root " << aRoot << " skipped: " << e.GetMessageString();
+            }
+        }
+        if (aPS.UserBreak()) return TopoDS_Shape();
+        return theReader.OneShape();
+    }
+}
 
 CadModelManager::CadModelManager(OcctQWidgetViewer* viewer)
     : m_viewer(viewer)
 {
+    // One active load plus one being cancelled (ReadFile cannot be interrupted)
+    m_loadPool.setMaxThreadCount(2);
+    m_nodePool.setMaxThreadCount(1);
+    m_refinePool.setMaxThreadCount(1);
+    m_cachePool.setMaxThreadCount(1);
+
+    // Several models in memory at once; beyond a few cores the disk becomes the limit anyway
+    m_batchPool.setMaxThreadCount(std::max(1, std::min(QThread::idealThreadCount(), 8)));
 }
 
-QString CadModelManager::getFileFormatFromExtension(const QString& theFilePath) const
+CadModelManager::~CadModelManager()
+{
+    // No signals here: the viewer is already being destroyed
+    if (!m_progress.IsNull()) {
+        m_progress->Cancel();
+    }
+    if (m_refineCancel) *m_refineCancel = true;
+    m_loadPool.waitForDone();
+    m_nodePool.waitForDone();
+    m_refinePool.waitForDone();
+    m_batchPool.waitForDone();
+    m_cachePool.waitForDone();
+}
+
+QString CadModelManager::getFileFormatFromExtension(const QString& theFilePath)
 {
     QString aExtension = theFilePath.right(5).toLower();
     if (aExtension.endsWith(".step") || aExtension.endsWith(".stp")) {
@@ -27,11 +240,17 @@ QString CadModelManager::getFileFormatFromExtension(const QString& theFilePath)
         return "IGES";
     } else if (aExtension.endsWith(".brep")) {
         return "BREP";
+    } else if (aExtension.endsWith(".stl")) {
+        return "STL";
+    } else if (aExtension.endsWith(".obj")) {
+        return "OBJ";
+    } else if (aExtension.endsWith(".ply")) {
+        return "PLY";
     }
     return "UNKNOWN";
 }
 
-bool CadModelManager::loadCADModel(const QString& theFilePath)
+bool CadModelManager::checkFilePath(const QString& theFilePath)
 {
     if (theFilePath.isEmpty()) {
         Message::SendWarning() << "File path is empty";
@@ -46,42 +265,981 @@ bool CadModelManager::loadCADModel(const QString& theFilePath)
     }
 
     QString aFormat = getFileFormatFromExtension(theFilePath);
-    bool aSuccess = false;
+    if (aFormat == "UNKNOWN") {
+        Message::SendWarning() << "Unsupported file format: " << aFormat.toStdString();
+        emit m_viewer->errorOccurred("Unsupported file format: " + aFormat);
+        return false;
+    }
+    return true;
+}
+
+bool CadModelManager::loadCADModel(const QString& theFilePath)
+{
+    if (!checkFilePath(theFilePath)) return false;
+
+    stopMeshRefinement();
+    m_loadTimer.start();
+    CadLoadOptions anOptions = m_options;
+    anOptions.mesh = m_viewer->m_render->displayMeshParameters();
+    anOptions.levelOfDetail = m_viewer->m_render->isLevelOfDetail();
 
+    const QString aFormat = getFileFormatFromExtension(theFilePath);
+    CadLoadReport aReport;
     if (aFormat == "STEP") {
-        aSuccess = loadSTEPFile(theFilePath);
-    } else if (aFormat == "IGES") {
-        aSuccess = loadIGESFile(theFilePath);
-    } else if (aFormat == "BREP") {
-        aSuccess = loadBREPFile(theFilePath);
+        const bool isAccepted = prescanStep(theFilePath, anOptions, aReport);
+        emit m_viewer->stepPrescanned(aReport.prescan);
+        if (!isAccepted) {
+            emit m_viewer->errorOccurred(aReport.error);
+            return false;
+        }
+    }
+
+    if (aFormat == "STEP" && anOptions.assemblyInstancing) {
+        const CadAssembly anAssembly = loadSTEPAssembly(theFilePath, anOptions, Message_ProgressRange(), aReport);
+        if (anAssembly.isEmpty()) {
+            emit m_viewer->errorOccurred("Failed to load assembly");
+            return false;
+        }
+        displayLoadedAssembly(theFilePath, anAssembly, aReport);
+        return true;
+    }
+
+    TopoDS_Shape aShape = loadShape(theFilePath, aFormat, anOptions, Message_ProgressRange(), aReport);
+    if (aShape.IsNull()) {
+        emit m_viewer->errorOccurred(aReport.error.isEmpty() ? QString("Failed to load model") : aReport.error);
+        return false;
+    }
+    prepareLoadedShape(aShape, anOptions, aReport);
+
+    displayLoadedModel(theFilePath, aShape, aReport);
+    return true;
+}
+
+void CadModelManager::displayLoadedModel(const QString& theFilePath, const TopoDS_Shape& theShape,
+                                         const CadLoadReport& theReport)
+{
+    // displayShape() clears the previous model itself; mesh is skipped, the mesh stage attached it.
+    // A progressive coarse level is kept as is, the finer ones follow.
+    CadLoadReport aReport = theReport;
+    m_viewer->m_render->displayShape(theShape, &aReport.stages, theReport.meshLevels.isEmpty(), theReport.lodParts);
+    completeLoadedModel(theFilePath, theShape, aReport);
+}
+
+void CadModelManager::displayLoadedAssembly(const QString& theFilePath, const CadAssembly& theAssembly,
+                                            const CadLoadReport& theReport)
+{
+    m_viewer->clearAllShapes();
+    m_viewer->m_render->displayAssembly(theAssembly);
+    completeLoadedModel(theFilePath, m_viewer->myLoadedShape, theReport);
+}
+
+void CadModelManager::completeLoadedModel(const QString& theFilePath, const TopoDS_Shape& theShape,
+                                          const CadLoadReport& theReport)
+{
+    // Keep the computed triangulation as a cache level for the next open; a progressive
+    // load stores it once the display quality is reached. The writer gets a copy: quality
+    // changes rewrite the displayed shape on this thread while it may still be serializing.
+    const MeshParameters aMeshParams = m_viewer->m_render->displayMeshParameters();
+    TopoDS_Shape aShownCopy;
+    if (m_options.useModelCache && !theReport.meshFromCache && theReport.meshLevels.isEmpty()
+        && !theReport.cacheKey.isEmpty()) {
+        try {
+            aShownCopy = BRepBuilderAPI_Copy(theShape, Standard_False, Standard_True).Shape();
+            storeMeshLevel(theReport.cacheKey, aShownCopy, aMeshParams);
+        } catch (const Standard_Failure& e) {
+            Message::SendWarning() << "Triangulation not cached: " << e.GetMessageString();
+        }
+    }
+
+    // A mesh read from the file has no B-Rep to re-mesh; assembly instances are not one shape
+    if (!theReport.meshFromFile && m_viewer->m_render->isModelDisplayed(theShape)) {
+        resetMeshLevels(theShape, theReport.meshLevels.isEmpty() ? aMeshParams
+                                                                 : aMeshParams.coarsened(THE_COARSE_MESH_FACTOR),
+                        theReport.cacheKey);
+        // The copy is the stored level of what is shown, setMeshQuality() need not take another
+        if (!aShownCopy.IsNull()) rememberMeshLevel(aMeshParams.levelKey(), aShownCopy);
     } else {
-        Message::SendWarning() << "Unsupported file format: " << aFormat.toStdString();
-        emit m_viewer->errorOccurred("Unsupported file format: " + aFormat);
+        resetMeshLevels(TopoDS_Shape(), MeshParameters(), QString());
+    }
+
+    m_viewer->myCurrentFilePath = theFilePath;
+    if (theReport.stages.massProps >= 0) {
+        // Worker results for this model: no mass properties or box on the GUI thread
+        m_viewer->m_measurement->setModelMassProperties(theShape, theReport.massProps);
+        m_viewer->m_render->setModelBox(theShape, theReport.massProps.box);
+    }
+    m_viewer->fitViewToModel();
+
+    // --- FIX: Update Data Immediately ---
+    // File info and the cached origin; the mass properties are not recomputed
+    m_viewer->calculateMeasurements();
+    // ------------------------------------
+
+    m_viewer->updateView();
+
+    QFileInfo aFileInfo(theFilePath);
+    emit m_viewer->modelLoaded(aFileInfo.fileName());
+    emit m_viewer->loadReport(theReport.summary());
+    Message::SendInfo() << "Load stages: " << theReport.stages.summary().toStdString();
+
+    if (!theReport.meshLevels.isEmpty()) {
+        m_firstFrameMs = m_loadTimer.elapsed();
+        Message::SendInfo() << "First frame after " << m_firstFrameMs << " ms with a coarse mesh, refining";
+        refineMeshLevels(theReport.cacheKey, theShape, theReport.meshLevels);
+    }
+}
+
+void CadModelManager::refineMeshLevels(const QString& theCacheKey, const TopoDS_Shape& theShape,
+                                       const QVector<TopoDS_Shape>& theLevels)
+{
+    stopMeshRefinement();
+    m_refineCancel = std::make_shared<std::atomic_bool>(false);
+
+    const std::shared_ptr<std::atomic_bool> aCancel = m_refineCancel;
+    const int aGeneration = m_loadGeneration;
+    const MeshParameters aParams = m_viewer->m_render->displayMeshParameters();
+    OcctQWidgetViewer* aViewer = m_viewer;
+    m_refinePool.start([this, aViewer, aCancel, aGeneration, aParams, theCacheKey, theShape, theLevels]() {
+        // Only the copies are touched here; the displayed shape belongs to the GUI thread
+        for (int aLevel = 0; aLevel < theLevels.size() && !*aCancel; ++aLevel) {
+            const TopoDS_Shape aCopy = theLevels.at(aLevel);
+            try {
+                Tessellation::mesh(aCopy, aParams.coarsened(THE_REFINE_FACTORS[aLevel]));
+            } catch (const Standard_Failure& e) {
+                Message::SendWarning() << "Mesh refinement stopped: " << e.GetMessageString();
+                return;
+            }
+            if (*aCancel) return;
+
+            const bool isFinal = aLevel + 1 == theLevels.size();
+            const MeshParameters aLevelParams = aParams.coarsened(THE_REFINE_FACTORS[aLevel]);
+            QMetaObject::invokeMethod(aViewer, [this, aCancel, aGeneration, theCacheKey, theShape, aCopy,
+                                                aLevelParams, isFinal]() {
+                if (!*aCancel) onMeshLevelReady(aGeneration, theCacheKey, theShape, aCopy, aLevelParams, isFinal);
+            }, Qt::QueuedConnection);
+        }
+    });
+}
+
+void CadModelManager::onMeshLevelReady(int theGeneration, const QString& theCacheKey, const TopoDS_Shape& theShape,
+                                       const TopoDS_Shape& theLevel, const MeshParameters& theParams,
+                                       bool theIsFinal)
+{
+    // Superseded, or the model was cleared or replaced meanwhile
+    if (theGeneration != m_loadGeneration || !m_viewer->myLoadedShape.IsSame(theShape)) return;
+
+    QElapsedTimer aSwapTimer;
+    aSwapTimer.start();
+    if (!m_viewer->m_render->applyMeshLevel(theShape, theLevel)) return;
+    if (m_levelModel.IsSame(theShape)) {
+        m_shownMesh = theParams;
+        rememberMeshLevel(theParams.levelKey(), theLevel);
+    }
+    Message::SendInfo() << "Mesh level swapped in after " << m_loadTimer.elapsed() << " ms ("
+                        << aSwapTimer.elapsed() << " ms on the GUI thread)";
+    if (!theIsFinal) return;
+
+    const QString aLatency = QString("First frame %1 ms, final quality %2 ms")
+                                 .arg(m_firstFrameMs).arg(m_loadTimer.elapsed());
+    Message::SendInfo() << "Progressive mesh: " << aLatency.toStdString();
+    emit m_viewer->loadReport(aLatency);
+
+    // The copy, not the displayed shape: the cache writer reads it on another thread
+    if (m_options.useModelCache) {
+        storeMeshLevel(theCacheKey, theLevel, theParams);
+    }
+}
+
+void CadModelManager::stopMeshRefinement()
+{
+    if (m_refineCancel) *m_refineCancel = true;
+    m_refineCancel.reset();
+}
+
+void CadModelManager::setMeshQuality(double theFactor)
+{
+    RenderManager* aRender = m_viewer->m_render;
+    aRender->setMeshQuality(theFactor);
+    const MeshParameters aParams = aRender->displayMeshParameters();
+    if (isLoading() || m_levelModel.IsNull() || !m_viewer->myLoadedShape.IsSame(m_levelModel)
+        || !aRender->isModelDisplayed(m_levelModel)) {
+        Message::SendInfo() << "Display mesh from the next load: " << aParams.summary().toStdString();
+        return;
+    }
+
+    const QString aKey = aParams.levelKey();
+    if (aKey == m_shownMesh.levelKey()) return;
+
+    // A quality change supersedes progressive refinement and any re-mesh still running
+    stopMeshRefinement();
+    m_refineCancel = std::make_shared<std::atomic_bool>(false);
+
+    // A level shown before is swapped back without meshing
+    const TopoDS_Shape aStored = m_levelStore.value(aKey);
+    if (!aStored.IsNull()) {
+        QElapsedTimer aSwapTimer;
+        aSwapTimer.start();
+        if (!aRender->applyMeshLevel(m_levelModel, aStored)) return;
+        m_shownMesh = aParams;
+        rememberMeshLevel(aKey, aStored);
+        const QString aSummary = QString("Mesh quality x%1: stored level swapped in %2 ms")
+                                     .arg(theFactor, 0, 'g', 3).arg(aSwapTimer.elapsed());
+        Message::SendInfo() << aSummary.toStdString();
+        emit m_viewer->loadReport(aSummary);
+        return;
+    }
+
+    // The worker only reads and meshes copies; the displayed shape belongs to the GUI thread.
+    // Without a stored copy of what is shown, one is taken here, once per model.
+    TopoDS_Shape aShown = m_levelStore.value(m_shownMesh.levelKey());
+    if (aShown.IsNull()) {
+        QElapsedTimer aCopyTimer;
+        aCopyTimer.start();
+        try {
+            aShown = BRepBuilderAPI_Copy(m_levelModel, Standard_False, Standard_True).Shape();
+        } catch (const Standard_Failure& e) {
+            Message::SendWarning() << "Re-mesh skipped: " << e.GetMessageString();
+            return;
+        }
+        rememberMeshLevel(m_shownMesh.levelKey(), aShown);
+        Message::SendTrace() << "Shown mesh copied in " << aCopyTimer.elapsed() << " ms";
+    }
+
+    const std::shared_ptr<std::atomic_bool> aCancel = m_refineCancel;
+    const bool isIncremental = isAtLeastAsFine(aParams, m_shownMesh);
+    const CadLoadOptions anOptions = m_options;
+    const QString aCacheKey = m_levelCacheKey;
+    const TopoDS_Shape aModel = m_levelModel;
+    OcctQWidgetViewer* aViewer = m_viewer;
+    m_refinePool.start([this, aViewer, aCancel, anOptions, aCacheKey, aModel, aShown, aParams, isIncremental]() {
+        QElapsedTimer aTimer;
+        aTimer.start();
+        MeshQualityLevel aResult;
+        aResult.params = aParams;
+        try {
+            if (anOptions.useModelCache && !aCacheKey.isEmpty()) {
+                ModelCache aCache(anOptions.cacheDirectory, anOptions.cacheMaxBytes);
+                aResult.isFromCache = aCache.load(ModelCache::meshKey(aCacheKey, aParams.levelKey()), aResult.level);
+            }
+            if (!aResult.isFromCache) {
+                // Refining keeps the shown triangulation of faces that meet the new tolerance already
+                aResult.level = BRepBuilderAPI_Copy(aShown, Standard_False, isIncremental).Shape();
+                TopTools_IndexedMapOfShape aFaces;
+                TopExp::MapShapes(aResult.level, TopAbs_FACE, aFaces);
+                std::vector<Handle(Poly_Triangulation)> aBefore(aFaces.Extent());
+                TopLoc_Location aLoc;
+                for (int anIdx = 1; anIdx <= aFaces.Extent(); ++anIdx) {
+                    aBefore[anIdx - 1] = BRep_Tool::Triangulation(TopoDS::Face(aFaces(anIdx)), aLoc);
+                }
+                if (*aCancel) return;
+                if (!Tessellation::mesh(aResult.level, aParams)) {
+                    Message::SendWarning() << "Re-mesh failed: " << aParams.summary().toStdString();
+                    return;
+                }
+                aResult.faces = aFaces.Extent();
+                for (int anIdx = 1; anIdx <= aFaces.Extent(); ++anIdx) {
+                    if (BRep_Tool::Triangulation(TopoDS::Face(aFaces(anIdx)), aLoc) != aBefore[anIdx - 1]) {
+                        ++aResult.remeshedFaces;
+                    }
+                }
+            }
+        } catch (const Standard_Failure& e) {
+            Message::SendWarning() << "Re-mesh failed: " << e.GetMessageString();
+            return;
+        }
+        if (*aCancel) return;
+
+        aResult.elapsedMs = aTimer.elapsed();
+        QMetaObject::invokeMethod(aViewer, [this, aCancel, aModel, aResult]() {
+            if (!*aCancel) onMeshQualityReady(aModel, aResult);
+        }, Qt::QueuedConnection);
+    });
+    Message::SendInfo() << (isIncremental ? "Refining" : "Re-meshing") << " the displayed model: "
+                        << aParams.summary().toStdString();
+}
+
+void CadModelManager::onMeshQualityReady(const TopoDS_Shape& theModel, const MeshQualityLevel& theLevel)
+{
+    // The model was cleared or replaced meanwhile
+    if (!m_viewer->myLoadedShape.IsSame(theModel) || !m_levelModel.IsSame(theModel)) return;
+
+    QElapsedTimer aSwapTimer;
+    aSwapTimer.start();
+    if (!m_viewer->m_render->applyMeshLevel(theModel, theLevel.level)) return;
+    m_shownMesh = theLevel.params;
+    rememberMeshLevel(theLevel.params.levelKey(), theLevel.level);
+
+    QString aSummary;
+    if (theLevel.isFromCache) {
+        aSummary = QString("Mesh quality: cached level read in %1 ms").arg(theLevel.elapsedMs);
+    } else {
+        aSummary = QString("Mesh quality: %1 of %2 faces re-meshed in %3 ms")
+                       .arg(theLevel.remeshedFaces).arg(theLevel.faces).arg(theLevel.elapsedMs);
+        if (m_options.useModelCache) {
+            storeMeshLevel(m_levelCacheKey, theLevel.level, theLevel.params);
+        }
+    }
+    aSummary += QString(", swapped in %1 ms").arg(aSwapTimer.elapsed());
+    Message::SendInfo() << aSummary.toStdString();
+    emit m_viewer->loadReport(aSummary);
+}
+
+void CadModelManager::resetMeshLevels(const TopoDS_Shape& theModel, const MeshParameters& theShown,
+                                      const QString& theCacheKey)
+{
+    m_levelModel = theModel;
+    m_levelCacheKey = theCacheKey;
+    m_shownMesh = theShown;
+    m_levelStore.clear();
+    m_levelOrder.clear();
+}
+
+void CadModelManager::releaseMeshLevels()
+{
+    stopMeshRefinement();
+    resetMeshLevels(TopoDS_Shape(), MeshParameters(), QString());
+}
+
+void CadModelManager::rememberMeshLevel(const QString& theLevelKey, const TopoDS_Shape& theLevel)
+{
+    m_levelStore.insert(theLevelKey, theLevel);
+    m_levelOrder.removeAll(theLevelKey);
+    m_levelOrder.append(theLevelKey);
+    while (m_levelOrder.size() > THE_MAX_MESH_LEVELS) {
+        m_levelStore.remove(m_levelOrder.takeFirst());
+    }
+}
+
+QString CadLoadReport::summary() const
+{
+    QStringList aParts;
+    if (meshFromFile) {
+        aParts << meshStats.summary();
+    } else if (cache == CacheHit) {
+        aParts << (meshFromCache ? "Model cache hit, meshing skipped" : "Model cache hit");
+    } else if (cache == CacheMiss) {
+        aParts << "Model cache miss";
+    }
+    if (heal.fromCache || stages.heal >= 0) aParts << "healing: " + heal.summary();
+    const QString aStages = stages.summary();
+    if (!aStages.isEmpty()) aParts << aStages;
+    return aParts.join("; ");
+}
+
+QString CadStageTimings::summary() const
+{
+    const struct { const char* Name; qint64 Ms; } THE_STAGES[] = {
+        { "read", read }, { "transfer", transfer }, { "healing", heal }, { "mesh", mesh },
+        { "level of detail", lod }, { "mass properties", massProps }, { "topology", topology }, { "display", display }
+    };
+    QStringList aParts;
+    for (const auto& aStage : THE_STAGES) {
+        if (aStage.Ms >= 0) aParts << QString("%1 %2 ms").arg(aStage.Name).arg(aStage.Ms);
+    }
+    return aParts.join(", ");
+}
+
+// =========================================================
+// Asynchronous Loading
+// =========================================================
+
+bool CadModelManager::loadCADModelAsync(const QString& theFilePath)
+{
+    if (!checkFilePath(theFilePath)) return false;
+
+    // A new request supersedes the running one
+    cancelLoad();
+
+    const QString aFormat = getFileFormatFromExtension(theFilePath);
+    CadLoadOptions anOptions = m_options;
+    anOptions.mesh = m_viewer->m_render->displayMeshParameters();
+    anOptions.levelOfDetail = m_viewer->m_render->isLevelOfDetail();
+    const int aGeneration = ++m_loadGeneration;
+    Handle(LoadProgressIndicator) aProgress = new LoadProgressIndicator(m_viewer);
+    m_progress = aProgress;
+    m_loadTimer.start();
+
+    OcctQWidgetViewer* aViewer = m_viewer;
+    CadRootCallback anOnRoot;
+    if (anOptions.streamingDisplay) {
+        anOnRoot = [this, aViewer, aGeneration, anOptions](const TopoDS_Shape& theRoot) {
+            // Meshed on the worker, the GUI thread only builds the presentation. The whole model's
+            // extent is unknown yet, so a relative deflection refers to the root; the final mesh
+            // stage keeps these faces, being at least as fine. A triangle budget is for the whole
+            // model, the roots get the default relative deflection meanwhile.
+            const bool isBudget = anOptions.mesh.mode == MeshParameters::TriangleBudget;
+            Tessellation::mesh(theRoot, isBudget ? MeshParameters() : anOptions.mesh);
+            QMetaObject::invokeMethod(aViewer, [this, aGeneration, theRoot]() {
+                onStreamedRoot(aGeneration, theRoot);
+            }, Qt::QueuedConnection);
+        };
+    }
+
+    m_loadPool.start([this, aViewer, aProgress, aGeneration, theFilePath, aFormat, anOptions, anOnRoot]() {
+        CadLoadOptions aLoadOptions = anOptions;
+        CadLoadReport aReport;
+        TopoDS_Shape aShape;
+        CadAssembly anAssembly;
+
+        // Metadata goes to the Properties dock before the full parse starts
+        const bool isAccepted = aFormat != "STEP" || prescanStep(theFilePath, aLoadOptions, aReport);
+        if (aFormat == "STEP") {
+            const StepPrescanResult aPrescan = aReport.prescan;
+            QMetaObject::invokeMethod(aViewer, [this, aViewer, aGeneration, aPrescan]() {
+                if (aGeneration == m_loadGeneration) emit aViewer->stepPrescanned(aPrescan);
+            }, Qt::QueuedConnection);
+        }
+        // Only worth it when the pre-scan saw product structure to split at
+        if (isAccepted && aFormat == "STEP" && aLoadOptions.lazyAssembly
+         && aReport.prescan.typeHistogram.value("NEXT_ASSEMBLY_USAGE_OCCURRENCE") > 0) {
+            std::shared_ptr<LazyStepAssembly> aLazy = LazyStepAssembly::open(theFilePath, aProgress->Start());
+            if (aLazy || aProgress->IsCancelled()) {
+                const bool isCancelled = aProgress->IsCancelled();
+                QMetaObject::invokeMethod(aViewer, [this, aGeneration, theFilePath, aLazy, aReport, isCancelled]() {
+                    onLazyAssemblyOpened(aGeneration, theFilePath, aLazy, aReport, isCancelled);
+                }, Qt::QueuedConnection);
+                return;
+            }
+            Message::SendInfo() << "No subassemblies to defer, loading the whole model";
+        }
+
+        if (isAccepted && aFormat == "STEP" && aLoadOptions.assemblyInstancing) {
+            anAssembly = loadSTEPAssembly(theFilePath, aLoadOptions, aProgress->Start(), aReport);
+        } else if (isAccepted) {
+            aShape = loadShape(theFilePath, aFormat, aLoadOptions, aProgress->Start(), aReport, anOnRoot);
+            if (!aShape.IsNull() && !aProgress->IsCancelled()) {
+                prepareLoadedShape(aShape, aLoadOptions, aReport);
+            }
+        }
+        const bool isCancelled = aProgress->IsCancelled();
+        if (isCancelled) {
+            CadAssembly::closeDocument(anAssembly.document);
+            anAssembly = CadAssembly();
+        }
+
+        // Hand the result to the GUI thread; dropped if the viewer is gone
+        QMetaObject::invokeMethod(aViewer, [this, aGeneration, theFilePath, aShape, anAssembly, aReport, isCancelled]() {
+            onAsyncLoadDone(aGeneration, theFilePath, aShape, anAssembly, aReport, isCancelled);
+        }, Qt::QueuedConnection);
+    });
+
+    emit m_viewer->loadStarted(QFileInfo(theFilePath).fileName());
+    return true;
+}
+
+bool CadModelManager::loadCADModelsAsync(const QStringList& theFilePaths)
+{
+    QStringList aFiles;
+    for (const QString& aPath : theFilePaths) {
+        if (getFileFormatFromExtension(aPath) != "UNKNOWN" && QFileInfo::exists(aPath)) aFiles << aPath;
+    }
+    if (aFiles.isEmpty()) {
+        Message::SendWarning() << "No supported CAD files to load";
+        emit m_viewer->errorOccurred("No supported CAD files to load");
         return false;
     }
+    if (aFiles.size() == 1) return loadCADModelAsync(aFiles.first());
+
+    cancelLoad();
+
+    CadLoadOptions anOptions = m_options;
+    anOptions.mesh = m_viewer->m_render->displayMeshParameters();
+    // Files are the unit of parallelism here, per-root tasks would only oversubscribe the pool
+    anOptions.parallelTransfer = false;
+
+    const int aGeneration = ++m_loadGeneration;
+    Handle(LoadProgressIndicator) aProgress = new LoadProgressIndicator(m_viewer);
+    m_progress = aProgress;
+    m_loadTimer.start();
+    m_batch = BatchState();
+    m_batch.total = m_batch.remaining = aFiles.size();
+
+    // Ranges are split up-front so the workers can nest their own scopes concurrently
+    struct BatchProgress {
+        Message_ProgressScope Scope;
+        std::vector<Message_ProgressRange> Ranges;
+        BatchProgress(const Message_ProgressRange& theRange, int theNbFiles)
+            : Scope(theRange, "Loading files", theNbFiles)
+        {
+            for (int anIdx = 0; anIdx < theNbFiles; ++anIdx) Ranges.push_back(Scope.Next());
+        }
+    };
+    auto aBatchProgress = std::make_shared<BatchProgress>(aProgress->Start(), aFiles.size());
+
+    Message::SendInfo() << "Loading " << aFiles.size() << " files on " << m_batchPool.maxThreadCount() << " threads";
+    OcctQWidgetViewer* aViewer = m_viewer;
+    for (int anIdx = 0; anIdx < aFiles.size(); ++anIdx) {
+        const QString aPath = aFiles.at(anIdx);
+        const QString aFormat = getFileFormatFromExtension(aPath);
+        m_batchPool.start([this, aViewer, aProgress, aBatchProgress, anIdx, aPath, aFormat, aGeneration, anOptions]() {
+            TopoDS_Shape aShape;
+            if (!aProgress->IsCancelled()) {
+                CadLoadOptions aLoadOptions = anOptions;
+                CadLoadReport aReport;
+                const bool isAccepted = aFormat != "STEP" || prescanStep(aPath, aLoadOptions, aReport);
+                if (isAccepted) {
+                    aShape = loadShape(aPath, aFormat, aLoadOptions, aBatchProgress->Ranges[anIdx], aReport);
+                }
+
+                // Meshed here so the GUI thread only builds presentations
+                if (!aShape.IsNull() && !aReport.meshFromCache && !aReport.meshFromFile && !aProgress->IsCancelled()) {
+                    Tessellation::mesh(aShape, aLoadOptions.mesh);
+                    if (aLoadOptions.useModelCache && !aReport.cacheKey.isEmpty()) {
+                        ModelCache aCache(aLoadOptions.cacheDirectory, aLoadOptions.cacheMaxBytes);
+                        aCache.store(ModelCache::meshKey(aReport.cacheKey, aLoadOptions.mesh.levelKey()),
+                                     aShape, true);
+                    }
+                }
+            }
+
+            const qint64 aFileSize = QFileInfo(aPath).size();
+            QMetaObject::invokeMethod(aViewer, [this, aGeneration, aPath, aShape, aFileSize]() {
+                onBatchFileLoaded(aGeneration, aPath, aShape, aFileSize);
+            }, Qt::QueuedConnection);
+        });
+    }
+
+    emit m_viewer->loadStarted(QString("%1 files").arg(aFiles.size()));
+    return true;
+}
+
+void CadModelManager::onBatchFileLoaded(int theGeneration, const QString& theFilePath,
+                                        const TopoDS_Shape& theShape, qint64 theFileSize)
+{
+    if (theGeneration != m_loadGeneration || m_progress.IsNull()) return;
+
+    --m_batch.remaining;
+    m_batch.bytes += theFileSize;
+    if (theShape.IsNull()) {
+        m_batch.failed << QFileInfo(theFilePath).fileName();
+    } else {
+        // One node per file, shown as it arrives like a streamed root
+        if (m_streamedGeneration != theGeneration) {
+            m_viewer->clearAllShapes();
+            m_viewer->m_render->beginStreamedDisplay();
+            m_streamedGeneration = theGeneration;
+        }
+        m_viewer->m_render->appendStreamedShape(theShape);
+        m_batch.shapes.append(theShape);
+    }
+    if (m_batch.remaining > 0) return;
+
+    m_progress.Nullify();
+    m_streamedGeneration = 0;
+
+    const double aSeconds = std::max(m_loadTimer.elapsed(), qint64(1)) / 1000.0;
+    QString aSummary = QString("%1 of %2 files in %3 s, %4 files/s, %5 MB/s")
+                           .arg(m_batch.shapes.size()).arg(m_batch.total)
+                           .arg(aSeconds, 0, 'f', 1)
+                           .arg(m_batch.total / aSeconds, 0, 'f', 1)
+                           .arg(m_batch.bytes / (1024.0 * 1024.0) / aSeconds, 0, 'f', 1);
+    if (!TransferLock::isParallelSafe(TransferLock::Step)) aSummary += " (STEP/IGES transfers serialized)";
+    if (!m_batch.failed.isEmpty()) aSummary += "; failed: " + m_batch.failed.join(", ");
+    Message::SendInfo() << "Batch load: " << aSummary.toStdString();
+
+    if (m_batch.shapes.isEmpty()) {
+        emit m_viewer->errorOccurred("None of the files could be loaded");
+        emit m_viewer->loadFinished(false);
+        return;
+    }
+
+    BRep_Builder aBuilder;
+    TopoDS_Compound aCompound;
+    aBuilder.MakeCompound(aCompound);
+    for (const TopoDS_Shape& aShape : std::as_const(m_batch.shapes)) {
+        aBuilder.Add(aCompound, aShape);
+    }
+    m_batch.shapes.clear();
+
+    m_viewer->m_render->finishStreamedDisplay(aCompound);
+    m_viewer->fitViewToModel();
+    m_viewer->calculateMeasurements();
+    m_viewer->updateView();
+
+    emit m_viewer->modelLoaded(QString("%1 files").arg(m_batch.total - m_batch.failed.size()));
+    emit m_viewer->loadReport(aSummary);
+    emit m_viewer->loadFinished(true);
+}
+
+void CadModelManager::cancelLoad()
+{
+    stopMeshRefinement();
+    if (m_progress.IsNull()) return;
+
+    Message::SendInfo() << "Cancelling model load";
+    m_progress->Cancel();
+    m_progress.Nullify();
+
+    // A partially streamed model is not left behind
+    if (m_streamedGeneration == m_loadGeneration) {
+        m_streamedGeneration = 0;
+        m_viewer->clearAllShapes();
+    }
+    emit m_viewer->loadFinished(false);
+}
+
+void CadModelManager::onLazyAssemblyOpened(int theGeneration, const QString& theFilePath,
+                                           const std::shared_ptr<LazyStepAssembly>& theAssembly,
+                                           const CadLoadReport& theReport, bool theIsCancelled)
+{
+    if (theGeneration != m_loadGeneration || theIsCancelled || !theAssembly) return;
+
+    m_progress.Nullify();
+    m_viewer->clearAllShapes();
+    m_lazyAssembly = theAssembly;
+    m_viewer->m_render->displayPlaceholders(theAssembly->nodes());
+
+    m_viewer->myCurrentFilePath = theFilePath;
+    m_viewer->fitViewToModel();
+    m_viewer->calculateMeasurements();
+    m_viewer->updateView();
+
+    QStringList aNames;
+    for (const LazyAssemblyNode& aNode : theAssembly->nodes()) {
+        aNames << aNode.name;
+    }
+    Message::SendInfo() << "Placeholders displayed after " << m_loadTimer.elapsed() << " ms";
+    emit m_viewer->modelLoaded(QFileInfo(theFilePath).fileName());
+    emit m_viewer->loadReport(theReport.summary());
+    emit m_viewer->assemblyOpened(aNames);
+    emit m_viewer->loadFinished(true);
+}
+
+void CadModelManager::loadAssemblyNode(int theIndex)
+{
+    if (!m_lazyAssembly || theIndex < 0 || theIndex >= m_lazyAssembly->nodes().size()) return;
+    if (m_lazyAssembly->nodes().at(theIndex).isLoaded || m_pendingNodes.contains(theIndex)) return;
+
+    m_pendingNodes.insert(theIndex);
+    const std::shared_ptr<LazyStepAssembly> anAssembly = m_lazyAssembly;
+    const MeshParameters aMeshParams = m_viewer->m_render->displayMeshParameters();
+    OcctQWidgetViewer* aViewer = m_viewer;
+    m_nodePool.start([this, aViewer, anAssembly, theIndex, aMeshParams]() {
+        const TopoDS_Shape aShape = anAssembly->transferNode(theIndex, aMeshParams);
+        QMetaObject::invokeMethod(aViewer, [this, anAssembly, theIndex, aShape]() {
+            onAssemblyNodeLoaded(anAssembly, theIndex, aShape);
+        }, Qt::QueuedConnection);
+    });
+}
+
+void CadModelManager::onAssemblyNodeLoaded(const std::shared_ptr<LazyStepAssembly>& theAssembly, int theIndex,
+                                           const TopoDS_Shape& theShape)
+{
+    // The model was replaced or cleared meanwhile
+    if (theAssembly != m_lazyAssembly) return;
+
+    m_pendingNodes.remove(theIndex);
+    if (theShape.IsNull()) {
+        emit m_viewer->assemblyNodeLoaded(theIndex, false);
+        emit m_viewer->errorOccurred("Failed to load " + theAssembly->nodes().at(theIndex).name);
+        return;
+    }
+
+    theAssembly->setLoaded(theIndex);
+    m_viewer->m_render->replacePlaceholder(theIndex, theShape);
+    m_viewer->calculateMeasurements();
+    m_viewer->updateView();
+    emit m_viewer->assemblyNodeLoaded(theIndex, true);
+}
+
+void CadModelManager::releaseLazyAssembly()
+{
+    // Transfers still running keep their own reference and are dropped on arrival
+    m_lazyAssembly.reset();
+    m_pendingNodes.clear();
+}
+
+void CadModelManager::onStreamedRoot(int theGeneration, const TopoDS_Shape& theRoot)
+{
+    if (theGeneration != m_loadGeneration || m_progress.IsNull()) return;
+
+    const bool isFirst = m_streamedGeneration != theGeneration;
+    if (isFirst) {
+        // The previous model gives way to the first piece of the new one
+        m_viewer->clearAllShapes();
+        m_viewer->m_render->beginStreamedDisplay();
+        m_streamedGeneration = theGeneration;
+    }
 
-    if (aSuccess) {
-        m_viewer->myCurrentFilePath = theFilePath;
-        m_viewer->fitViewToModel();
+    m_viewer->m_render->appendStreamedShape(theRoot);
+    if (isFirst) {
+        Message::SendInfo() << "First geometry displayed after " << m_loadTimer.elapsed() << " ms";
+    }
+}
 
-        // --- FIX: Update Data Immediately ---
-        // Calculate file info and origin right now
-        m_viewer->calculateMeasurements();
-        // ------------------------------------
+void CadModelManager::onAsyncLoadDone(int theGeneration, const QString& theFilePath,
+                                      const TopoDS_Shape& theShape, const CadAssembly& theAssembly,
+                                      const CadLoadReport& theReport, bool theIsCancelled)
+{
+    // Result of a superseded or cancelled request
+    if (theGeneration != m_loadGeneration || theIsCancelled) {
+        CadAssembly::closeDocument(theAssembly.document);
+        return;
+    }
 
-        m_viewer->updateView();
+    m_progress.Nullify();
+    if (!theAssembly.isEmpty()) {
+        displayLoadedAssembly(theFilePath, theAssembly, theReport);
+        Message::SendInfo() << "Assembly complete after " << m_loadTimer.elapsed() << " ms";
+        emit m_viewer->loadFinished(true);
+        return;
+    }
+
+    const bool isStreamed = m_streamedGeneration == theGeneration;
+    m_streamedGeneration = 0;
+    if (theShape.IsNull()) {
+        if (isStreamed) m_viewer->clearAllShapes();
+        emit m_viewer->errorOccurred(theReport.error.isEmpty() ? QString("Failed to load model") : theReport.error);
+        emit m_viewer->loadFinished(false);
+        return;
+    }
 
-        QFileInfo aFileInfo(theFilePath);
-        emit m_viewer->modelLoaded(aFileInfo.fileName());
+    if (isStreamed) {
+        // Pieces are on screen already; selection and measurements wait for the whole model
+        m_viewer->m_render->finishStreamedDisplay(theShape);
+        completeLoadedModel(theFilePath, theShape, theReport);
     } else {
-        emit m_viewer->errorOccurred("Failed to load model");
+        displayLoadedModel(theFilePath, theShape, theReport);
+    }
+    Message::SendInfo() << "Model complete after " << m_loadTimer.elapsed() << " ms";
+    emit m_viewer->loadFinished(true);
+}
+
+void CadModelManager::clearModelCache()
+{
+    ModelCache aCache(m_options.cacheDirectory, m_options.cacheMaxBytes);
+    aCache.clear();
+    Message::SendInfo() << "Model cache cleared: " << aCache.directory().toStdString();
+}
+
+// =========================================================
+// Format Readers
+// =========================================================
+
+bool CadModelManager::prescanStep(const QString& theFilePath, CadLoadOptions& theOptions,
+                                  CadLoadReport& theReport)
+{
+    theReport.prescan = StepPrescan::scan(theFilePath);
+    if (!theReport.prescan.isValid) {
+        // Let the real reader produce the diagnostics
+        return true;
+    }
+
+    theOptions.expectedEntities = theReport.prescan.entityCount;
+    theOptions.expectedFaces = theReport.prescan.faceCount();
+
+    if (theOptions.maxStepEntities > 0 && theReport.prescan.entityCount > theOptions.maxStepEntities) {
+        theReport.error = QString("File refused: %1 STEP entities exceed the configured limit of %2")
+                              .arg(theReport.prescan.entityCount)
+                              .arg(theOptions.maxStepEntities);
+        Message::SendWarning() << theReport.error.toStdString();
+        return false;
     }
+    return true;
+}
+
+TopoDS_Shape CadModelManager::loadShape(const QString& theFilePath, const QString& theFormat,
+                                        const CadLoadOptions& theOptions,
+                                        const Message_ProgressRange& theProgress,
+                                        CadLoadReport& theReport,
+                                        const CadRootCallback& theOnRoot)
+{
+    // Parsed faster than a cache lookup, and the file already is the display triangulation
+    if (MeshImport::isMeshFormat(theFormat)) {
+        theReport.cache = CadLoadReport::CacheDisabled;
+        theReport.meshFromFile = true;
+        const TopoDS_Shape aMesh = MeshImport::read(theFilePath, theFormat, theProgress, theReport.meshStats,
+                                                    theReport.error);
+        theReport.stages.read = theReport.meshStats.parseMs + theReport.meshStats.weldMs;
+        return aMesh;
+    }
+
+    const bool isHealing = isHealingApplied(theFormat, theOptions);
+    if (!theOptions.useModelCache) {
+        theReport.cache = CadLoadReport::CacheDisabled;
+        Message_ProgressScope aPS(theProgress, nullptr, isHealing ? 4 : 1);
+        const TopoDS_Shape aShape = readShape(theFilePath, theFormat, theOptions, aPS.Next(isHealing ? 3 : 1),
+                                              theOnRoot, &theReport.stages);
+        if (!isHealing || aShape.IsNull() || aPS.UserBreak()) return aShape;
+        return healTransferredShape(aShape, theOptions, aPS.Next(), theReport);
+    }
+
+    QElapsedTimer aCacheTimer;
+    aCacheTimer.start();
+
+    Message_ProgressScope aPS(theProgress, "Checking model cache", isHealing ? 30 : 20);
+    ModelCache aCache(theOptions.cacheDirectory, theOptions.cacheMaxBytes);
+    const QString aSourceKey = ModelCache::keyForFile(theFilePath);
+    // Healed geometry and its tessellated levels live next to the plain entries
+    const QString aKey = isHealing && !aSourceKey.isEmpty() ? ModelCache::healedKey(aSourceKey) : aSourceKey;
+    theReport.cacheKey = aKey;
+    aPS.Next();
+
+    TopoDS_Shape aShape;
+    if (!aKey.isEmpty()) {
+        // A tessellated level at the display quality carries the geometry as well
+        const QString aMeshKey = ModelCache::meshKey(aKey, theOptions.mesh.levelKey());
+        if (aCache.load(aMeshKey, aShape, aPS.Next(4))) {
+            theReport.cache = CadLoadReport::CacheHit;
+            theReport.meshFromCache = true;
+            theReport.heal.fromCache = isHealing;
+            theReport.stages.read = aCacheTimer.elapsed();
+            Message::SendInfo() << "Model cache hit with triangulation: " << aMeshKey.toStdString();
+            return aShape;
+        }
+        if (aPS.UserBreak()) return TopoDS_Shape();
+
+        // BREP is already the native format, caching its geometry would only duplicate the file
+        if (theFormat != "BREP" && aCache.load(aKey, aShape, aPS.Next(4))) {
+            theReport.cache = CadLoadReport::CacheHit;
+            theReport.heal.fromCache = isHealing;
+            theReport.stages.read = aCacheTimer.elapsed();
+            Message::SendInfo() << "Model cache hit: " << aKey.toStdString();
+            return aShape;
+        }
+        if (aPS.UserBreak()) return TopoDS_Shape();
+
+        // Healing switched on for a model cached without it: only the healing is left to do
+        if (isHealing && aCache.load(aSourceKey, aShape, aPS.Next(4))) {
+            theReport.cache = CadLoadReport::CacheHit;
+            theReport.stages.read = aCacheTimer.elapsed();
+            Message::SendInfo() << "Model cache hit before healing: " << aSourceKey.toStdString();
+        }
+        if (aPS.UserBreak()) return TopoDS_Shape();
+    }
+
+    if (aShape.IsNull()) {
+        if (theFormat != "BREP") {
+            theReport.cache = CadLoadReport::CacheMiss;
+            Message::SendInfo() << "Model cache miss: " << theFilePath.toStdString();
+        }
+        aShape = readShape(theFilePath, theFormat, theOptions, aPS.Next(10), theOnRoot, &theReport.stages);
+        if (aShape.IsNull() || aPS.UserBreak()) return TopoDS_Shape();
 
-    return aSuccess;
+        // Stored before display so meshing on the GUI thread never races the writer
+        if (theFormat != "BREP" && !aSourceKey.isEmpty() && aCache.store(aSourceKey, aShape)) {
+            Message::SendInfo() << "Model cached: " << aSourceKey.toStdString();
+        }
+    }
+    aPS.Next();
+    if (!isHealing) return aShape;
+
+    aShape = healTransferredShape(aShape, theOptions, aPS.Next(6), theReport);
+    if (aShape.IsNull() || aPS.UserBreak()) return TopoDS_Shape();
+
+    // A budget cut leaves parts as read; caching that would make the cut permanent
+    if (theReport.heal.isComplete() && !aKey.isEmpty() && aCache.store(aKey, aShape)) {
+        Message::SendInfo() << "Healed model cached: " << aKey.toStdString();
+    }
+    return aShape;
+}
+
+void CadModelManager::prepareLoadedShape(const TopoDS_Shape& theShape, const CadLoadOptions& theOptions,
+                                         CadLoadReport& theReport)
+{
+    if (theShape.IsNull()) return;
+
+    QElapsedTimer aTimer;
+    aTimer.start();
+    try {
+        if (!theReport.meshFromCache && !theReport.meshFromFile) {
+            if (theOptions.progressiveMesh && !theOptions.streamingDisplay) {
+                // Copied while no other thread knows the shape: the GUI thread later writes
+                // each refined level into it, and copying reads the edges' representations
+                for (size_t aLevel = 0; aLevel < std::size(THE_REFINE_FACTORS); ++aLevel) {
+                    theReport.meshLevels.append(
+                        BRepBuilderAPI_Copy(theShape, Standard_False, Standard_False).Shape());
+                }
+                Tessellation::mesh(theShape, theOptions.mesh.coarsened(THE_COARSE_MESH_FACTOR));
+            } else {
+                Tessellation::mesh(theShape, theOptions.mesh);
+            }
+            theReport.stages.mesh = aTimer.restart();
+        }
+
+        // Before the GUI thread can see the shape: the copies are made from its edges
+        if (theOptions.levelOfDetail && !theOptions.streamingDisplay) {
+            theReport.lodParts = LevelOfDetail::buildParts(theShape, theOptions.mesh);
+            theReport.stages.lod = aTimer.restart();
+        }
+
+        theReport.massProps = MeasurementManager::computeMassProperties(theShape);
+        theReport.stages.massProps = aTimer.elapsed();
+    } catch (const Standard_Failure& e) {
+        // Display meshes again and measurements recompute on the GUI thread
+        Message::SendWarning() << "Load stage failed: " << e.GetMessageString();
+        theReport.stages.massProps = -1;
+    }
+}
+
+void CadModelManager::storeMeshLevel(const QString& theKey, const TopoDS_Shape& theShape,
+                                     const MeshParameters& theParams)
+{
+    // Only complete tessellations are worth a level; the display may have failed part way
+    if (theKey.isEmpty() || !Tessellation::isMeshed(theShape, theParams)) return;
+
+    const CadLoadOptions anOptions = m_options;
+    const QString aMeshKey = ModelCache::meshKey(theKey, theParams.levelKey());
+    m_cachePool.start([anOptions, theShape, aMeshKey]() {
+        ModelCache aCache(anOptions.cacheDirectory, anOptions.cacheMaxBytes);
+        if (aCache.store(aMeshKey, theShape, true)) {
+            Message::SendInfo() << "Triangulation cached: " << aMeshKey.toStdString();
+        }
+    });
+}
+
+TopoDS_Shape CadModelManager::readShape(const QString& theFilePath, const QString& theFormat,
+                                        const CadLoadOptions& theOptions,
+                                        const Message_ProgressRange& theProgress,
+                                        const CadRootCallback& theOnRoot,
+                                        CadStageTimings* theStages)
+{
+    if (theFormat == "STEP") return readSTEPShape(theFilePath, theOptions, theProgress, theOnRoot, theStages);
+    if (theFormat == "IGES") return readIGESShape(theFilePath, theOptions, theProgress, theOnRoot, theStages);
+    if (theFormat == "BREP") {
+        QElapsedTimer aTimer;
+        aTimer.start();
+        const TopoDS_Shape aShape = readBREPShape(theFilePath, theProgress);
+        if (theStages != nullptr) theStages->read = aTimer.elapsed();
+        return aShape;
+    }
+    return TopoDS_Shape();
 }
 
 bool CadModelManager::loadSTEPFile(const QString& theFilePath)
 {
+    TopoDS_Shape aShape = readSTEPShape(theFilePath, m_options, Message_ProgressRange());
+    if (aShape.IsNull()) return false;
+
+    m_viewer->displayShape(aShape);  // clears the previous model itself
+    return true;
+}
+
+bool CadModelManager::loadIGESFile(const QString& theFilePath)
+{
+    TopoDS_Shape aShape = readIGESShape(theFilePath, m_options, Message_ProgressRange());
+    if (aShape.IsNull()) return false;
+
+    m_viewer->displayShape(aShape);  // clears the previous model itself
+    return true;
+}
+
+bool CadModelManager::loadBREPFile(const QString& theFilePath)
+{
+    TopoDS_Shape aShape = readBREPShape(theFilePath, Message_ProgressRange());
+    if (aShape.IsNull()) return false;
+
+    m_viewer->displayShape(aShape);  // clears the previous model itself
+    return true;
+}
+
+TopoDS_Shape CadModelManager::readSTEPShape(const QString& theFilePath, const CadLoadOptions& theOptions,
+                                            const Message_ProgressRange& theProgress,
+                                            const CadRootCallback& theOnRoot,
+                                            CadStageTimings* theStages)
+{
+    QElapsedTimer aStageTimer;
+    aStageTimer.start();
     Message::SendInfo() << "Loading STEP file: " << theFilePath.toStdString();
     OSD::SetSignal(false);
 
@@ -90,42 +1248,137 @@ bool CadModelManager::loadSTEPFile(const QString& theFilePath)
             TCollection_AsciiString aPath = OcctQtTools::qtStringToOcct(theFilePath);
         STEPControl_Reader aReader;
 
+        double aReadWeight = 0.0, aTransferWeight = 0.0;
+        stepProgressWeights(theOptions, aReadWeight, aTransferWeight);
+        TCollection_AsciiString aStepName("Reading STEP file");
+        if (theOptions.expectedEntities > 0) {
+            aStepName = OcctQtTools::qtStringToOcct(
+                QString("Reading STEP file (%1 entities)").arg(theOptions.expectedEntities));
+        }
+
+        Message_ProgressScope aPS(theProgress, aStepName, aReadWeight + aTransferWeight);
         IFSelect_ReturnStatus aStatus = aReader.ReadFile(aPath.ToCString());
         if (aStatus != IFSelect_RetDone) {
             Message::SendFail() << "Failed to read STEP file. Status: " << (int)aStatus;
-            return false;
+            return TopoDS_Shape();
         }
+        if (theStages != nullptr) theStages->read = aStageTimer.restart();
+        aPS.Next(aReadWeight);
+        if (aPS.UserBreak()) return TopoDS_Shape();
 
-        Message::SendInfo() << "STEP file read. Now transferring...";
-        Standard_Boolean aTransferStatus = aReader.TransferRoots();
-        if (!aTransferStatus) {
-            Message::SendFail() << "Failed to transfer STEP data";
-            return false;
+        // Other files wait for the transfer calls only, not while reading or meshing; see TransferLock
+        TopoDS_Shape aShape;
+        const bool isParallel = theOptions.parallelTransfer && TransferLock::isParallelSafe(TransferLock::Step);
+        if (theOptions.parallelTransfer && !isParallel) {
+            Message::SendInfo() << "Parallel STEP transfer needs OCCT 7.8 or later, transferring sequentially";
         }
+        if (isParallel) {
+            Message::SendInfo() << "STEP file read. Now transferring roots in parallel...";
+            aShape = transferRootsInParallel(aReader, aPS.Next(aTransferWeight), theOnRoot);
+            if (aPS.UserBreak()) return TopoDS_Shape();
+        } else if (theOnRoot) {
+            Message::SendInfo() << "STEP file read. Now transferring root by root...";
+            aShape = transferRootsOneByOne(aReader, TransferLock::Step, aPS.Next(aTransferWeight), theOnRoot);
+            if (aPS.UserBreak()) return TopoDS_Shape();
+        } else {
+            Message::SendInfo() << "STEP file read. Now transferring...";
+            Standard_Boolean aTransferStatus = Standard_False;
+            {
+                const TransferLock aTransferLock(TransferLock::Step);
+                aTransferStatus = aReader.TransferRoots(aPS.Next(aTransferWeight));
+            }
+            if (aPS.UserBreak()) return TopoDS_Shape();
+            if (!aTransferStatus) {
+                Message::SendFail() << "Failed to transfer STEP data";
+                return TopoDS_Shape();
+            }
 
-        Message::SendInfo() << "Transfer complete. Extracting shapes...";
-        TopoDS_Shape aShape = aReader.OneShape();
+            Message::SendInfo() << "Transfer complete. Extracting shapes...";
+            aShape = aReader.OneShape();
+        }
 
         if (aShape.IsNull()) {
             Message::SendWarning() << "No valid shape in STEP file";
-            return false;
+            return TopoDS_Shape();
         }
-
-        m_viewer->clearAllShapes();
-        m_viewer->displayShape(aShape);
-        m_viewer->myLoadedShape = aShape;
+        if (theStages != nullptr) theStages->transfer = aStageTimer.elapsed();
 
         Message::SendInfo() << "STEP file loaded successfully";
-        return true;
+        return aShape;
 
     } catch (const Standard_Failure& e) {
         Message::SendFail() << "CRITICAL ERROR: " << e.GetMessageString();
-        return false;
+        return TopoDS_Shape();
     }
 }
 
-bool CadModelManager::loadIGESFile(const QString& theFilePath)
+CadAssembly CadModelManager::loadSTEPAssembly(const QString& theFilePath, const CadLoadOptions& theOptions,
+                                             const Message_ProgressRange& theProgress,
+                                             CadLoadReport& theReport)
 {
+    Message::SendInfo() << "Loading STEP assembly: " << theFilePath.toStdString();
+    theReport.cache = CadLoadReport::CacheDisabled;
+    OSD::SetSignal(false);
+
+    Handle(TDocStd_Document) aDoc = CadAssembly::newDocument();
+    auto aFailed = [&aDoc]() {
+        CadAssembly::closeDocument(aDoc);
+        return CadAssembly();
+    };
+
+    try {
+        OCC_CATCH_SIGNALS
+        TCollection_AsciiString aPath = OcctQtTools::qtStringToOcct(theFilePath);
+        STEPCAFControl_Reader aReader;
+        aReader.SetNameMode(Standard_True);
+        aReader.SetColorMode(Standard_True);
+
+        double aReadWeight = 0.0, aTransferWeight = 0.0;
+        stepProgressWeights(theOptions, aReadWeight, aTransferWeight);
+        const double aMeshWeight = aTransferWeight / 3.0;
+        Message_ProgressScope aPS(theProgress, "Reading STEP assembly", aReadWeight + aTransferWeight + aMeshWeight);
+
+        IFSelect_ReturnStatus aStatus = aReader.ReadFile(aPath.ToCString());
+        if (aStatus != IFSelect_RetDone) {
+            Message::SendFail() << "Failed to read STEP file. Status: " << (int)aStatus;
+            return aFailed();
+        }
+        aPS.Next(aReadWeight);
+        if (aPS.UserBreak()) return aFailed();
+
+        bool isTransferred = false;
+        {
+            const TransferLock aTransferLock(TransferLock::Step);
+            isTransferred = aReader.Transfer(aDoc, aPS.Next(aTransferWeight));
+        }
+        if (!isTransferred || aPS.UserBreak()) {
+            Message::SendFail() << "Failed to transfer STEP assembly";
+            return aFailed();
+        }
+
+        CadAssembly anAssembly = CadAssembly::fromDocument(aDoc);
+        if (anAssembly.isEmpty()) {
+            Message::SendWarning() << "No valid shape in STEP assembly";
+            return aFailed();
+        }
+
+        anAssembly.meshPrototypes(theOptions.mesh);
+        aPS.Next(aMeshWeight);
+        return anAssembly;
+
+    } catch (const Standard_Failure& e) {
+        Message::SendFail() << "CRITICAL ERROR: " << e.GetMessageString();
+        return aFailed();
+    }
+}
+
+TopoDS_Shape CadModelManager::readIGESShape(const QString& theFilePath, const CadLoadOptions& theOptions,
+                                            const Message_ProgressRange& theProgress,
+                                            const CadRootCallback& theOnRoot,
+                                            CadStageTimings* theStages)
+{
+    QElapsedTimer aStageTimer;
+    aStageTimer.start();
     Message::SendInfo() << "Loading IGES file: " << theFilePath.toStdString();
     OSD::SetSignal(false);
 
@@ -134,41 +1387,63 @@ bool CadModelManager::loadIGESFile(const QString& theFilePath)
             TCollection_AsciiString aPath = OcctQtTools::qtStringToOcct(theFilePath);
         IGESControl_Reader aReader;
 
+        Message_ProgressScope aPS(theProgress, "Reading IGES file", 4);
         IFSelect_ReturnStatus aStatus = aReader.ReadFile(aPath.ToCString());
         if (aStatus != IFSelect_RetDone) {
             Message::SendFail() << "Failed to read IGES file. Status: " << (int)aStatus;
-            return false;
+            return TopoDS_Shape();
         }
+        if (theStages != nullptr) theStages->read = aStageTimer.restart();
+        aPS.Next();
+        if (aPS.UserBreak()) return TopoDS_Shape();
 
-        Message::SendInfo() << "IGES file read. Now transferring...";
-        Standard_Boolean aTransferStatus = aReader.TransferRoots();
-        if (!aTransferStatus) {
-            Message::SendFail() << "Failed to transfer IGES data";
-            return false;
+        // Other files wait for the transfer calls only, not while reading or meshing; see TransferLock
+        TopoDS_Shape aShape;
+        const bool isParallel = theOptions.parallelTransfer && TransferLock::isParallelSafe(TransferLock::Iges);
+        if (theOptions.parallelTransfer && !isParallel) {
+            Message::SendInfo() << "IGES transfers share static unit factors, transferring sequentially";
         }
+        if (isParallel) {
+            Message::SendInfo() << "IGES file read. Now transferring roots in parallel...";
+            aShape = transferRootsInParallel(aReader, aPS.Next(3), theOnRoot);
+            if (aPS.UserBreak()) return TopoDS_Shape();
+        } else if (theOnRoot) {
+            Message::SendInfo() << "IGES file read. Now transferring root by root...";
+            aShape = transferRootsOneByOne(aReader, TransferLock::Iges, aPS.Next(3), theOnRoot);
+            if (aPS.UserBreak()) return TopoDS_Shape();
+        } else {
+            Message::SendInfo() << "IGES file read. Now transferring...";
+            Standard_Boolean aTransferStatus = Standard_False;
+            {
+                const TransferLock aTransferLock(TransferLock::Iges);
+                aTransferStatus = aReader.TransferRoots(aPS.Next(3));
+            }
+            if (aPS.UserBreak()) return TopoDS_Shape();
+            if (!aTransferStatus) {
+                Message::SendFail() << "Failed to transfer IGES data";
+                return TopoDS_Shape();
+            }
 
-        Message::SendInfo() << "Transfer complete. Extracting shapes...";
-        m_viewer->clearAllShapes();
-        TopoDS_Shape aShape = aReader.OneShape();
+            Message::SendInfo() << "Transfer complete. Extracting shapes...";
+            aShape = aReader.OneShape();
+        }
 
         if (aShape.IsNull()) {
             Message::SendWarning() << "No valid shape in IGES file";
-            return false;
+            return TopoDS_Shape();
         }
-
-        m_viewer->displayShape(aShape);
-        m_viewer->myLoadedShape = aShape;
+        if (theStages != nullptr) theStages->transfer = aStageTimer.elapsed();
 
         Message::SendInfo() << "IGES file loaded successfully";
-        return true;
+        return aShape;
 
     } catch (const Standard_Failure& e) {
         Message::SendFail() << "CRITICAL ERROR: " << e.GetMessageString();
-        return false;
+        return TopoDS_Shape();
     }
 }
 
-bool CadModelManager::loadBREPFile(const QString& theFilePath)
+TopoDS_Shape CadModelManager::readBREPShape(const QString& theFilePath, const Message_ProgressRange& theProgress)
 {
     Message::SendInfo() << "Loading BREP file: " << theFilePath.toStdString();
 
@@ -176,25 +1451,21 @@ bool CadModelManager::loadBREPFile(const QString& theFilePath)
         TopoDS_Shape aShape;
         TCollection_AsciiString aPath = OcctQtTools::qtStringToOcct(theFilePath);
 
-        if (!BRepTools::Read(aShape, aPath.ToCString(), BRep_Builder())) {
+        if (!BRepTools::Read(aShape, aPath.ToCString(), BRep_Builder(), theProgress)) {
             Message::SendFail() << "Failed to read BREP file";
-            return false;
+            return TopoDS_Shape();
         }
 
         if (aShape.IsNull()) {
             Message::SendFail() << "BREP file contains invalid shape";
-            return false;
+            return TopoDS_Shape();
         }
 
-        m_viewer->clearAllShapes();
-        m_viewer->displayShape(aShape);
-        m_viewer->myLoadedShape = aShape;
-
         Message::SendInfo() << "BREP file loaded successfully";
-        return true;
+        return aShape;
 
     } catch (const Standard_Failure& aException) {
         Message::SendFail() << "Exception during BREP load: " << aException.GetMessageString();
-        return false;
+        return TopoDS_Shape();
     }
 }
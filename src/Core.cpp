@@ -59,6 +59,9 @@ OcctQWidgetViewer::OcctQWidgetViewer(QWidget* theParent)
         myView->ChangeRenderingParams().NbMsaaSamples = 4;
 #endif
 
+        // The overlay is refreshed inside a redraw from the frames OCCT counts there, and
+        // nothing asks for a frame on its behalf: FrameScheduler alone decides when frames
+        // are drawn, so an idle view keeps showing the rate of its last frames
         myView->ChangeRenderingParams().ToShowStats = true;
         myView->ChangeRenderingParams().CollectedStats = (Graphic3d_RenderingParams::PerfCounters)(
             Graphic3d_RenderingParams::PerfCounters_FrameRate |
@@ -126,11 +129,37 @@ void OcctQWidgetViewer::resizeEvent(QResizeEvent* e) { m_render->resizeEvent(e);
 void OcctQWidgetViewer::handleViewRedraw(const Handle(AIS_InteractiveContext)& ctx, const Handle(V3d_View)& v) { m_render->handleViewRedraw(ctx, v); }
 void OcctQWidgetViewer::dumpGlInfo(bool b, bool p) { m_render->dumpGlInfo(b, p); }
 void OcctQWidgetViewer::updateView() { m_render->updateView(); }
+const FrameStats& OcctQWidgetViewer::frameStats() const { return m_render->frameStats(); }
+HoverPickStats OcctQWidgetViewer::hoverStats() const { return m_input->hoverStats(); }
+void OcctQWidgetViewer::resetFrameStats()
+{
+    m_render->resetFrameStats();
+    m_input->resetHoverStats();
+}
 void OcctQWidgetViewer::displayShape(const TopoDS_Shape& s) { m_render->displayShape(s); }
-void OcctQWidgetViewer::clearAllShapes() { m_render->clearAllShapes(); }
+void OcctQWidgetViewer::clearAllShapes()
+{
+    m_cadModel->releaseLazyAssembly();
+    m_cadModel->releaseMeshLevels();
+    m_render->clearAllShapes();
+}
 void OcctQWidgetViewer::fitViewToModel() { m_render->fitViewToModel(); }
 void OcctQWidgetViewer::displayOriginAxis() { m_render->displayOriginAxis(); }
-void OcctQWidgetViewer::meshShape(const TopoDS_Shape& s, double d) { m_render->meshShape(s, d); }
+void OcctQWidgetViewer::meshShape(const TopoDS_Shape& s) { m_render->meshShape(s); }
+double OcctQWidgetViewer::getMeshDeflection() const { return m_render->meshParameters().deflection; }
+void OcctQWidgetViewer::setMeshDeflection(double d)
+{
+    MeshParameters aParams = m_render->meshParameters();
+    aParams.deflection = d;
+    m_render->setMeshParameters(aParams);
+}
+const MeshParameters& OcctQWidgetViewer::meshParameters() const { return m_render->meshParameters(); }
+void OcctQWidgetViewer::setMeshParameters(const MeshParameters& p) { m_render->setMeshParameters(p); }
+void OcctQWidgetViewer::setMeshQuality(double f) { m_cadModel->setMeshQuality(f); }
+void OcctQWidgetViewer::setLevelOfDetail(bool b) { m_render->setLevelOfDetail(b); }
+void OcctQWidgetViewer::setSizeCulling(double p, bool m) { m_render->setSizeCulling(p, m); }
+void OcctQWidgetViewer::setInteractionDegradation(bool b) { m_render->setInteractionDegradation(b); }
+void OcctQWidgetViewer::setDynamicResolution(bool b, double ms) { m_render->setDynamicResolution(b, ms); }
 void OcctQWidgetViewer::setOriginTrihedronVisible(bool theVisible){ m_render->setOriginTrihedronVisible(theVisible); }
 
 
@@ -142,6 +171,21 @@ bool OcctQWidgetViewer::loadCADModel(const QString& p) { return m_cadModel->load
 bool OcctQWidgetViewer::loadSTEPFile(const QString& p) { return m_cadModel->loadSTEPFile(p); }
 bool OcctQWidgetViewer::loadIGESFile(const QString& p) { return m_cadModel->loadIGESFile(p); }
 bool OcctQWidgetViewer::loadBREPFile(const QString& p) { return m_cadModel->loadBREPFile(p); }
+bool OcctQWidgetViewer::loadCADModelAsync(const QString& p) { return m_cadModel->loadCADModelAsync(p); }
+bool OcctQWidgetViewer::loadCADModelsAsync(const QStringList& p) { return m_cadModel->loadCADModelsAsync(p); }
+void OcctQWidgetViewer::cancelLoad() { m_cadModel->cancelLoad(); }
+bool OcctQWidgetViewer::isLoading() const { return m_cadModel->isLoading(); }
+void OcctQWidgetViewer::setParallelTransfer(bool b) { m_cadModel->setParallelTransfer(b); }
+void OcctQWidgetViewer::setStreamingDisplay(bool b) { m_cadModel->setStreamingDisplay(b); }
+void OcctQWidgetViewer::setAssemblyInstancing(bool b) { m_cadModel->setAssemblyInstancing(b); }
+void OcctQWidgetViewer::setLazyAssembly(bool b) { m_cadModel->setLazyAssembly(b); }
+void OcctQWidgetViewer::setProgressiveMesh(bool b) { m_cadModel->setProgressiveMesh(b); }
+void OcctQWidgetViewer::loadAssemblyNode(int theIndex) { m_cadModel->loadAssemblyNode(theIndex); }
+void OcctQWidgetViewer::setModelCacheEnabled(bool b) { m_cadModel->setModelCacheEnabled(b); }
+void OcctQWidgetViewer::setShapeHealing(bool b) { m_cadModel->setShapeHealing(b); }
+void OcctQWidgetViewer::setHealTimeBudget(qint64 ms) { m_cadModel->setHealTimeBudget(ms); }
+void OcctQWidgetViewer::clearModelCache() { m_cadModel->clearModelCache(); }
+void OcctQWidgetViewer::setMaxStepEntities(qint64 n) { m_cadModel->setMaxStepEntities(n); }
 QString OcctQWidgetViewer::getFileFormatFromExtension(const QString& p) const { return m_cadModel->getFileFormatFromExtension(p); }
 
 void OcctQWidgetViewer::calculateMeasurements() { m_measurement->calculateMeasurements(); }
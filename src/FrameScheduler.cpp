@@ -0,0 +1,158 @@
+// FrameScheduler.cpp
+#include "FrameScheduler.h"
+
+#include <QScreen>
+#include <QWidget>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    //! Used when the screen reports no refresh rate
+    const double THE_DEFAULT_REFRESH_HZ = 60.0;
+
+    //! User plus system CPU time of the whole process, every thread included.
+    //! std::clock() would do on POSIX, but MSVC's returns wall time.
+    qint64 processCpuMs()
+    {
+#ifdef _WIN32
+        FILETIME aCreation, anExit, aKernel, aUser;
+        if (!GetProcessTimes(GetCurrentProcess(), &aCreation, &anExit, &aKernel, &aUser)) return 0;
+        const auto toMs = [](const FILETIME& theTime) {
+            // 100 ns units
+            return qint64((quint64(theTime.dwHighDateTime) << 32 | theTime.dwLowDateTime) / 10000);
+        };
+        return toMs(aKernel) + toMs(aUser);
+#else
+        rusage aUsage;
+        if (getrusage(RUSAGE_SELF, &aUsage) != 0) return 0;
+        return qint64(aUsage.ru_utime.tv_sec + aUsage.ru_stime.tv_sec) * 1000
+             + (aUsage.ru_utime.tv_usec + aUsage.ru_stime.tv_usec) / 1000;
+#endif
+    }
+}
+
+QString FrameStats::summary() const
+{
+    QString aSummary = QString("%1 frames for %2 requests (%3 coalesced, %4 animation), idle %5 s at %6% CPU")
+                           .arg(rendered)
+                           .arg(requested)
+                           .arg(coalesced)
+                           .arg(animationFrames)
+                           .arg(idleMs / 1000.0, 0, 'f', 1)
+                           .arg(idleCpuPercent(), 0, 'f', 1);
+    if (degradedFrames > 0) aSummary += QString(", %1 light frames while navigating").arg(degradedFrames);
+    if (culled > 0) aSummary += QString(", %1 objects culled in the last frame").arg(culled);
+    return aSummary;
+}
+
+FrameScheduler::FrameScheduler(QWidget* theWidget)
+    : myWidget(theWidget)
+{
+    myTimer.setSingleShot(true);
+    myTimer.setTimerType(Qt::PreciseTimer);
+    QObject::connect(&myTimer, &QTimer::timeout, theWidget, [this]() { myWidget->update(); });
+    myClock.start();
+    resetStats();
+}
+
+void FrameScheduler::requestFrame()
+{
+    schedule(refreshIntervalMs());
+}
+
+void FrameScheduler::requestAnimationFrame()
+{
+    const double anAnimationMs = myMaxAnimationFps > 0.0 ? 1000.0 / myMaxAnimationFps : 0.0;
+    if (!myIsPending) ++myStats.animationFrames;
+    schedule(std::max(refreshIntervalMs(), anAnimationMs));
+}
+
+void FrameScheduler::schedule(double theIntervalMs)
+{
+    ++myStats.requested;
+    // A hidden widget gets no paint events; it is drawn when shown
+    if (!myWidget->isVisible()) return;
+    if (myIsPending) {
+        // The frame on its way picks this change up too
+        ++myStats.coalesced;
+        return;
+    }
+    myIsPending = true;
+    endIdle();
+
+    const double aSinceLastMs = myLastFrameNs < 0 ? theIntervalMs : (myClock.nsecsElapsed() - myLastFrameNs) / 1.0e6;
+    const int aDelayMs = int(std::ceil(theIntervalMs - aSinceLastMs));
+    if (aDelayMs > 0) {
+        myTimer.start(aDelayMs);
+    } else {
+        // Qt merges update() calls into one paint event anyway
+        myWidget->update();
+    }
+}
+
+void FrameScheduler::frameStarted()
+{
+    ++myStats.rendered;
+    myIsPending = false;
+    myTimer.stop();
+    myLastFrameNs = myClock.nsecsElapsed();
+    endIdle();
+}
+
+void FrameScheduler::frameFinished()
+{
+    myLastFrameMs = (myClock.nsecsElapsed() - myLastFrameNs) / 1.0e6;
+    // Nothing asked for during the paint: idle until the next request
+    if (myIsPending || myIsIdle) return;
+    myIsIdle = true;
+    myIdleStartMs = myClock.elapsed();
+    myIdleStartCpuMs = processCpuMs();
+}
+
+void FrameScheduler::frameSkipped()
+{
+    // Without a paint on its way a pending flag would swallow every later request as coalesced;
+    // the retry is paced so a view that cannot draw yet does not spin
+    myIsPending = myWidget->isVisible();
+    if (myIsPending) {
+        myTimer.start(int(std::ceil(refreshIntervalMs())));
+    } else {
+        myTimer.stop();
+    }
+}
+
+void FrameScheduler::endIdle()
+{
+    if (!myIsIdle) return;
+    myIsIdle = false;
+    myStats.idleMs += myClock.elapsed() - myIdleStartMs;
+    myStats.idleCpuMs += processCpuMs() - myIdleStartCpuMs;
+}
+
+void FrameScheduler::resetStats()
+{
+    myStats = FrameStats();
+    if (myIsIdle) {
+        myIdleStartMs = myClock.elapsed();
+        myIdleStartCpuMs = processCpuMs();
+    }
+}
+
+double FrameScheduler::refreshIntervalMs() const
+{
+    const QScreen* aScreen = myWidget->screen();
+    const double aRefreshHz = aScreen != nullptr && aScreen->refreshRate() > 1.0 ? aScreen->refreshRate()
+                                                                                 : THE_DEFAULT_REFRESH_HZ;
+    return 1000.0 / aRefreshHz;
+}
@@ -0,0 +1,459 @@
+// GlbExport.cpp
+#include "GlbExport.h"
+
+#include <BRep_Builder.hxx>
+#include <BRep_Tool.hxx>
+#include <BRepLib_ToolTriangulatedShape.hxx>
+#include <Message.hxx>
+#include <Poly_Triangulation.hxx>
+#include <Standard_Failure.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Compound.hxx>
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QHashFunctions>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    const quint32 THE_GLB_MAGIC = 0x46546C67;    // "glTF"
+    const quint32 THE_CHUNK_JSON = 0x4E4F534A;   // "JSON"
+    const quint32 THE_CHUNK_BIN = 0x004E4942;    // "BIN\0"
+
+    // The JSON chunk precedes the binary one but is only known once every mesh is written,
+    // so space is reserved up-front and padded with spaces (allowed by the GLB format)
+    const qint64 THE_JSON_RESERVE_BASE = 4096;
+    const qint64 THE_JSON_RESERVE_PER_MESH = 2048;
+
+    // glTF component types and buffer targets
+    const int THE_BYTE = 5120;
+    const int THE_SHORT = 5122;
+    const int THE_UNSIGNED_SHORT = 5123;
+    const int THE_UNSIGNED_INT = 5125;
+    const int THE_FLOAT = 5126;
+    const int THE_ARRAY_BUFFER = 34962;
+    const int THE_ELEMENT_ARRAY_BUFFER = 34963;
+
+    struct VertexKey {
+        float position[3];
+        float normal[3];
+        bool operator==(const VertexKey& theOther) const
+        {
+            return std::memcmp(this, &theOther, sizeof(VertexKey)) == 0;
+        }
+    };
+
+    struct VertexKeyHasher {
+        size_t operator()(const VertexKey& theKey) const { return qHashBits(&theKey, sizeof(VertexKey)); }
+    };
+
+    //! Welded triangle mesh of one solid, in model coordinates
+    class PartMesh
+    {
+    public:
+        explicit PartMesh(bool theQuantizedNormals) : myQuantizedNormals(theQuantizedNormals) {}
+
+        std::vector<float> Positions;
+        std::vector<float> Normals;
+        std::vector<quint32> Indices;
+        float Min[3];
+        float Max[3];
+
+        qint64 nbVertices() const { return qint64(Positions.size() / 3); }
+        qint64 nbTriangles() const { return qint64(Indices.size() / 3); }
+
+        void reset()
+        {
+            Positions.clear();
+            Normals.clear();
+            Indices.clear();
+            myWeld.clear();
+            std::fill(Min, Min + 3, std::numeric_limits<float>::max());
+            std::fill(Max, Max + 3, -std::numeric_limits<float>::max());
+        }
+
+        //! Append the face triangulation; false if the face has none
+        bool addFace(const TopoDS_Face& theFace)
+        {
+            TopLoc_Location aLoc;
+            const Handle(Poly_Triangulation)& aTri = BRep_Tool::Triangulation(theFace, aLoc);
+            if (aTri.IsNull() || aTri->NbTriangles() == 0) return false;
+            if (!aTri->HasNormals()) {
+                BRepLib_ToolTriangulatedShape::ComputeNormals(theFace, aTri);
+            }
+
+            const bool hasTrsf = !aLoc.IsIdentity();
+            const gp_Trsf aTrsf = aLoc.Transformation();
+            const bool isReversed = theFace.Orientation() == TopAbs_REVERSED;
+
+            std::vector<quint32> aNodeIndex(aTri->NbNodes());
+            for (int aNodeIter = 1; aNodeIter <= aTri->NbNodes(); ++aNodeIter) {
+                gp_Pnt aPnt = aTri->Node(aNodeIter);
+                gp_Dir aNorm = aTri->Normal(aNodeIter);
+                if (hasTrsf) {
+                    aPnt.Transform(aTrsf);
+                    aNorm.Transform(aTrsf);
+                }
+                if (isReversed) aNorm.Reverse();
+
+                VertexKey aKey;
+                aKey.position[0] = float(aPnt.X());
+                aKey.position[1] = float(aPnt.Y());
+                aKey.position[2] = float(aPnt.Z());
+                for (int aComp = 0; aComp < 3; ++aComp) {
+                    const float aValue = float(aNorm.Coord(aComp + 1));
+                    // Normals that end up as the same int8 triple weld into one vertex
+                    aKey.normal[aComp] = myQuantizedNormals ? std::round(aValue * 127.0f) / 127.0f : aValue;
+                }
+
+                const auto anInsert = myWeld.emplace(aKey, quint32(Positions.size() / 3));
+                if (anInsert.second) {
+                    for (int aComp = 0; aComp < 3; ++aComp) {
+                        Positions.push_back(aKey.position[aComp]);
+                        Normals.push_back(aKey.normal[aComp]);
+                        Min[aComp] = std::min(Min[aComp], aKey.position[aComp]);
+                        Max[aComp] = std::max(Max[aComp], aKey.position[aComp]);
+                    }
+                }
+                aNodeIndex[aNodeIter - 1] = anInsert.first->second;
+            }
+
+            for (int aTriIter = 1; aTriIter <= aTri->NbTriangles(); ++aTriIter) {
+                int aN1 = 0, aN2 = 0, aN3 = 0;
+                aTri->Triangle(aTriIter).Get(aN1, aN2, aN3);
+                if (isReversed) std::swap(aN2, aN3);
+
+                const quint32 anIdx[3] = { aNodeIndex[aN1 - 1], aNodeIndex[aN2 - 1], aNodeIndex[aN3 - 1] };
+                if (anIdx[0] == anIdx[1] || anIdx[1] == anIdx[2] || anIdx[0] == anIdx[2]) continue;
+                Indices.insert(Indices.end(), anIdx, anIdx + 3);
+            }
+            return true;
+        }
+
+    private:
+        bool myQuantizedNormals;
+        std::unordered_map<VertexKey, quint32, VertexKeyHasher> myWeld;
+    };
+
+    //! Binary chunk writer keeping every buffer view 4-byte aligned
+    class BinWriter
+    {
+    public:
+        explicit BinWriter(QFile& theFile) : myFile(theFile) {}
+
+        qint64 length() const { return myLength; }
+        bool isOk() const { return myIsOk; }
+
+        //! Write one buffer view and return its JSON description
+        QJsonObject addView(const void* theData, qint64 theSize, int theTarget, int theStride = 0)
+        {
+            QJsonObject aView;
+            aView["buffer"] = 0;
+            aView["byteOffset"] = double(myLength);
+            aView["byteLength"] = double(theSize);
+            if (theStride > 0) aView["byteStride"] = theStride;
+            aView["target"] = theTarget;
+
+            write(theData, theSize);
+            static const char THE_ZEROS[4] = { 0, 0, 0, 0 };
+            write(THE_ZEROS, (4 - theSize % 4) % 4);
+            return aView;
+        }
+
+    private:
+        void write(const void* theData, qint64 theSize)
+        {
+            if (theSize == 0 || !myIsOk) return;
+            myIsOk = myFile.write(static_cast<const char*>(theData), theSize) == theSize;
+            myLength += theSize;
+        }
+
+        QFile& myFile;
+        qint64 myLength = 0;
+        bool myIsOk = true;
+    };
+
+    QJsonArray jsonVec3(double theX, double theY, double theZ)
+    {
+        return QJsonArray{ theX, theY, theZ };
+    }
+
+    QJsonObject accessor(int theView, int theComponentType, qint64 theCount, const QString& theType)
+    {
+        QJsonObject anAccessor;
+        anAccessor["bufferView"] = theView;
+        anAccessor["componentType"] = theComponentType;
+        anAccessor["count"] = double(theCount);
+        anAccessor["type"] = theType;
+        return anAccessor;
+    }
+
+    void writeLE32(char* theDst, quint32 theValue)
+    {
+        for (int aByte = 0; aByte < 4; ++aByte) theDst[aByte] = char((theValue >> (8 * aByte)) & 0xFF);
+    }
+}
+
+bool GlbExport::write(const TopoDS_Shape& theShape, const QString& theFileName,
+                      const GlbExportOptions& theOptions, GlbExportStats& theStats, QString& theError)
+{
+    theStats = GlbExportStats();
+    if (theShape.IsNull()) {
+        theError = "No model loaded";
+        return false;
+    }
+
+    QElapsedTimer aTimer;
+    aTimer.start();
+
+    // One part per solid occurrence, plus the faces that belong to no solid
+    std::vector<TopoDS_Shape> aParts;
+    for (TopExp_Explorer anExp(theShape, TopAbs_SOLID); anExp.More(); anExp.Next()) {
+        aParts.push_back(anExp.Current());
+    }
+    {
+        BRep_Builder aBuilder;
+        TopoDS_Compound aFreeFaces;
+        aBuilder.MakeCompound(aFreeFaces);
+        bool hasFreeFaces = false;
+        for (TopExp_Explorer anExp(theShape, TopAbs_FACE, TopAbs_SOLID); anExp.More(); anExp.Next()) {
+            aBuilder.Add(aFreeFaces, anExp.Current());
+            hasFreeFaces = true;
+        }
+        if (hasFreeFaces) aParts.push_back(aFreeFaces);
+    }
+
+    QFile aFile(theFileName);
+    if (!aFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        theError = "Could not open file for writing: " + theFileName;
+        return false;
+    }
+
+    const qint64 aJsonReserve = THE_JSON_RESERVE_BASE + THE_JSON_RESERVE_PER_MESH * qint64(aParts.size());
+    const qint64 aBinStart = 12 + 8 + aJsonReserve + 8;
+    if (!aFile.seek(aBinStart)) {
+        theError = "Could not write " + theFileName;
+        return false;
+    }
+
+    QJsonArray aNodes, aChildren, aMeshes, anAccessors, aViews;
+    BinWriter aBin(aFile);
+    PartMesh aMesh(theOptions.quantize);
+
+    try {
+        for (size_t aPartIter = 0; aPartIter < aParts.size() && aBin.isOk(); ++aPartIter) {
+            aMesh.reset();
+            for (TopExp_Explorer anExp(aParts[aPartIter], TopAbs_FACE); anExp.More(); anExp.Next()) {
+                if (!aMesh.addFace(TopoDS::Face(anExp.Current()))) ++theStats.skippedFaces;
+            }
+            if (aMesh.nbTriangles() == 0) continue;
+
+            const qint64 aNbVerts = aMesh.nbVertices();
+            QJsonObject aNode;
+            aNode["name"] = aParts[aPartIter].ShapeType() == TopAbs_SOLID ? QString("Solid %1").arg(aPartIter + 1)
+                                                                         : QString("Faces");
+            aNode["mesh"] = aMeshes.size();
+
+            // POSITION
+            QJsonObject aPosAccessor;
+            if (theOptions.quantize) {
+                // int16 in [-32767, 32767] over the part box, mapped back by the node transform.
+                // One step for all axes: a uniform scale leaves the unscaled normals valid
+                double aCenter[3], aHalf = 0.0;
+                for (int aComp = 0; aComp < 3; ++aComp) {
+                    aCenter[aComp] = 0.5 * (double(aMesh.Min[aComp]) + double(aMesh.Max[aComp]));
+                    aHalf = std::max(aHalf, 0.5 * (double(aMesh.Max[aComp]) - double(aMesh.Min[aComp])));
+                }
+                const double aStep = aHalf > 0.0 ? aHalf / 32767.0 : 1.0;
+                std::vector<qint16> aQuantized(size_t(aNbVerts) * 4, 0);
+                int aQMin[3] = { 32767, 32767, 32767 };
+                int aQMax[3] = { -32767, -32767, -32767 };
+                for (qint64 aVert = 0; aVert < aNbVerts; ++aVert) {
+                    for (int aComp = 0; aComp < 3; ++aComp) {
+                        const double aValue = (aMesh.Positions[aVert * 3 + aComp] - aCenter[aComp]) / aStep;
+                        const int aQ = std::max(-32767, std::min(32767, int(std::lround(aValue))));
+                        aQuantized[aVert * 4 + aComp] = qint16(aQ);
+                        aQMin[aComp] = std::min(aQMin[aComp], aQ);
+                        aQMax[aComp] = std::max(aQMax[aComp], aQ);
+                    }
+                }
+                aViews.append(aBin.addView(aQuantized.data(), qint64(aQuantized.size() * sizeof(qint16)),
+                                           THE_ARRAY_BUFFER, 8));
+                aPosAccessor = accessor(aViews.size() - 1, THE_SHORT, aNbVerts, "VEC3");
+                aPosAccessor["min"] = jsonVec3(aQMin[0], aQMin[1], aQMin[2]);
+                aPosAccessor["max"] = jsonVec3(aQMax[0], aQMax[1], aQMax[2]);
+                aNode["translation"] = jsonVec3(aCenter[0], aCenter[1], aCenter[2]);
+                aNode["scale"] = jsonVec3(aStep, aStep, aStep);
+            } else {
+                aViews.append(aBin.addView(aMesh.Positions.data(), qint64(aMesh.Positions.size() * sizeof(float)),
+                                           THE_ARRAY_BUFFER));
+                aPosAccessor = accessor(aViews.size() - 1, THE_FLOAT, aNbVerts, "VEC3");
+                aPosAccessor["min"] = jsonVec3(aMesh.Min[0], aMesh.Min[1], aMesh.Min[2]);
+                aPosAccessor["max"] = jsonVec3(aMesh.Max[0], aMesh.Max[1], aMesh.Max[2]);
+            }
+            anAccessors.append(aPosAccessor);
+            const int aPosIndex = anAccessors.size() - 1;
+
+            // NORMAL
+            if (theOptions.quantize) {
+                std::vector<qint8> aQuantized(size_t(aNbVerts) * 4, 0);
+                for (qint64 aVert = 0; aVert < aNbVerts; ++aVert) {
+                    for (int aComp = 0; aComp < 3; ++aComp) {
+                        aQuantized[aVert * 4 + aComp] = qint8(std::lround(aMesh.Normals[aVert * 3 + aComp] * 127.0f));
+                    }
+                }
+                aViews.append(aBin.addView(aQuantized.data(), qint64(aQuantized.size()), THE_ARRAY_BUFFER, 4));
+                QJsonObject aNormAccessor = accessor(aViews.size() - 1, THE_BYTE, aNbVerts, "VEC3");
+                aNormAccessor["normalized"] = true;
+                anAccessors.append(aNormAccessor);
+            } else {
+                aViews.append(aBin.addView(aMesh.Normals.data(), qint64(aMesh.Normals.size() * sizeof(float)),
+                                           THE_ARRAY_BUFFER));
+                anAccessors.append(accessor(aViews.size() - 1, THE_FLOAT, aNbVerts, "VEC3"));
+            }
+            const int aNormIndex = anAccessors.size() - 1;
+
+            // Indices, 16-bit whenever the part allows it
+            if (aNbVerts <= 65535) {
+                std::vector<quint16> aShort(aMesh.Indices.begin(), aMesh.Indices.end());
+                aViews.append(aBin.addView(aShort.data(), qint64(aShort.size() * sizeof(quint16)),
+                                           THE_ELEMENT_ARRAY_BUFFER));
+                anAccessors.append(accessor(aViews.size() - 1, THE_UNSIGNED_SHORT, qint64(aShort.size()), "SCALAR"));
+            } else {
+                aViews.append(aBin.addView(aMesh.Indices.data(), qint64(aMesh.Indices.size() * sizeof(quint32)),
+                                           THE_ELEMENT_ARRAY_BUFFER));
+                anAccessors.append(accessor(aViews.size() - 1, THE_UNSIGNED_INT,
+                                            qint64(aMesh.Indices.size()), "SCALAR"));
+            }
+
+            QJsonObject anAttributes;
+            anAttributes["POSITION"] = aPosIndex;
+            anAttributes["NORMAL"] = aNormIndex;
+            QJsonObject aPrimitive;
+            aPrimitive["attributes"] = anAttributes;
+            aPrimitive["indices"] = anAccessors.size() - 1;
+            aPrimitive["material"] = 0;
+            aPrimitive["mode"] = 4;
+            QJsonObject aMeshJson;
+            aMeshJson["name"] = aNode["name"];
+            aMeshJson["primitives"] = QJsonArray{ aPrimitive };
+            aMeshes.append(aMeshJson);
+
+            aChildren.append(aNodes.size() + 1);  // node 0 is the root
+            aNodes.append(aNode);
+            theStats.vertices += aNbVerts;
+            theStats.triangles += aMesh.nbTriangles();
+        }
+    } catch (const Standard_Failure& e) {
+        theError = QString("Triangulation export failed: ") + e.GetMessageString();
+        aFile.remove();
+        return false;
+    }
+    aMesh.reset();
+
+    if (!aBin.isOk()) {
+        theError = "Could not write " + theFileName;
+        aFile.remove();
+        return false;
+    }
+    if (aMeshes.isEmpty()) {
+        theError = "The model has no triangulation to export";
+        aFile.remove();
+        return false;
+    }
+    if (aBinStart + aBin.length() > qint64(0xFFFFFFFF)) {
+        theError = "The mesh exceeds the 4 GB limit of a GLB file";
+        aFile.remove();
+        return false;
+    }
+    theStats.meshes = aMeshes.size();
+
+    // Root: model units to metres and CAD Z-up to glTF Y-up
+    QJsonObject aRoot;
+    aRoot["name"] = QFileInfo(theFileName).completeBaseName();
+    aRoot["children"] = aChildren;
+    const double aHalfSqrt2 = 0.70710678118654752;
+    aRoot["rotation"] = QJsonArray{ -aHalfSqrt2, 0.0, 0.0, aHalfSqrt2 };
+    aRoot["scale"] = jsonVec3(theOptions.unitScale, theOptions.unitScale, theOptions.unitScale);
+    aNodes.prepend(aRoot);
+
+    QJsonObject aPbr;
+    aPbr["baseColorFactor"] = QJsonArray{ 0.83, 0.83, 0.83, 1.0 };
+    aPbr["metallicFactor"] = 0.0;
+    aPbr["roughnessFactor"] = 0.5;
+    QJsonObject aMaterial;
+    aMaterial["pbrMetallicRoughness"] = aPbr;
+    aMaterial["doubleSided"] = true;
+
+    QJsonObject aBuffer;
+    aBuffer["byteLength"] = double(aBin.length());
+
+    QJsonObject anAsset;
+    anAsset["version"] = "2.0";
+    anAsset["generator"] = "CADViewer";
+
+    QJsonObject aGltf;
+    aGltf["asset"] = anAsset;
+    if (theOptions.quantize) {
+        aGltf["extensionsUsed"] = QJsonArray{ "KHR_mesh_quantization" };
+        aGltf["extensionsRequired"] = QJsonArray{ "KHR_mesh_quantization" };
+    }
+    aGltf["scene"] = 0;
+    aGltf["scenes"] = QJsonArray{ QJsonObject{ { "nodes", QJsonArray{ 0 } } } };
+    aGltf["nodes"] = aNodes;
+    aGltf["meshes"] = aMeshes;
+    aGltf["materials"] = QJsonArray{ aMaterial };
+    aGltf["accessors"] = anAccessors;
+    aGltf["bufferViews"] = aViews;
+    aGltf["buffers"] = QJsonArray{ aBuffer };
+
+    QByteArray aJson = QJsonDocument(aGltf).toJson(QJsonDocument::Compact);
+    if (aJson.size() > aJsonReserve) {
+        theError = "GLB header exceeds the reserved space";
+        aFile.remove();
+        return false;
+    }
+    aJson.append(QByteArray(int(aJsonReserve - aJson.size()), ' '));
+
+    char aHeader[20];
+    writeLE32(aHeader, THE_GLB_MAGIC);
+    writeLE32(aHeader + 4, 2);
+    writeLE32(aHeader + 8, quint32(aBinStart + aBin.length()));
+    writeLE32(aHeader + 12, quint32(aJsonReserve));
+    writeLE32(aHeader + 16, THE_CHUNK_JSON);
+    char aBinHeader[8];
+    writeLE32(aBinHeader, quint32(aBin.length()));
+    writeLE32(aBinHeader + 4, THE_CHUNK_BIN);
+
+    const bool isWritten = aFile.seek(0)
+                        && aFile.write(aHeader, sizeof(aHeader)) == qint64(sizeof(aHeader))
+                        && aFile.write(aJson) == aJson.size()
+                        && aFile.write(aBinHeader, sizeof(aBinHeader)) == qint64(sizeof(aBinHeader));
+    aFile.close();
+    if (!isWritten || aFile.error() != QFileDevice::NoError) {
+        theError = "Could not write " + theFileName;
+        aFile.remove();
+        return false;
+    }
+
+    theStats.bytes = aBinStart + aBin.length();
+    Message::SendInfo() << "GLB export: " << theStats.meshes << " meshes, " << theStats.vertices << " vertices, "
+                        << theStats.triangles << " triangles, " << theStats.bytes / 1024 << " KB in "
+                        << aTimer.elapsed() << " ms";
+    if (theStats.skippedFaces > 0) {
+        Message::SendWarning() << "GLB export: " << theStats.skippedFaces << " faces without triangulation skipped";
+    }
+    return true;
+}
@@ -16,9 +16,110 @@
 #include <AIS_InteractiveContext.hxx>
 #include <AIS_ViewCube.hxx>
 
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    //! Picks the latency percentiles are taken over
+    const size_t THE_LATENCY_SAMPLES = 1000;
+}
+
+QString HoverPickStats::summary() const
+{
+    return QString("%1 picks for %2 moves, %3 highlight changes, latency p50 %4 / p95 %5 / p99 %6 / max %7 ms")
+        .arg(picks)
+        .arg(moves)
+        .arg(changes)
+        .arg(p50Ms, 0, 'f', 1)
+        .arg(p95Ms, 0, 'f', 1)
+        .arg(p99Ms, 0, 'f', 1)
+        .arg(maxMs, 0, 'f', 1);
+}
+
 InputManager::InputManager(OcctQWidgetViewer* viewer)
     : m_viewer(viewer)
 {
+    myHoverTimer.setSingleShot(true);
+    myHoverTimer.setTimerType(Qt::PreciseTimer);
+    QObject::connect(&myHoverTimer, &QTimer::timeout, viewer, [this]() { pickHover(); });
+    myHoverClock.start();
+    myPickLatencies.reserve(THE_LATENCY_SAMPLES);
+}
+
+HoverPickStats InputManager::hoverStats() const
+{
+    HoverPickStats aStats = myHoverStats;
+    if (myPickLatencies.empty()) return aStats;
+
+    std::vector<double> aSorted = myPickLatencies;
+    std::sort(aSorted.begin(), aSorted.end());
+    const auto percentile = [&aSorted](double theFraction) {
+        return aSorted[std::min(aSorted.size() - 1, size_t(std::ceil(theFraction * aSorted.size())) - 1)];
+    };
+    aStats.p50Ms = percentile(0.50);
+    aStats.p95Ms = percentile(0.95);
+    aStats.p99Ms = percentile(0.99);
+    aStats.maxMs = aSorted.back();
+    return aStats;
+}
+
+void InputManager::resetHoverStats()
+{
+    myHoverStats = HoverPickStats();
+    myPickLatencies.clear();
+    myNextLatency = 0;
+}
+
+void InputManager::scheduleHoverPick(int theX, int theY)
+{
+    ++myHoverStats.moves;
+    myHoverX = theX;
+    myHoverY = theY;
+    myHoverMoveNs = myHoverClock.nsecsElapsed();
+    // A pick already due takes this position instead of the one it was scheduled for
+    if (myHoverTimer.isActive()) return;
+
+    const double anIntervalMs = m_viewer->m_render->refreshIntervalMs();
+    const double aSinceLastMs = myLastPickNs < 0 ? anIntervalMs : (myHoverMoveNs - myLastPickNs) / 1.0e6;
+    // 0 still waits for the queued input events, so a burst of moves ends in one pick
+    myHoverTimer.start(std::max(0, int(std::ceil(anIntervalMs - aSinceLastMs))));
+}
+
+void InputManager::pickHover()
+{
+    if (m_viewer->myView.IsNull() || m_viewer->myContext.IsNull()) return;
+
+    try {
+        m_viewer->myContext->MoveTo(myHoverX, myHoverY, m_viewer->myView, Standard_False);
+    } catch (const Standard_Failure& e) {
+        Message::SendWarning() << "Hover pick error: " << e.GetMessageString();
+        return;
+    }
+    myLastPickNs = myHoverClock.nsecsElapsed();
+    ++myHoverStats.picks;
+
+    const double aLatencyMs = (myLastPickNs - myHoverMoveNs) / 1.0e6;
+    if (myPickLatencies.size() < THE_LATENCY_SAMPLES) {
+        myPickLatencies.push_back(aLatencyMs);
+    } else {
+        myPickLatencies[myNextLatency] = aLatencyMs;
+        myNextLatency = (myNextLatency + 1) % THE_LATENCY_SAMPLES;
+    }
+
+    // Moving within one face or across empty space needs no frame
+    const Handle(SelectMgr_EntityOwner) anOwner = m_viewer->myContext->HasDetected()
+                                                ? m_viewer->myContext->DetectedOwner()
+                                                : Handle(SelectMgr_EntityOwner)();
+    if (anOwner == myHoveredOwner) return;
+    myHoveredOwner = anOwner;
+    ++myHoverStats.changes;
+    m_viewer->updateView();
+}
+
+void InputManager::cancelHoverPick()
+{
+    myHoverTimer.stop();
 }
 
 void InputManager::keyPressEvent(QKeyEvent* theEvent)
@@ -37,7 +138,7 @@ void InputManager::keyPressEvent(QKeyEvent* theEvent)
 
     case Aspect_VKey_F:
         m_viewer->myView->FitAll(0.01, false);
-        m_viewer->update();
+        m_viewer->updateView();
         theEvent->accept();
         return;
 
@@ -63,12 +164,14 @@ void InputManager::mouseMoveEvent(QMouseEvent* theEvent)
 
     try {
         if (theEvent->buttons() != Qt::NoButton) {
+            cancelHoverPick();
             if (OcctQtTools::qtHandleMouseEvent(*m_viewer, m_viewer->myView, theEvent)) {
                 m_viewer->updateView();
             }
         }
         else {
-            m_viewer->myContext->MoveTo(aX, aY, m_viewer->myView, Standard_True);
+            // Picking runs off the event, once per refresh, for the latest position
+            scheduleHoverPick(aX, aY);
         }
 
     } catch (const Standard_Failure& e) {
@@ -89,7 +192,11 @@ void InputManager::mousePressEvent(QMouseEvent* theEvent)
     const Standard_Integer aY = theEvent->pos().y();
 
     try {
+        // A click selects what is under the cursor now, not at the last hover pick
+        cancelHoverPick();
         m_viewer->myContext->MoveTo(aX, aY, m_viewer->myView, Standard_False);
+        myHoveredOwner = m_viewer->myContext->HasDetected() ? m_viewer->myContext->DetectedOwner()
+                                                            : Handle(SelectMgr_EntityOwner)();
 
         // 1. Handle Navigation (Right/Middle click)
         if (theEvent->button() == Qt::RightButton || theEvent->button() == Qt::MiddleButton) {
@@ -0,0 +1,385 @@
+// LazyAssembly.cpp
+#include "LazyAssembly.h"
+#include "OcctQtTools.h"
+#include "TransferLock.h"
+
+#include <IFSelect_ReturnStatus.hxx>
+#include <Interface_EntityIterator.hxx>
+#include <Interface_Graph.hxx>
+#include <Interface_InterfaceModel.hxx>
+#include <Message.hxx>
+#include <Message_ProgressScope.hxx>
+#include <OSD.hxx>
+#include <Standard_Failure.hxx>
+#include <StepBasic_Product.hxx>
+#include <StepBasic_ProductDefinition.hxx>
+#include <StepBasic_ProductDefinitionFormation.hxx>
+#include <StepGeom_Axis2Placement3d.hxx>
+#include <StepGeom_CartesianPoint.hxx>
+#include <StepGeom_Direction.hxx>
+#include <StepRepr_ItemDefinedTransformation.hxx>
+#include <StepRepr_NextAssemblyUsageOccurrence.hxx>
+#include <StepRepr_ProductDefinitionShape.hxx>
+#include <StepRepr_Representation.hxx>
+#include <StepRepr_RepresentationRelationshipWithTransformation.hxx>
+#include <StepRepr_ShapeRepresentationRelationship.hxx>
+#include <StepRepr_Transformation.hxx>
+#include <StepShape_ContextDependentShapeRepresentation.hxx>
+#include <StepShape_ShapeDefinitionRepresentation.hxx>
+#include <TColStd_SequenceOfAsciiString.hxx>
+#include <gp_Ax3.hxx>
+
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace
+{
+    //! Transferred shapes are in millimetres; the scan works on raw file values
+    double lengthFactorToMm(STEPControl_Reader& theReader)
+    {
+        TColStd_SequenceOfAsciiString aLengthNames, anAngleNames, aSolidAngleNames;
+        theReader.FileUnits(aLengthNames, anAngleNames, aSolidAngleNames);
+        if (aLengthNames.IsEmpty()) return 1.0;
+
+        TCollection_AsciiString aName = aLengthNames.First();
+        aName.UpperCase();
+        if (aName.Search("INCH") > 0 || aName == "IN") return 25.4;
+        if (aName.Search("FOOT") > 0 || aName.Search("FEET") > 0 || aName == "FT") return 304.8;
+        if (aName.Search("MILLI") > 0 || aName == "MM") return 1.0;
+        if (aName.Search("CENTI") > 0 || aName == "CM") return 10.0;
+        if (aName.Search("MICRO") > 0 || aName == "UM") return 0.001;
+        if (aName.Search("KILO") > 0 || aName == "KM") return 1.0e6;
+        if (aName.Search("METRE") > 0 || aName.Search("METER") > 0 || aName == "M") return 1000.0;
+        return 1.0;
+    }
+
+    QString productName(const Handle(StepBasic_ProductDefinition)& theDef)
+    {
+        if (theDef.IsNull() || theDef->Formation().IsNull()) return QString();
+        const Handle(StepBasic_Product) aProduct = theDef->Formation()->OfProduct();
+        if (aProduct.IsNull() || aProduct->Name().IsNull()) return QString();
+        return QString::fromUtf8(aProduct->Name()->ToCString());
+    }
+
+    bool toDir(const Handle(StepGeom_Direction)& theDir, gp_Dir& theResult)
+    {
+        if (theDir.IsNull() || theDir->NbDirectionRatios() != 3) return false;
+        const gp_Vec aVec(theDir->DirectionRatiosValue(1), theDir->DirectionRatiosValue(2),
+                          theDir->DirectionRatiosValue(3));
+        if (aVec.Magnitude() <= gp::Resolution()) return false;
+        theResult = gp_Dir(aVec);
+        return true;
+    }
+
+    gp_Ax3 toAx3(const Handle(StepGeom_Axis2Placement3d)& thePlacement, double theFactor)
+    {
+        gp_Pnt aLoc;
+        const Handle(StepGeom_CartesianPoint) aPnt = thePlacement->Location();
+        if (!aPnt.IsNull() && aPnt->NbCoordinates() == 3) {
+            aLoc.SetCoord(aPnt->CoordinatesValue(1) * theFactor, aPnt->CoordinatesValue(2) * theFactor,
+                          aPnt->CoordinatesValue(3) * theFactor);
+        }
+        gp_Dir aZ = gp::DZ(), aX = gp::DX();
+        if (thePlacement->HasAxis()) toDir(thePlacement->Axis(), aZ);
+        if (thePlacement->HasRefDirection()) toDir(thePlacement->RefDirection(), aX);
+        try {
+            return gp_Ax3(aLoc, aZ, aX);
+        } catch (const Standard_Failure&) {
+            // Reference direction parallel to the axis
+            return gp_Ax3(aLoc, aZ);
+        }
+    }
+
+    //! Product structure and point bounds over the entity graph of a read model
+    class StructureScan
+    {
+    public:
+        StructureScan(const Handle(Interface_InterfaceModel)& theModel, double theFactor)
+            : myModel(theModel),
+              myGraph(theModel),
+              myFactor(theFactor),
+              myVisitedBy(theModel->NbEntities() + 1, 0)
+        {
+            for (Standard_Integer anIdx = 1; anIdx <= theModel->NbEntities(); ++anIdx) {
+                Handle(StepRepr_NextAssemblyUsageOccurrence) aUsage =
+                    Handle(StepRepr_NextAssemblyUsageOccurrence)::DownCast(theModel->Value(anIdx));
+                if (aUsage.IsNull() || aUsage->RelatingProductDefinition().IsNull()
+                 || aUsage->RelatedProductDefinition().IsNull()) continue;
+                myChildren[aUsage->RelatingProductDefinition().get()].push_back(aUsage);
+                myComponents.insert(aUsage->RelatedProductDefinition().get());
+            }
+        }
+
+        //! Assemblies that are nobody's component
+        std::vector<Handle(StepBasic_ProductDefinition)> topProducts() const
+        {
+            std::vector<Handle(StepBasic_ProductDefinition)> aTops;
+            for (const auto& aPair : myChildren) {
+                if (myComponents.count(aPair.first) != 0) continue;
+                aTops.push_back(aPair.second.front()->RelatingProductDefinition());
+            }
+            return aTops;
+        }
+
+        const std::vector<Handle(StepRepr_NextAssemblyUsageOccurrence)>& children(
+            const Handle(StepBasic_ProductDefinition)& theDef) const
+        {
+            static const std::vector<Handle(StepRepr_NextAssemblyUsageOccurrence)> THE_NONE;
+            const auto anIter = myChildren.find(theDef.get());
+            return anIter != myChildren.end() ? anIter->second : THE_NONE;
+        }
+
+        //! Bounds of a product in its own coordinates, components included
+        Bnd_Box productBox(const Handle(StepBasic_ProductDefinition)& theDef)
+        {
+            const auto aCached = myProductBoxes.find(theDef.get());
+            if (aCached != myProductBoxes.end()) return aCached->second;
+            myProductBoxes[theDef.get()] = Bnd_Box(); // cycle guard
+
+            Bnd_Box aBox;
+            for (const Handle(StepRepr_Representation)& aRep : representations(theDef)) {
+                aBox.Add(representationBox(aRep));
+            }
+            for (const Handle(StepRepr_NextAssemblyUsageOccurrence)& aUsage : children(theDef)) {
+                const Bnd_Box aChildBox = productBox(aUsage->RelatedProductDefinition());
+                if (!aChildBox.IsVoid()) aBox.Add(aChildBox.Transformed(usagePlacement(aUsage)));
+            }
+            myProductBoxes[theDef.get()] = aBox;
+            return aBox;
+        }
+
+        int partCount(const Handle(StepBasic_ProductDefinition)& theDef, int theDepth = 0)
+        {
+            int aCount = 1;
+            if (theDepth > 64) return aCount;
+            for (const Handle(StepRepr_NextAssemblyUsageOccurrence)& aUsage : children(theDef)) {
+                aCount += partCount(aUsage->RelatedProductDefinition(), theDepth + 1);
+            }
+            return aCount;
+        }
+
+        //! Placement of a component in its parent from the context dependent representation
+        gp_Trsf usagePlacement(const Handle(StepRepr_NextAssemblyUsageOccurrence)& theUsage)
+        {
+            gp_Trsf aTrsf;
+            Interface_EntityIterator aShapes = myGraph.Sharings(theUsage);
+            for (aShapes.Start(); aShapes.More(); aShapes.Next()) {
+                if (!aShapes.Value()->IsKind(STANDARD_TYPE(StepRepr_ProductDefinitionShape))) continue;
+
+                Interface_EntityIterator aReps = myGraph.Sharings(aShapes.Value());
+                for (aReps.Start(); aReps.More(); aReps.Next()) {
+                    Handle(StepShape_ContextDependentShapeRepresentation) aCdsr =
+                        Handle(StepShape_ContextDependentShapeRepresentation)::DownCast(aReps.Value());
+                    if (aCdsr.IsNull()) continue;
+
+                    Handle(StepRepr_RepresentationRelationshipWithTransformation) aRel =
+                        Handle(StepRepr_RepresentationRelationshipWithTransformation)::DownCast(
+                            aCdsr->RepresentationRelation());
+                    if (aRel.IsNull()) continue;
+
+                    const Handle(StepRepr_ItemDefinedTransformation) anItemTrsf =
+                        aRel->TransformationOperator().ItemDefinedTransformation();
+                    if (anItemTrsf.IsNull()) continue;
+
+                    Handle(StepGeom_Axis2Placement3d) anOrigin =
+                        Handle(StepGeom_Axis2Placement3d)::DownCast(anItemTrsf->TransformItem1());
+                    Handle(StepGeom_Axis2Placement3d) aTarget =
+                        Handle(StepGeom_Axis2Placement3d)::DownCast(anItemTrsf->TransformItem2());
+                    if (anOrigin.IsNull() || aTarget.IsNull()) continue;
+
+                    aTrsf.SetDisplacement(toAx3(anOrigin, myFactor), toAx3(aTarget, myFactor));
+                    return aTrsf;
+                }
+            }
+            return aTrsf;
+        }
+
+    private:
+        //! Shape representations of a product, plus those linked to them without a placement
+        std::vector<Handle(StepRepr_Representation)> representations(const Handle(StepBasic_ProductDefinition)& theDef)
+        {
+            std::vector<Handle(StepRepr_Representation)> aReps;
+            Interface_EntityIterator aShapes = myGraph.Sharings(theDef);
+            for (aShapes.Start(); aShapes.More(); aShapes.Next()) {
+                if (!aShapes.Value()->IsKind(STANDARD_TYPE(StepRepr_ProductDefinitionShape))) continue;
+
+                Interface_EntityIterator aDefReps = myGraph.Sharings(aShapes.Value());
+                for (aDefReps.Start(); aDefReps.More(); aDefReps.Next()) {
+                    Handle(StepShape_ShapeDefinitionRepresentation) aSdr =
+                        Handle(StepShape_ShapeDefinitionRepresentation)::DownCast(aDefReps.Value());
+                    if (!aSdr.IsNull() && !aSdr->UsedRepresentation().IsNull()) {
+                        aReps.push_back(aSdr->UsedRepresentation());
+                    }
+                }
+            }
+
+            // e.g. SHAPE_REPRESENTATION -> ADVANCED_BREP_SHAPE_REPRESENTATION
+            for (size_t anIdx = 0; anIdx < aReps.size(); ++anIdx) {
+                Interface_EntityIterator aRels = myGraph.Sharings(aReps[anIdx]);
+                for (aRels.Start(); aRels.More(); aRels.Next()) {
+                    Handle(StepRepr_ShapeRepresentationRelationship) aRel =
+                        Handle(StepRepr_ShapeRepresentationRelationship)::DownCast(aRels.Value());
+                    if (aRel.IsNull()
+                     || aRel->IsKind(STANDARD_TYPE(StepRepr_RepresentationRelationshipWithTransformation))) continue;
+
+                    const Handle(StepRepr_Representation) anOther =
+                        aRel->Rep1() == aReps[anIdx] ? aRel->Rep2() : aRel->Rep1();
+                    if (!anOther.IsNull() && std::find(aReps.begin(), aReps.end(), anOther) == aReps.end()) {
+                        aReps.push_back(anOther);
+                    }
+                }
+            }
+            return aReps;
+        }
+
+        Bnd_Box representationBox(const Handle(StepRepr_Representation)& theRep)
+        {
+            const auto aCached = myRepBoxes.find(theRep.get());
+            if (aCached != myRepBoxes.end()) return aCached->second;
+
+            // Each representation walks its own entities: geometry shared with one already
+            // measured still belongs to this box. A new mark per walk saves clearing the flags.
+            const int aWalk = ++myNbWalks;
+            Bnd_Box aBox;
+            std::vector<Handle(Standard_Transient)> aStack;
+            for (Standard_Integer anItem = 1; anItem <= theRep->NbItems(); ++anItem) {
+                aStack.push_back(theRep->ItemsValue(anItem));
+            }
+            while (!aStack.empty()) {
+                const Handle(Standard_Transient) anEnt = aStack.back();
+                aStack.pop_back();
+                const Standard_Integer aNum = myModel->Number(anEnt);
+                if (aNum <= 0 || myVisitedBy[aNum] == aWalk) continue;
+                myVisitedBy[aNum] = aWalk;
+
+                Handle(StepGeom_CartesianPoint) aPnt = Handle(StepGeom_CartesianPoint)::DownCast(anEnt);
+                if (!aPnt.IsNull()) {
+                    if (aPnt->NbCoordinates() == 3) {
+                        aBox.Add(gp_Pnt(aPnt->CoordinatesValue(1) * myFactor, aPnt->CoordinatesValue(2) * myFactor,
+                                        aPnt->CoordinatesValue(3) * myFactor));
+                    }
+                    continue;
+                }
+                Interface_EntityIterator aShareds = myGraph.Shareds(anEnt);
+                for (aShareds.Start(); aShareds.More(); aShareds.Next()) {
+                    aStack.push_back(aShareds.Value());
+                }
+            }
+            myRepBoxes[theRep.get()] = aBox;
+            return aBox;
+        }
+
+        Handle(Interface_InterfaceModel) myModel;
+        Interface_Graph myGraph;
+        double myFactor;
+        std::vector<int> myVisitedBy;  // per entity, the representationBox() walk that reached it last
+        int myNbWalks = 0;
+        std::unordered_map<const Standard_Transient*, std::vector<Handle(StepRepr_NextAssemblyUsageOccurrence)>> myChildren;
+        std::unordered_set<const Standard_Transient*> myComponents;
+        std::unordered_map<const Standard_Transient*, Bnd_Box> myProductBoxes;
+        std::unordered_map<const Standard_Transient*, Bnd_Box> myRepBoxes;
+    };
+}
+
+std::shared_ptr<LazyStepAssembly> LazyStepAssembly::open(const QString& theFilePath,
+                                                         const Message_ProgressRange& theProgress)
+{
+    Message::SendInfo() << "Reading STEP assembly structure: " << theFilePath.toStdString();
+    QElapsedTimer aTimer;
+    aTimer.start();
+    OSD::SetSignal(false);
+
+    std::shared_ptr<LazyStepAssembly> anAssembly(new LazyStepAssembly());
+    Message_ProgressScope aPS(theProgress, "Reading STEP structure", 4);
+    try {
+        OCC_CATCH_SIGNALS
+        const TCollection_AsciiString aPath = OcctQtTools::qtStringToOcct(theFilePath);
+        const IFSelect_ReturnStatus aStatus = anAssembly->myReader.ReadFile(aPath.ToCString());
+        if (aStatus != IFSelect_RetDone) {
+            Message::SendFail() << "Failed to read STEP file. Status: " << (int)aStatus;
+            return nullptr;
+        }
+        aPS.Next(3);
+        if (aPS.UserBreak()) return nullptr;
+
+        StructureScan aScan(anAssembly->myReader.Model(), lengthFactorToMm(anAssembly->myReader));
+        for (const Handle(StepBasic_ProductDefinition)& aTop : aScan.topProducts()) {
+            for (const Handle(StepRepr_NextAssemblyUsageOccurrence)& aUsage : aScan.children(aTop)) {
+                const Handle(StepBasic_ProductDefinition) aDef = aUsage->RelatedProductDefinition();
+
+                LazyAssemblyNode aNode;
+                aNode.name = productName(aDef);
+                if (aNode.name.isEmpty()) aNode.name = QString("Subassembly %1").arg(anAssembly->myNodes.size() + 1);
+                const Bnd_Box aBox = aScan.productBox(aDef);
+                if (!aBox.IsVoid()) aNode.box = aBox.Transformed(aScan.usagePlacement(aUsage));
+                aNode.partCount = aScan.partCount(aDef);
+
+                anAssembly->myNodes.append(aNode);
+                anAssembly->myUsages.append(aUsage);
+            }
+        }
+        aPS.Next();
+    } catch (const Standard_Failure& e) {
+        Message::SendFail() << "CRITICAL ERROR: " << e.GetMessageString();
+        return nullptr;
+    }
+
+    if (anAssembly->myNodes.isEmpty()) return nullptr;
+
+    Message::SendInfo() << "Assembly structure: " << anAssembly->myNodes.size()
+                        << " subassemblies in " << aTimer.elapsed() << " ms, geometry deferred";
+    return anAssembly;
+}
+
+TopoDS_Shape LazyStepAssembly::transferNode(int theIndex, const MeshParameters& theParams)
+{
+    if (theIndex < 0 || theIndex >= myUsages.size()) return TopoDS_Shape();
+
+    std::lock_guard<std::mutex> aLock(myMutex);
+    QElapsedTimer aTimer;
+    aTimer.start();
+    OSD::SetSignal(false);
+
+    const Handle(StepRepr_NextAssemblyUsageOccurrence) aUsage =
+        Handle(StepRepr_NextAssemblyUsageOccurrence)::DownCast(myUsages.at(theIndex));
+    const std::string aName = productName(aUsage->RelatedProductDefinition()).toStdString();
+    try {
+        OCC_CATCH_SIGNALS
+        // The NAUO transfer places the component in its parent, as a full transfer would
+        const Standard_Integer aNbShapes = myReader.NbShapes();
+        bool isTransferred = false;
+        {
+            const TransferLock aTransferLock(TransferLock::Step);
+            isTransferred = myReader.TransferEntity(aUsage);
+        }
+        if (!isTransferred || myReader.NbShapes() == aNbShapes) {
+            Message::SendWarning() << "Subassembly '" << aName << "' has no geometry";
+            return TopoDS_Shape();
+        }
+
+        const TopoDS_Shape aShape = myReader.Shape(myReader.NbShapes());
+        Bnd_Box aModelBox;
+        int aNbParts = 0;
+        for (const LazyAssemblyNode& aNode : myNodes) {
+            aModelBox.Add(aNode.box);
+            aNbParts += aNode.partCount;
+        }
+        MeshParameters aParams = theParams.resolvedFor(aModelBox);
+        if (aParams.mode == MeshParameters::TriangleBudget && aNbParts > 0) {
+            // The budget is for the whole assembly; each subassembly gets its share of the parts
+            aParams.triangleBudget = std::max(theParams.triangleBudget * myNodes.at(theIndex).partCount / aNbParts,
+                                              qint64(1));
+        }
+        Tessellation::mesh(aShape, aParams);
+        Message::SendInfo() << "Subassembly '" << aName << "' loaded in " << aTimer.elapsed() << " ms";
+        return aShape;
+
+    } catch (const Standard_Failure& e) {
+        Message::SendFail() << "Subassembly '" << aName << "' failed: " << e.GetMessageString();
+        return TopoDS_Shape();
+    }
+}
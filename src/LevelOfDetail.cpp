@@ -0,0 +1,190 @@
+// LevelOfDetail.cpp
+#include "LevelOfDetail.h"
+
+#include <BRepBndLib.hxx>
+#include <BRepBuilderAPI_Copy.hxx>
+#include <BRep_Builder.hxx>
+#include <Message.hxx>
+#include <OSD_Parallel.hxx>
+#include <Prs3d_Drawer.hxx>
+#include <Standard_ErrorHandler.hxx>
+#include <Standard_Failure.hxx>
+#include <StdPrs_ShadedShape.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopLoc_Location.hxx>
+#include <TopoDS_Compound.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QtMath>
+
+#include <cmath>
+#include <iterator>
+#include <limits>
+
+namespace
+{
+    //! Deflection of level k > 0 relative to the display mesh
+    const double THE_LOD_FACTORS[] = { 4.0, 16.0, 64.0 };
+    //! Projected diameter below which level k gives way to level k + 1
+    const double THE_LOD_PIXELS[] = { 240.0, 80.0, 24.0 };
+    //! Fraction a solid must pass a threshold by before its level changes
+    const double THE_LOD_HYSTERESIS = 0.25;
+
+    static_assert(std::size(THE_LOD_FACTORS) == std::size(THE_LOD_PIXELS), "one threshold per coarse level");
+}
+
+LodShape::LodShape(const LodPart& thePart)
+    : AIS_Shape(thePart.shape),
+      myLevels(thePart.levels)
+{
+    if (!thePart.box.IsVoid()) {
+        const gp_Pnt aMin = thePart.box.CornerMin();
+        const gp_Pnt aMax = thePart.box.CornerMax();
+        myCenter = gp_Pnt((aMin.XYZ() + aMax.XYZ()) * 0.5);
+        myRadius = aMin.Distance(aMax) * 0.5;
+    }
+}
+
+int LodShape::levelForSize(double thePixels) const
+{
+    int aLevel = myLevel;
+    while (aLevel + 1 < nbLevels() && thePixels < THE_LOD_PIXELS[aLevel] * (1.0 - THE_LOD_HYSTERESIS)) {
+        ++aLevel;
+    }
+    while (aLevel > 0 && thePixels > THE_LOD_PIXELS[aLevel - 1] * (1.0 + THE_LOD_HYSTERESIS)) {
+        --aLevel;
+    }
+    return aLevel;
+}
+
+double LodShape::projectedSize(const Handle(Graphic3d_Camera)& theCamera, int theHeight) const
+{
+    if (myRadius <= 0.0 || theHeight <= 0) return 0.0;
+
+    if (theCamera->IsOrthographic()) {
+        return 2.0 * myRadius / theCamera->ViewDimensions().Y() * theHeight;
+    }
+
+    // Inside the bounding sphere or behind the eye: as close as it gets
+    const double aDepth = gp_Vec(theCamera->Eye(), myCenter).Dot(gp_Vec(theCamera->Direction()));
+    if (aDepth <= myRadius) return std::numeric_limits<double>::max();
+    const double aViewHeight = 2.0 * aDepth * std::tan(qDegreesToRadians(theCamera->FOVy() * 0.5));
+    return 2.0 * myRadius / aViewHeight * theHeight;
+}
+
+Standard_Boolean LodShape::AcceptDisplayMode(const Standard_Integer theMode) const
+{
+    return AIS_Shape::AcceptDisplayMode(theMode)
+        || (theMode >= THE_FIRST_LOD_MODE && theMode < THE_FIRST_LOD_MODE + int(myLevels.size()));
+}
+
+void LodShape::Compute(const Handle(PrsMgr_PresentationManager)& thePrsMgr,
+                       const Handle(Prs3d_Presentation)& thePrs,
+                       const Standard_Integer theMode)
+{
+    const int aLevel = theMode - THE_FIRST_LOD_MODE;
+    if (aLevel < 0 || aLevel >= int(myLevels.size())) {
+        AIS_Shape::Compute(thePrsMgr, thePrs, theMode);
+        return;
+    }
+
+    // A few dozen pixels across: face boundaries would only smear the solid
+    Handle(Prs3d_Drawer) aDrawer = new Prs3d_Drawer();
+    aDrawer->SetLink(myDrawer);
+    aDrawer->SetFaceBoundaryDraw(Standard_False);
+    aDrawer->SetAutoTriangulation(Standard_False);
+    try {
+        OCC_CATCH_SIGNALS
+        StdPrs_ShadedShape::Add(thePrs, myLevels.at(aLevel), aDrawer);
+    } catch (const Standard_Failure& e) {
+        Message::SendWarning() << "LOD presentation failed: " << e.GetMessageString();
+    }
+}
+
+QVector<LodPart> LevelOfDetail::buildParts(const TopoDS_Shape& theShape, const MeshParameters& theParams)
+{
+    QVector<LodPart> aParts;
+    if (theShape.IsNull()) return aParts;
+
+    QElapsedTimer aTimer;
+    aTimer.start();
+
+    // One absolute deflection for the model, each copy meshed on a thread of its own
+    MeshParameters aParams = Tessellation::resolve(theShape, theParams);
+    aParams.threads = 1;
+
+    // Instances of a solid share its coarse copies
+    TopTools_IndexedMapOfShape aSolids;
+    for (TopExp_Explorer anExp(theShape, TopAbs_SOLID); anExp.More(); anExp.Next()) {
+        LodPart aPart;
+        aPart.shape = anExp.Current();
+        BRepBndLib::Add(aPart.shape, aPart.box, Standard_True);
+        aSolids.Add(aPart.shape.Located(TopLoc_Location()).Oriented(TopAbs_FORWARD));
+        aParts.append(aPart);
+    }
+
+    const int aNbLevels = int(std::size(THE_LOD_FACTORS));
+    std::vector<TopoDS_Shape> aCopies(size_t(aSolids.Extent()) * aNbLevels);
+    OSD_Parallel::For(0, int(aCopies.size()), [&](int theIndex) {
+        const TopoDS_Shape& aSolid = aSolids(theIndex / aNbLevels + 1);
+        try {
+            OCC_CATCH_SIGNALS
+            // Own TShapes per copy, so the copies mesh independently of each other and of the model
+            const TopoDS_Shape aCopy = BRepBuilderAPI_Copy(aSolid, Standard_False, Standard_False).Shape();
+            if (Tessellation::mesh(aCopy, aParams.coarsened(THE_LOD_FACTORS[theIndex % aNbLevels]))) {
+                aCopies[theIndex] = aCopy;
+            }
+        } catch (const Standard_Failure&) {
+            // The solid is drawn at full detail only, see below
+        }
+    });
+
+    int aNbFailed = 0;
+    for (LodPart& aPart : aParts) {
+        const int aFirst = (aSolids.FindIndex(aPart.shape.Located(TopLoc_Location()).Oriented(TopAbs_FORWARD)) - 1) * aNbLevels;
+        std::vector<TopoDS_Shape> aLevels;
+        for (int aLevel = 0; aLevel < aNbLevels && !aCopies[aFirst + aLevel].IsNull(); ++aLevel) {
+            aLevels.push_back(aCopies[aFirst + aLevel].Located(aPart.shape.Location())
+                                                      .Oriented(aPart.shape.Orientation()));
+        }
+        if (int(aLevels.size()) < aNbLevels) ++aNbFailed;
+        aPart.levels = aLevels;
+    }
+
+    // Shells, faces, wires and vertices outside solids stay one part at full detail
+    BRep_Builder aBuilder;
+    TopoDS_Compound aRest;
+    aBuilder.MakeCompound(aRest);
+    bool hasRest = false;
+    const auto addRest = [&](TopAbs_ShapeEnum theType, TopAbs_ShapeEnum theAvoid) {
+        for (TopExp_Explorer anExp(theShape, theType, theAvoid); anExp.More(); anExp.Next()) {
+            aBuilder.Add(aRest, anExp.Current());
+            hasRest = true;
+        }
+    };
+    addRest(TopAbs_SHELL, TopAbs_SOLID);
+    addRest(TopAbs_FACE, TopAbs_SHELL);
+    addRest(TopAbs_EDGE, TopAbs_FACE);
+    addRest(TopAbs_VERTEX, TopAbs_EDGE);
+    if (hasRest) {
+        LodPart aPart;
+        aPart.shape = aRest;
+        BRepBndLib::Add(aRest, aPart.box, Standard_True);
+        aParts.append(aPart);
+    }
+
+    Message::SendInfo() << "LOD: " << aNbLevels << " coarse levels for " << aSolids.Extent() << " unique of "
+                        << (aParts.size() - (hasRest ? 1 : 0)) << " solids in " << aTimer.elapsed() << " ms"
+                        << (aNbFailed > 0 ? QString(", %1 kept at full detail").arg(aNbFailed).toStdString()
+                                          : std::string());
+    return aParts;
+}
+
+QString LevelOfDetail::summary(const QVector<int>& theLevelCounts)
+{
+    QStringList aCounts;
+    for (int aCount : theLevelCounts) aCounts << QString::number(aCount);
+    return QString("solids per level %1").arg(aCounts.join(" / "));
+}
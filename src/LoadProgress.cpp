@@ -0,0 +1,39 @@
+// LoadProgress.cpp
+#include "LoadProgress.h"
+#include "Core.h"
+
+#include <Message_ProgressScope.hxx>
+#include <QMetaObject>
+
+LoadProgressIndicator::LoadProgressIndicator(OcctQWidgetViewer* theViewer)
+    : myViewer(theViewer), myIsCancelled(false), myLastPercent(-1)
+{
+}
+
+void LoadProgressIndicator::Reset()
+{
+    Message_ProgressIndicator::Reset();
+    myLastPercent = -1;
+}
+
+void LoadProgressIndicator::Show(const Message_ProgressScope& theScope,
+                                 const Standard_Boolean isForce)
+{
+    // Only forward whole-percent changes, the translators call Show() very often
+    const int aPercent = qBound(0, int(GetPosition() * 100.0), 100);
+    if (!isForce && myLastPercent.exchange(aPercent) == aPercent) return;
+
+    // Report the innermost named step (unnamed scopes are used for sub-ranges)
+    QString aStep;
+    for (const Message_ProgressScope* aScope = &theScope; aScope != nullptr; aScope = aScope->Parent()) {
+        if (aScope->Name() != nullptr) {
+            aStep = QString::fromUtf8(aScope->Name());
+            break;
+        }
+    }
+
+    OcctQWidgetViewer* aViewer = myViewer;
+    QMetaObject::invokeMethod(aViewer, [aViewer, aPercent, aStep]() {
+        emit aViewer->loadProgress(aPercent, aStep);
+    }, Qt::QueuedConnection);
+}
@@ -10,6 +10,7 @@
 #include <TopExp.hxx>
 #include <TopExp_Explorer.hxx>
 #include <BRepGProp.hxx>
+#include <BRepBndLib.hxx>
 #include <GProp_GProps.hxx>
 #include <BRepAdaptor_Curve.hxx>
 #include <GCPnts_QuasiUniformDeflection.hxx>
@@ -22,6 +23,9 @@
 #include <Standard_Failure.hxx>
 #include <QtMath>
 #include <QFileInfo>
+#include <QFile>
+#include <QTextStream>
+#include <QDate>
 
 MeasurementManager::MeasurementManager(OcctQWidgetViewer* viewer)
     : m_viewer(viewer)
@@ -82,22 +86,7 @@ void MeasurementManager::calculateMeasurements()
     // =========================================================
 
     // A1. File Metadata
-    if (!m_viewer->myCurrentFilePath.isEmpty()) {
-        QFileInfo fi(m_viewer->myCurrentFilePath);
-        props.filename = fi.fileName();
-        props.location = fi.absolutePath();
-
-        double sizeBytes = fi.size();
-        if (sizeBytes > 1024 * 1024) {
-            props.size = QString::number(sizeBytes / (1024.0 * 1024.0), 'f', 2) + " MB";
-        } else {
-            props.size = QString::number(sizeBytes / 1024.0, 'f', 2) + " KB";
-        }
-    } else {
-        props.filename = "-";
-        props.size = "-";
-        props.location = "-";
-    }
+    fillFileProperties(m_viewer->myCurrentFilePath, props);
 
     // Init defaults
     props.type = "-";
@@ -105,30 +94,19 @@ void MeasurementManager::calculateMeasurements()
     props.area = 0.0; props.volume = 0.0; props.length = 0.0;
     props.radius = 0.0; props.diameter = 0.0; props.angle = 0.0;
 
-    // A2. Calculate Model Origin (Center of Mass)
-    if (!m_viewer->myLoadedShape.IsNull()) {
-        GProp_GProps globalProps;
-
-        // Priority: Solid -> Surface -> Linear (Wireframe)
-        BRepGProp::VolumeProperties(m_viewer->myLoadedShape, globalProps);
-        if (globalProps.Mass() < 1e-6) {
-            BRepGProp::SurfaceProperties(m_viewer->myLoadedShape, globalProps);
-        }
-        if (globalProps.Mass() < 1e-6) {
-            BRepGProp::LinearProperties(m_viewer->myLoadedShape, globalProps);
-        }
-
-        // If geometry has mass/length, extract Center
-        if (globalProps.Mass() > 1e-9) {
-            gp_Pnt center = globalProps.CentreOfMass();
-            props.originX = center.X();
-            props.originY = center.Y();
-            props.originZ = center.Z();
-
-            // --- VISUAL UPDATE: Show XYZ Trihedron at Origin ---
-            m_viewer->displayModelOrigin(center);
-            // ---------------------------------------------------
-        }
+    // A2. Model Origin (Center of Mass), computed once per model
+    if (!m_viewer->myLoadedShape.IsNull() && !m_massShape.IsSame(m_viewer->myLoadedShape)) {
+        setModelMassProperties(m_viewer->myLoadedShape, computeMassProperties(m_viewer->myLoadedShape));
+    }
+    if (!m_viewer->myLoadedShape.IsNull() && m_mass.hasOrigin) {
+        const gp_Pnt& center = m_mass.origin;
+        props.originX = center.X();
+        props.originY = center.Y();
+        props.originZ = center.Z();
+
+        // --- VISUAL UPDATE: Show XYZ Trihedron at Origin ---
+        m_viewer->displayModelOrigin(center);
+        // ---------------------------------------------------
     }
 
     // =========================================================
@@ -465,6 +443,151 @@ void MeasurementManager::calculateMeasurements()
     m_data.perimeter = 0.0;
 }
 
+// =========================================================
+// Viewer-independent helpers
+// =========================================================
+
+void MeasurementManager::fillFileProperties(const QString& theFilePath, ModelProperties& theProps)
+{
+    if (theFilePath.isEmpty()) {
+        theProps.filename = "-";
+        theProps.size = "-";
+        theProps.location = "-";
+        return;
+    }
+
+    QFileInfo fi(theFilePath);
+    theProps.filename = fi.fileName();
+    theProps.location = fi.absolutePath();
+
+    double sizeBytes = fi.size();
+    if (sizeBytes > 1024 * 1024) {
+        theProps.size = QString::number(sizeBytes / (1024.0 * 1024.0), 'f', 2) + " MB";
+    } else {
+        theProps.size = QString::number(sizeBytes / 1024.0, 'f', 2) + " KB";
+    }
+}
+
+ModelMassProperties MeasurementManager::computeMassProperties(const TopoDS_Shape& theShape, bool theWithArea)
+{
+    ModelMassProperties aResult;
+    if (theShape.IsNull()) return aResult;
+
+    // Priority for the origin: Solid -> Surface -> Linear (Wireframe)
+    GProp_GProps aVolumeProps;
+    BRepGProp::VolumeProperties(theShape, aVolumeProps);
+    aResult.volume = aVolumeProps.Mass();
+
+    // A second full integration; solids only need it when the area is asked for
+    GProp_GProps anAreaProps;
+    if (theWithArea || aResult.volume < 1e-6) {
+        BRepGProp::SurfaceProperties(theShape, anAreaProps);
+        aResult.area = anAreaProps.Mass();
+    }
+
+    if (aResult.volume >= 1e-6) {
+        aResult.origin = aVolumeProps.CentreOfMass();
+        aResult.hasOrigin = true;
+    } else if (aResult.area >= 1e-6) {
+        aResult.origin = anAreaProps.CentreOfMass();
+        aResult.hasOrigin = true;
+    } else {
+        GProp_GProps aLinearProps;
+        BRepGProp::LinearProperties(theShape, aLinearProps);
+        aResult.length = aLinearProps.Mass();
+        if (aResult.length > 1e-9) {
+            aResult.origin = aLinearProps.CentreOfMass();
+            aResult.hasOrigin = true;
+        }
+    }
+
+    BRepBndLib::Add(theShape, aResult.box, Standard_True);
+    return aResult;
+}
+
+void MeasurementManager::setModelMassProperties(const TopoDS_Shape& theShape, const ModelMassProperties& theProps)
+{
+    m_massShape = theShape;
+    m_mass = theProps;
+}
+
+void MeasurementManager::computeModelProperties(const TopoDS_Shape& theShape, const QString& theFilePath,
+                                                ModelProperties& theProps)
+{
+    fillFileProperties(theFilePath, theProps);
+    theProps.type = "-";
+    theProps.originX = 0.0; theProps.originY = 0.0; theProps.originZ = 0.0;
+    theProps.area = 0.0; theProps.volume = 0.0; theProps.length = 0.0;
+    theProps.radius = 0.0; theProps.diameter = 0.0; theProps.angle = 0.0;
+    if (theShape.IsNull()) return;
+
+    const ModelMassProperties aMass = computeMassProperties(theShape, true);
+    theProps.area = aMass.area;
+    theProps.volume = aMass.volume;
+    theProps.length = aMass.length;
+    if (!aMass.hasOrigin) return;
+
+    theProps.type = aMass.volume >= 1e-6 ? "SOLID" : (aMass.area >= 1e-6 ? "SURFACE" : "WIRE");
+    theProps.originX = aMass.origin.X();
+    theProps.originY = aMass.origin.Y();
+    theProps.originZ = aMass.origin.Z();
+}
+
+bool MeasurementManager::writeCSV(const QString& theFileName, const ModelProperties& theProps,
+                                  const QString& thePointData)
+{
+    QFile file(theFileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        return false;
+    }
+
+    QTextStream out(&file);
+
+    // Helper Lambda: Sanitize fields for CSV
+    // Wraps text in quotes if it contains commas, newlines, or double quotes
+    auto csvEscape = [](const QString& val) -> QString {
+        QString temp = val;
+        // If data contains special characters, escape quotes and wrap in quotes
+        if (temp.contains(',') || temp.contains('"') || temp.contains('\n')) {
+            temp.replace("\"", "\"\""); // Escape existing quotes (e.g. 5" -> 5"")
+            return "\"" + temp + "\"";
+        }
+        return temp;
+    };
+
+    // Write Header/Metadata Section
+    // Using a key-value pair format for the top section
+    out << "Report Property,Value\n";
+    out << "Date," << csvEscape(QDate::currentDate().toString(Qt::ISODate)) << "\n";
+    out << "Filename," << csvEscape(theProps.filename) << "\n";
+    out << "Origin X," << QString::number(theProps.originX, 'f', 6) << "\n";
+    out << "Origin Y," << QString::number(theProps.originY, 'f', 6) << "\n";
+    out << "Origin Z," << QString::number(theProps.originZ, 'f', 6) << "\n";
+    out << "\n"; // Blank line separator
+
+    // Write Data Table Headers
+    out << "ID,X,Y,Z,Distance,Curve Data\n";
+
+    // Write Data Rows
+    QStringList lines = thePointData.split('\n', Qt::SkipEmptyParts);
+    for (const QString& line : lines) {
+        QStringList cols = line.split('|');
+        if (cols.size() < 6) continue;
+
+        // Build the CSV row
+        QStringList outputRow;
+        for (const QString& col : cols) {
+            outputRow << csvEscape(col);
+        }
+
+        // Join with comma
+        out << outputRow.join(",") << "\n";
+    }
+
+    file.close();
+    return file.error() == QFileDevice::NoError;
+}
+
 QString MeasurementManager::getMeasurementString() const
 {
     if (m_data.type.isEmpty()) {
@@ -0,0 +1,636 @@
+// MeshImport.cpp
+#include "MeshImport.h"
+
+#include <BRep_Builder.hxx>
+#include <Message.hxx>
+#include <Message_ProgressScope.hxx>
+#include <RWStl.hxx>
+#include <Standard_Failure.hxx>
+#include <TCollection_AsciiString.hxx>
+#include <TopoDS_Face.hxx>
+
+#include <QElapsedTimer>
+#include <QFile>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace
+{
+    const quint32 THE_NO_VERTEX = std::numeric_limits<quint32>::max();
+    const int THE_BREAK_CHECK = 1 << 16;    // records between cancellation checks
+
+    //! Triangle soup as read from the file, before welding
+    struct RawMesh {
+        std::vector<float> points;          // xyz
+        std::vector<quint32> triangles;     // indices into points
+    };
+
+    inline bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+    inline const char* skipBlank(const char* p, const char* theEnd)
+    {
+        while (p < theEnd && isBlank(*p)) ++p;
+        return p;
+    }
+
+    inline const char* nextLine(const char* p, const char* theEnd)
+    {
+        const void* aNewLine = std::memchr(p, '\n', size_t(theEnd - p));
+        return aNewLine != nullptr ? static_cast<const char*>(aNewLine) + 1 : theEnd;
+    }
+
+    inline bool startsWith(const char* p, const char* theEnd, const char* theWord)
+    {
+        const size_t aLen = std::strlen(theWord);
+        return size_t(theEnd - p) >= aLen && std::memcmp(p, theWord, aLen) == 0;
+    }
+
+    //! Decimal float without locale or allocation; nullptr if there is no number at p.
+    //! Mantissas beyond 19 digits are truncated, well below float resolution.
+    const char* parseFloat(const char* p, const char* theEnd, double& theValue)
+    {
+        static const double THE_POW10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+        p = skipBlank(p, theEnd);
+        bool isNegative = false;
+        if (p < theEnd && (*p == '-' || *p == '+')) isNegative = *p++ == '-';
+
+        quint64 aMantissa = 0;
+        int aDigits = 0, anExponent = 0;
+        bool hasDigits = false;
+        for (; p < theEnd && *p >= '0' && *p <= '9'; ++p, hasDigits = true) {
+            if (aDigits < 19) { aMantissa = aMantissa * 10 + quint64(*p - '0'); if (aMantissa) ++aDigits; }
+            else ++anExponent;
+        }
+        if (p < theEnd && *p == '.') {
+            for (++p; p < theEnd && *p >= '0' && *p <= '9'; ++p, hasDigits = true) {
+                if (aDigits < 19) { aMantissa = aMantissa * 10 + quint64(*p - '0'); if (aMantissa) ++aDigits; --anExponent; }
+            }
+        }
+        if (!hasDigits) return nullptr;
+
+        if (p < theEnd && (*p == 'e' || *p == 'E')) {
+            const char* anExpStart = p++;
+            bool isExpNegative = false;
+            if (p < theEnd && (*p == '-' || *p == '+')) isExpNegative = *p++ == '-';
+            if (p < theEnd && *p >= '0' && *p <= '9') {
+                int anExpValue = 0;
+                for (; p < theEnd && *p >= '0' && *p <= '9'; ++p) anExpValue = std::min(anExpValue * 10 + (*p - '0'), 9999);
+                anExponent += isExpNegative ? -anExpValue : anExpValue;
+            } else {
+                p = anExpStart;
+            }
+        }
+
+        double aValue = double(aMantissa);
+        if (aValue != 0.0 && anExponent != 0) {
+            const int anAbsExp = std::abs(anExponent);
+            const double aScale = anAbsExp <= 22 ? THE_POW10[anAbsExp] : std::pow(10.0, anAbsExp);
+            aValue = anExponent < 0 ? aValue / aScale : aValue * aScale;
+        }
+        theValue = isNegative ? -aValue : aValue;
+        return p;
+    }
+
+    const char* parseInt(const char* p, const char* theEnd, qint64& theValue)
+    {
+        p = skipBlank(p, theEnd);
+        bool isNegative = false;
+        if (p < theEnd && (*p == '-' || *p == '+')) isNegative = *p++ == '-';
+        if (p >= theEnd || *p < '0' || *p > '9') return nullptr;
+        qint64 aValue = 0;
+        for (; p < theEnd && *p >= '0' && *p <= '9'; ++p) aValue = aValue * 10 + (*p - '0');
+        theValue = isNegative ? -aValue : aValue;
+        return p;
+    }
+
+    // =========================================================
+    // STL
+    // =========================================================
+
+    bool readStl(const char* theData, qint64 theSize, RawMesh& theMesh, Message_ProgressScope& theScope,
+                 QString& theError)
+    {
+        // Binary when the size matches the facet count; some exporters start binary headers with "solid"
+        if (theSize >= 84) {
+            quint32 aNbFacets = 0;
+            std::memcpy(&aNbFacets, theData + 80, 4);
+            if (84 + qint64(aNbFacets) * 50 == theSize) {
+                theMesh.points.resize(size_t(aNbFacets) * 9);
+                theMesh.triangles.resize(size_t(aNbFacets) * 3);
+                const char* p = theData + 84;
+                for (quint32 aFacet = 0; aFacet < aNbFacets; ++aFacet, p += 50) {
+                    std::memcpy(&theMesh.points[size_t(aFacet) * 9], p + 12, 36);
+                    for (int aCorner = 0; aCorner < 3; ++aCorner) {
+                        theMesh.triangles[size_t(aFacet) * 3 + aCorner] = aFacet * 3 + quint32(aCorner);
+                    }
+                    if ((aFacet % THE_BREAK_CHECK) == 0 && !theScope.More()) return false;
+                }
+                return true;
+            }
+        }
+
+        const char* anEnd = theData + theSize;
+        if (!startsWith(skipBlank(theData, anEnd), anEnd, "solid")) {
+            theError = "Not an STL file: facet count does not match the size and no 'solid' header";
+            return false;
+        }
+
+        int aLine = 0;
+        for (const char* p = theData; p < anEnd; p = nextLine(p, anEnd), ++aLine) {
+            const char* aToken = p;
+            while (aToken < anEnd && (isBlank(*aToken) || *aToken == '\n')) ++aToken;
+            if (!startsWith(aToken, anEnd, "vertex")) continue;
+
+            const char* aNum = aToken + 6;
+            for (int aComp = 0; aComp < 3; ++aComp) {
+                double aValue = 0.0;
+                aNum = parseFloat(aNum, anEnd, aValue);
+                if (aNum == nullptr) {
+                    theError = QString("Malformed STL vertex at line %1").arg(aLine + 1);
+                    return false;
+                }
+                theMesh.points.push_back(float(aValue));
+            }
+            if ((aLine % THE_BREAK_CHECK) == 0 && !theScope.More()) return false;
+        }
+
+        const quint32 aNbCorners = quint32(theMesh.points.size() / 3) / 3 * 3;
+        theMesh.triangles.resize(aNbCorners);
+        for (quint32 aCorner = 0; aCorner < aNbCorners; ++aCorner) theMesh.triangles[aCorner] = aCorner;
+        return true;
+    }
+
+    // =========================================================
+    // OBJ
+    // =========================================================
+
+    bool readObj(const char* theData, qint64 theSize, RawMesh& theMesh, Message_ProgressScope& theScope,
+                 QString& theError)
+    {
+        const char* anEnd = theData + theSize;
+        std::vector<qint64> aPolygon;
+        int aLine = 0;
+        for (const char* p = theData; p < anEnd; p = nextLine(p, anEnd), ++aLine) {
+            p = skipBlank(p, anEnd);
+            if (p + 1 >= anEnd) break;
+
+            if (p[0] == 'v' && isBlank(p[1])) {
+                const char* aNum = p + 1;
+                for (int aComp = 0; aComp < 3; ++aComp) {
+                    double aValue = 0.0;
+                    aNum = parseFloat(aNum, anEnd, aValue);
+                    if (aNum == nullptr) {
+                        theError = QString("Malformed OBJ vertex at line %1").arg(aLine + 1);
+                        return false;
+                    }
+                    theMesh.points.push_back(float(aValue));
+                }
+            } else if (p[0] == 'f' && isBlank(p[1])) {
+                // "f v", "f v/vt", "f v//vn", "f v/vt/vn"; negative indices count from the end
+                aPolygon.clear();
+                const qint64 aNbPoints = qint64(theMesh.points.size() / 3);
+                const char* aTok = p + 1;
+                for (;;) {
+                    qint64 anIndex = 0;
+                    const char* aNext = parseInt(aTok, anEnd, anIndex);
+                    if (aNext == nullptr) break;
+                    anIndex = anIndex < 0 ? aNbPoints + anIndex : anIndex - 1;
+                    if (anIndex < 0 || anIndex >= aNbPoints) {
+                        theError = QString("OBJ face index out of range at line %1").arg(aLine + 1);
+                        return false;
+                    }
+                    aPolygon.push_back(anIndex);
+                    for (aTok = aNext; aTok < anEnd && !isBlank(*aTok) && *aTok != '\n'; ++aTok) {}
+                }
+                // Fan triangulation; OBJ polygons from scanners are planar and convex
+                for (size_t aCorner = 2; aCorner < aPolygon.size(); ++aCorner) {
+                    theMesh.triangles.push_back(quint32(aPolygon[0]));
+                    theMesh.triangles.push_back(quint32(aPolygon[aCorner - 1]));
+                    theMesh.triangles.push_back(quint32(aPolygon[aCorner]));
+                }
+            }
+            if ((aLine % THE_BREAK_CHECK) == 0 && !theScope.More()) return false;
+        }
+        return true;
+    }
+
+    // =========================================================
+    // PLY
+    // =========================================================
+
+    struct PlyProperty {
+        QByteArray name;
+        int size = 0;           // bytes of the value (list: of each item)
+        bool isFloat = false;
+        bool isSigned = false;
+        int countSize = 0;      // list only: bytes of the item count
+    };
+
+    struct PlyElement {
+        QByteArray name;
+        qint64 count = 0;
+        std::vector<PlyProperty> properties;
+    };
+
+    bool plyType(const QByteArray& theName, int& theSize, bool& theIsFloat, bool& theIsSigned)
+    {
+        static const struct { const char* Name; int Size; bool IsFloat; bool IsSigned; } THE_TYPES[] = {
+            { "char", 1, false, true },   { "int8", 1, false, true },    { "uchar", 1, false, false },
+            { "uint8", 1, false, false }, { "short", 2, false, true },   { "int16", 2, false, true },
+            { "ushort", 2, false, false },{ "uint16", 2, false, false }, { "int", 4, false, true },
+            { "int32", 4, false, true },  { "uint", 4, false, false },   { "uint32", 4, false, false },
+            { "float", 4, true, true },   { "float32", 4, true, true },  { "double", 8, true, true },
+            { "float64", 8, true, true }
+        };
+        for (const auto& aType : THE_TYPES) {
+            if (theName == aType.Name) {
+                theSize = aType.Size;
+                theIsFloat = aType.IsFloat;
+                theIsSigned = aType.IsSigned;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //! Binary PLY scalar of any type as double
+    class PlyBinaryReader
+    {
+    public:
+        PlyBinaryReader(const char* theData, const char* theEnd, bool theIsBigEndian)
+            : myPos(theData), myEnd(theEnd), mySwap(theIsBigEndian != (Q_BYTE_ORDER == Q_BIG_ENDIAN)) {}
+
+        bool read(int theSize, bool theIsFloat, bool theIsSigned, double& theValue)
+        {
+            if (myEnd - myPos < theSize) return false;
+            char aBytes[8];
+            std::memcpy(aBytes, myPos, size_t(theSize));
+            if (mySwap) std::reverse(aBytes, aBytes + theSize);
+            myPos += theSize;
+
+            switch (theSize) {
+            case 1: theValue = theIsSigned ? double(qint8(aBytes[0])) : double(quint8(aBytes[0])); break;
+            case 2: { qint16 s; quint16 u; std::memcpy(&s, aBytes, 2); std::memcpy(&u, aBytes, 2);
+                      theValue = theIsSigned ? double(s) : double(u); break; }
+            case 4: if (theIsFloat) { float f; std::memcpy(&f, aBytes, 4); theValue = f; }
+                    else { qint32 s; quint32 u; std::memcpy(&s, aBytes, 4); std::memcpy(&u, aBytes, 4);
+                           theValue = theIsSigned ? double(s) : double(u); }
+                    break;
+            default: { double d; std::memcpy(&d, aBytes, 8); theValue = d; break; }
+            }
+            return true;
+        }
+
+    private:
+        const char* myPos;
+        const char* myEnd;
+        bool mySwap;
+    };
+
+    bool readPly(const char* theData, qint64 theSize, RawMesh& theMesh, Message_ProgressScope& theScope,
+                 QString& theError)
+    {
+        const char* anEnd = theData + theSize;
+        if (!startsWith(theData, anEnd, "ply")) {
+            theError = "Not a PLY file";
+            return false;
+        }
+
+        // Header
+        enum { Ascii, BinaryLE, BinaryBE } aFormat = Ascii;
+        std::vector<PlyElement> anElements;
+        const char* p = nextLine(theData, anEnd);
+        for (;; p = nextLine(p, anEnd)) {
+            if (p >= anEnd) {
+                theError = "PLY header has no end_header";
+                return false;
+            }
+            const QList<QByteArray> aTokens = QByteArray(p, int(nextLine(p, anEnd) - p)).simplified().split(' ');
+            if (aTokens.isEmpty()) continue;
+            const QByteArray& aKey = aTokens.first();
+            if (aKey == "end_header") {
+                p = nextLine(p, anEnd);
+                break;
+            } else if (aKey == "format" && aTokens.size() >= 2) {
+                if (aTokens[1] == "binary_little_endian") aFormat = BinaryLE;
+                else if (aTokens[1] == "binary_big_endian") aFormat = BinaryBE;
+            } else if (aKey == "element" && aTokens.size() >= 3) {
+                PlyElement anElement;
+                anElement.name = aTokens[1];
+                anElement.count = aTokens[2].toLongLong();
+                anElements.push_back(anElement);
+            } else if (aKey == "property" && !anElements.empty()) {
+                PlyProperty aProp;
+                bool isFloat = false, isSigned = false;
+                if (aTokens.size() >= 5 && aTokens[1] == "list") {
+                    bool isCountFloat = false, isCountSigned = false;
+                    if (!plyType(aTokens[2], aProp.countSize, isCountFloat, isCountSigned)
+                     || !plyType(aTokens[3], aProp.size, isFloat, isSigned)) {
+                        theError = "Unknown PLY property type: " + QString::fromLatin1(aTokens[3]);
+                        return false;
+                    }
+                    aProp.name = aTokens[4];
+                } else if (aTokens.size() >= 3) {
+                    if (!plyType(aTokens[1], aProp.size, isFloat, isSigned)) {
+                        theError = "Unknown PLY property type: " + QString::fromLatin1(aTokens[1]);
+                        return false;
+                    }
+                    aProp.name = aTokens[2];
+                }
+                aProp.isFloat = isFloat;
+                aProp.isSigned = isSigned;
+                anElements.back().properties.push_back(aProp);
+            }
+        }
+
+        // Body: element records in header order; only vertex xyz and face index lists are kept
+        PlyBinaryReader aBinary(p, anEnd, aFormat == BinaryBE);
+        auto aReadValue = [&](int theSize, bool theIsFloat, bool theIsSigned, double& theValue) -> bool {
+            if (aFormat != Ascii) return aBinary.read(theSize, theIsFloat, theIsSigned, theValue);
+            while (p < anEnd && (isBlank(*p) || *p == '\n')) ++p;
+            p = parseFloat(p, anEnd, theValue);
+            return p != nullptr;
+        };
+
+        std::vector<double> aRecord;
+        std::vector<qint64> aPolygon;
+        qint64 aVertexBase = 0;
+        for (const PlyElement& anElement : anElements) {
+            int aXYZ[3] = { -1, -1, -1 };
+            int aFaceList = -1;
+            for (int aPropIter = 0; aPropIter < int(anElement.properties.size()); ++aPropIter) {
+                const PlyProperty& aProp = anElement.properties[aPropIter];
+                if (aProp.countSize == 0 && aProp.name == "x") aXYZ[0] = aPropIter;
+                if (aProp.countSize == 0 && aProp.name == "y") aXYZ[1] = aPropIter;
+                if (aProp.countSize == 0 && aProp.name == "z") aXYZ[2] = aPropIter;
+                if (aProp.countSize > 0 && (aProp.name == "vertex_indices" || aProp.name == "vertex_index")) {
+                    aFaceList = aPropIter;
+                }
+            }
+            const bool isVertex = anElement.name == "vertex" && aXYZ[0] >= 0 && aXYZ[1] >= 0 && aXYZ[2] >= 0;
+            const bool isFace = anElement.name == "face" && aFaceList >= 0;
+            if (isVertex) theMesh.points.reserve(theMesh.points.size() + size_t(anElement.count) * 3);
+
+            aRecord.assign(anElement.properties.size(), 0.0);
+            for (qint64 aRow = 0; aRow < anElement.count; ++aRow) {
+                for (int aPropIter = 0; aPropIter < int(anElement.properties.size()); ++aPropIter) {
+                    const PlyProperty& aProp = anElement.properties[aPropIter];
+                    if (aProp.countSize == 0) {
+                        if (!aReadValue(aProp.size, aProp.isFloat, aProp.isSigned, aRecord[aPropIter])) {
+                            theError = "Truncated PLY element " + QString::fromLatin1(anElement.name);
+                            return false;
+                        }
+                        continue;
+                    }
+
+                    double aCount = 0.0;
+                    if (!aReadValue(aProp.countSize, false, false, aCount)) {
+                        theError = "Truncated PLY element " + QString::fromLatin1(anElement.name);
+                        return false;
+                    }
+                    aPolygon.clear();
+                    for (qint64 anItem = 0; anItem < qint64(aCount); ++anItem) {
+                        double anIndex = 0.0;
+                        if (!aReadValue(aProp.size, aProp.isFloat, aProp.isSigned, anIndex)) {
+                            theError = "Truncated PLY element " + QString::fromLatin1(anElement.name);
+                            return false;
+                        }
+                        aPolygon.push_back(qint64(anIndex));
+                    }
+                    if (!isFace || aPropIter != aFaceList) continue;
+
+                    for (qint64 anIndex : aPolygon) {
+                        if (anIndex < 0 || anIndex >= aVertexBase) {
+                            theError = "PLY face index out of range";
+                            return false;
+                        }
+                    }
+                    for (size_t aCorner = 2; aCorner < aPolygon.size(); ++aCorner) {
+                        theMesh.triangles.push_back(quint32(aPolygon[0]));
+                        theMesh.triangles.push_back(quint32(aPolygon[aCorner - 1]));
+                        theMesh.triangles.push_back(quint32(aPolygon[aCorner]));
+                    }
+                }
+                if (isVertex) {
+                    for (int aComp = 0; aComp < 3; ++aComp) theMesh.points.push_back(float(aRecord[aXYZ[aComp]]));
+                }
+                if ((aRow % THE_BREAK_CHECK) == 0 && !theScope.More()) return false;
+            }
+            if (isVertex) aVertexBase = qint64(theMesh.points.size() / 3);
+        }
+        return true;
+    }
+
+    // =========================================================
+    // Welding
+    // =========================================================
+
+    //! Merge points that fall into the same cell of a grid whose step is the weld tolerance.
+    //! Open addressing over the unique points; duplicates from STL facets are bit-identical
+    //! and always land in one cell.
+    Handle(Poly_Triangulation) weld(const RawMesh& theMesh, MeshImportStats& theStats)
+    {
+        const size_t aNbPoints = theMesh.points.size() / 3;
+        float aMin[3] = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max(),
+                          std::numeric_limits<float>::max() };
+        float aMax[3] = { -aMin[0], -aMin[1], -aMin[2] };
+        for (size_t aPnt = 0; aPnt < aNbPoints; ++aPnt) {
+            for (int aComp = 0; aComp < 3; ++aComp) {
+                aMin[aComp] = std::min(aMin[aComp], theMesh.points[aPnt * 3 + aComp]);
+                aMax[aComp] = std::max(aMax[aComp], theMesh.points[aPnt * 3 + aComp]);
+            }
+        }
+        double aDiag = 0.0;
+        for (int aComp = 0; aComp < 3; ++aComp) aDiag += double(aMax[aComp] - aMin[aComp]) * (aMax[aComp] - aMin[aComp]);
+        // About the float resolution of the model extent
+        const double aCellSize = std::max(std::sqrt(aDiag) * 1.0e-7, std::numeric_limits<double>::min());
+
+        size_t aTableSize = 16;
+        while (aTableSize < aNbPoints * 2) aTableSize <<= 1;
+        const size_t aMask = aTableSize - 1;
+        std::vector<quint32> aTable(aTableSize, THE_NO_VERTEX);
+        std::vector<qint64> aCells;          // cell of each unique point
+        std::vector<quint32> aUnique;        // first raw point of each unique point
+        std::vector<quint32> aRemap(aNbPoints);
+        aCells.reserve(aNbPoints);
+        aUnique.reserve(aNbPoints);
+
+        for (size_t aPnt = 0; aPnt < aNbPoints; ++aPnt) {
+            qint64 aCell[3];
+            for (int aComp = 0; aComp < 3; ++aComp) {
+                aCell[aComp] = qint64(std::floor((theMesh.points[aPnt * 3 + aComp] - aMin[aComp]) / aCellSize));
+            }
+            size_t aSlot = (size_t(aCell[0]) * 73856093u ^ size_t(aCell[1]) * 19349663u ^ size_t(aCell[2]) * 83492791u) & aMask;
+            for (;; aSlot = (aSlot + 1) & aMask) {
+                const quint32 aCandidate = aTable[aSlot];
+                if (aCandidate == THE_NO_VERTEX) {
+                    aTable[aSlot] = quint32(aUnique.size());
+                    aRemap[aPnt] = quint32(aUnique.size());
+                    aUnique.push_back(quint32(aPnt));
+                    aCells.insert(aCells.end(), aCell, aCell + 3);
+                    break;
+                }
+                const qint64* aCandCell = &aCells[size_t(aCandidate) * 3];
+                if (aCandCell[0] == aCell[0] && aCandCell[1] == aCell[1] && aCandCell[2] == aCell[2]) {
+                    aRemap[aPnt] = aCandidate;
+                    break;
+                }
+            }
+        }
+
+        // Remap, dropping triangles collapsed by the weld
+        std::vector<quint32> aTriangles;
+        aTriangles.reserve(theMesh.triangles.size());
+        for (size_t aTri = 0; aTri + 2 < theMesh.triangles.size(); aTri += 3) {
+            const quint32 aN1 = aRemap[theMesh.triangles[aTri]];
+            const quint32 aN2 = aRemap[theMesh.triangles[aTri + 1]];
+            const quint32 aN3 = aRemap[theMesh.triangles[aTri + 2]];
+            if (aN1 == aN2 || aN2 == aN3 || aN1 == aN3) continue;
+            aTriangles.push_back(aN1);
+            aTriangles.push_back(aN2);
+            aTriangles.push_back(aN3);
+        }
+
+        theStats.inputVertices = qint64(aNbPoints);
+        theStats.vertices = qint64(aUnique.size());
+        theStats.triangles = qint64(aTriangles.size() / 3);
+        if (aTriangles.empty()) return Handle(Poly_Triangulation)();
+
+        // Single precision nodes, as read; halves the memory of the default storage
+        Handle(Poly_Triangulation) aTri = new Poly_Triangulation();
+        aTri->SetDoublePrecision(false);
+        aTri->ResizeNodes(int(aUnique.size()), false);
+        aTri->ResizeTriangles(int(aTriangles.size() / 3), false);
+        for (size_t aNode = 0; aNode < aUnique.size(); ++aNode) {
+            const float* aPnt = &theMesh.points[size_t(aUnique[aNode]) * 3];
+            aTri->SetNode(int(aNode) + 1, gp_Pnt(aPnt[0], aPnt[1], aPnt[2]));
+        }
+        for (size_t aTriIter = 0; aTriIter < aTriangles.size() / 3; ++aTriIter) {
+            aTri->SetTriangle(int(aTriIter) + 1, Poly_Triangle(int(aTriangles[aTriIter * 3]) + 1,
+                                                               int(aTriangles[aTriIter * 3 + 1]) + 1,
+                                                               int(aTriangles[aTriIter * 3 + 2]) + 1));
+        }
+        aTri->Deflection(0.0);
+        return aTri;
+    }
+}
+
+double MeshImportStats::megabytesPerSecond() const
+{
+    const qint64 aMs = std::max(parseMs + weldMs, qint64(1));
+    return fileSize / (1024.0 * 1024.0) / (aMs / 1000.0);
+}
+
+QString MeshImportStats::summary() const
+{
+    return QString("Mesh import: %1 triangles, %2 of %3 vertices kept after welding, %4 MB/s")
+        .arg(triangles).arg(vertices).arg(inputVertices)
+        .arg(megabytesPerSecond(), 0, 'f', 0);
+}
+
+bool MeshImport::isMeshFormat(const QString& theFormat)
+{
+    return theFormat == "STL" || theFormat == "OBJ" || theFormat == "PLY";
+}
+
+Handle(Poly_Triangulation) MeshImport::readTriangulation(const QString& theFilePath, const QString& theFormat,
+                                                         const Message_ProgressRange& theProgress,
+                                                         MeshImportStats& theStats, QString& theError)
+{
+    theStats = MeshImportStats();
+    Message_ProgressScope aPS(theProgress, "Reading mesh", 2);
+
+    QFile aFile(theFilePath);
+    if (!aFile.open(QIODevice::ReadOnly)) {
+        theError = "Cannot open " + theFilePath;
+        return Handle(Poly_Triangulation)();
+    }
+    theStats.fileSize = aFile.size();
+    const uchar* aMapped = theStats.fileSize > 0 ? aFile.map(0, theStats.fileSize) : nullptr;
+    if (aMapped == nullptr) {
+        theError = "Cannot map " + theFilePath;
+        return Handle(Poly_Triangulation)();
+    }
+
+    QElapsedTimer aTimer;
+    aTimer.start();
+    RawMesh aRaw;
+    bool isRead = false;
+    {
+        Message_ProgressScope aParseScope(aPS.Next(), "Parsing", 1);
+        const char* aData = reinterpret_cast<const char*>(aMapped);
+        try {
+            if (theFormat == "STL") isRead = readStl(aData, theStats.fileSize, aRaw, aParseScope, theError);
+            else if (theFormat == "OBJ") isRead = readObj(aData, theStats.fileSize, aRaw, aParseScope, theError);
+            else if (theFormat == "PLY") isRead = readPly(aData, theStats.fileSize, aRaw, aParseScope, theError);
+        } catch (const std::bad_alloc&) {
+            theError = "Out of memory reading " + theFilePath;
+            isRead = false;
+        }
+    }
+    aFile.unmap(const_cast<uchar*>(aMapped));
+    theStats.parseMs = aTimer.restart();
+    if (!isRead) {
+        if (theError.isEmpty() && aPS.UserBreak()) theError = "Cancelled";
+        return Handle(Poly_Triangulation)();
+    }
+
+    Handle(Poly_Triangulation) aTri = weld(aRaw, theStats);
+    theStats.weldMs = aTimer.elapsed();
+    aPS.Next();
+    if (aTri.IsNull()) {
+        theError = "No triangles in " + theFilePath;
+        return aTri;
+    }
+
+    Message::SendInfo() << theStats.summary().toStdString() << " (parse " << theStats.parseMs
+                        << " ms, weld " << theStats.weldMs << " ms)";
+    return aTri;
+}
+
+TopoDS_Shape MeshImport::read(const QString& theFilePath, const QString& theFormat,
+                              const Message_ProgressRange& theProgress,
+                              MeshImportStats& theStats, QString& theError)
+{
+    const Handle(Poly_Triangulation) aTri = readTriangulation(theFilePath, theFormat, theProgress, theStats, theError);
+    if (aTri.IsNull()) {
+        Message::SendFail() << "Mesh import failed: " << theError.toStdString();
+        return TopoDS_Shape();
+    }
+
+    BRep_Builder aBuilder;
+    TopoDS_Face aFace;
+    aBuilder.MakeFace(aFace, aTri);
+    return aFace;
+}
+
+QString MeshImport::benchmarkAgainstRWStl(const QString& theFilePath)
+{
+    MeshImportStats aStats;
+    QString anError;
+    QElapsedTimer aTimer;
+    aTimer.start();
+    const Handle(Poly_Triangulation) anOwn = readTriangulation(theFilePath, "STL", Message_ProgressRange(),
+                                                               aStats, anError);
+    const qint64 anOwnMs = std::max(aTimer.restart(), qint64(1));
+
+    Handle(Poly_Triangulation) anOcct;
+    try {
+        anOcct = RWStl::ReadFile(TCollection_AsciiString(theFilePath.toUtf8().constData()).ToCString());
+    } catch (const Standard_Failure& e) {
+        Message::SendWarning() << "RWStl failed: " << e.GetMessageString();
+    }
+    const qint64 anOcctMs = std::max(aTimer.elapsed(), qint64(1));
+
+    const double aMB = aStats.fileSize / (1024.0 * 1024.0);
+    return QString("MeshImport %1 MB/s (%2 ms, %3 triangles), RWStl %4 MB/s (%5 ms, %6 triangles)")
+        .arg(aMB / (anOwnMs / 1000.0), 0, 'f', 0).arg(anOwnMs)
+        .arg(anOwn.IsNull() ? 0 : anOwn->NbTriangles())
+        .arg(aMB / (anOcctMs / 1000.0), 0, 'f', 0).arg(anOcctMs)
+        .arg(anOcct.IsNull() ? 0 : anOcct->NbTriangles());
+}
@@ -0,0 +1,165 @@
+// ModelCache.cpp
+#include "ModelCache.h"
+#include "OcctQtTools.h"
+
+#include <BinTools.hxx>
+#include <Message.hxx>
+#include <Standard_Failure.hxx>
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QThread>
+
+namespace
+{
+    const char* const THE_ENTRY_SUFFIX = ".bin";
+}
+
+ModelCache::ModelCache(const QString& theDirectory, qint64 theMaxBytes)
+    : myDirectory(theDirectory.isEmpty() ? defaultDirectory() : theDirectory),
+      myMaxBytes(theMaxBytes)
+{
+    QDir().mkpath(myDirectory);
+}
+
+QString ModelCache::defaultDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/brep";
+}
+
+QString ModelCache::keyForFile(const QString& theFilePath)
+{
+    QFile aFile(theFilePath);
+    if (!aFile.open(QIODevice::ReadOnly)) return QString();
+
+    // Streamed, the file is never held in memory as a whole
+    QCryptographicHash aHash(QCryptographicHash::Sha1);
+    if (!aHash.addData(&aFile)) return QString();
+
+    const QFileInfo anInfo(theFilePath);
+    return QString("%1-%2-%3")
+        .arg(QString::fromLatin1(aHash.result().toHex()))
+        .arg(anInfo.size())
+        .arg(anInfo.lastModified().toSecsSinceEpoch());
+}
+
+QString ModelCache::meshKey(const QString& theKey, const QString& theLevel)
+{
+    return QString("%1.mesh-%2").arg(theKey, theLevel);
+}
+
+QString ModelCache::healedKey(const QString& theKey)
+{
+    return theKey + ".healed";
+}
+
+QString ModelCache::entryPath(const QString& theKey) const
+{
+    return myDirectory + "/" + theKey + THE_ENTRY_SUFFIX;
+}
+
+bool ModelCache::load(const QString& theKey, TopoDS_Shape& theShape,
+                      const Message_ProgressRange& theProgress) const
+{
+    const QString aPath = entryPath(theKey);
+    if (!QFileInfo::exists(aPath)) return false;
+
+    try {
+        const TCollection_AsciiString anOcctPath = OcctQtTools::qtStringToOcct(aPath);
+        if (!BinTools::Read(theShape, anOcctPath.ToCString(), theProgress) || theShape.IsNull()) {
+            Message::SendWarning() << "Dropping unreadable cache entry: " << aPath.toStdString();
+            QFile::remove(aPath);
+            theShape.Nullify();
+            return false;
+        }
+    } catch (const Standard_Failure& e) {
+        Message::SendWarning() << "Cache read error: " << e.GetMessageString();
+        QFile::remove(aPath);
+        theShape.Nullify();
+        return false;
+    }
+
+    // Refresh the LRU stamp
+    QFile anEntry(aPath);
+    if (anEntry.open(QIODevice::ReadWrite)) {
+        anEntry.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    }
+    return true;
+}
+
+bool ModelCache::store(const QString& theKey, const TopoDS_Shape& theShape,
+                       bool theWithTriangles) const
+{
+    if (theKey.isEmpty() || theShape.IsNull()) return false;
+
+    // Write to a private temporary first so concurrent loads never see a partial entry
+    const QString aPath = entryPath(theKey);
+    const QString aTmpPath = aPath + QString(".%1.tmp").arg(quintptr(QThread::currentThreadId()));
+
+    try {
+        const TCollection_AsciiString anOcctPath = OcctQtTools::qtStringToOcct(aTmpPath);
+        if (!BinTools::Write(theShape, anOcctPath.ToCString(), theWithTriangles, Standard_False,
+                             BinTools_FormatVersion_CURRENT)) {
+            Message::SendWarning() << "Failed to write cache entry: " << aTmpPath.toStdString();
+            QFile::remove(aTmpPath);
+            return false;
+        }
+    } catch (const Standard_Failure& e) {
+        Message::SendWarning() << "Cache write error: " << e.GetMessageString();
+        QFile::remove(aTmpPath);
+        return false;
+    }
+
+    QFile::remove(aPath);
+    if (!QFile::rename(aTmpPath, aPath)) {
+        QFile::remove(aTmpPath);
+        return false;
+    }
+
+    evict();
+    return true;
+}
+
+void ModelCache::evict() const
+{
+    QDir aDir(myDirectory);
+    // Oldest first
+    QFileInfoList anEntries = aDir.entryInfoList(QStringList() << QString("*") + THE_ENTRY_SUFFIX,
+                                                 QDir::Files, QDir::Time | QDir::Reversed);
+    qint64 aTotal = 0;
+    for (const QFileInfo& anEntry : std::as_const(anEntries)) {
+        aTotal += anEntry.size();
+    }
+
+    for (const QFileInfo& anEntry : std::as_const(anEntries)) {
+        if (aTotal <= myMaxBytes) break;
+        if (QFile::remove(anEntry.absoluteFilePath())) {
+            aTotal -= anEntry.size();
+            Message::SendInfo() << "Model cache evicted: " << anEntry.fileName().toStdString();
+        }
+    }
+}
+
+void ModelCache::clear() const
+{
+    QDir aDir(myDirectory);
+    const QStringList aNames = aDir.entryList(QStringList() << QString("*") + THE_ENTRY_SUFFIX, QDir::Files);
+    for (const QString& aName : aNames) {
+        aDir.remove(aName);
+    }
+}
+
+qint64 ModelCache::totalBytes() const
+{
+    qint64 aTotal = 0;
+    const QFileInfoList anEntries = QDir(myDirectory).entryInfoList(
+        QStringList() << QString("*") + THE_ENTRY_SUFFIX, QDir::Files);
+    for (const QFileInfo& anEntry : anEntries) {
+        aTotal += anEntry.size();
+    }
+    return aTotal;
+}
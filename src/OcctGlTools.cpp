@@ -81,8 +81,6 @@ bool OcctGlTools::InitializeGlWindow(const Handle(V3d_View)& theView,
                                      const Graphic3d_Vec2i& theSize,
                                      const double thePixelRatio)
 {
-  const Aspect_Drawable aNativeWin = GetGlNativeWindow(theNativeWin);
-
   Handle(OpenGl_GraphicDriver) aDriver = Handle(OpenGl_GraphicDriver)::DownCast(theView->Viewer()->Driver());
   Handle(OpenGl_Context) aGlCtx = new OpenGl_Context();
   if (!aGlCtx->Init(!aDriver->Options().contextCompatible))
@@ -91,6 +89,9 @@ bool OcctGlTools::InitializeGlWindow(const Handle(V3d_View)& theView,
     return false;
   }
 
+  // Offscreen there is no window: the context's own drawable (pbuffer or surface) is used
+  const Aspect_Drawable aNativeWin = theNativeWin != 0 ? GetGlNativeWindow(theNativeWin) : aGlCtx->Window();
+
   Handle(OcctNeutralWindow) aWindow = Handle(OcctNeutralWindow)::DownCast(theView->Window());
   if (aWindow.IsNull())
   {
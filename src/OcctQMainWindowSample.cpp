@@ -2,6 +2,9 @@
 
 #include "OcctQMainWindowSample.h"
 #include "Core.h"
+#include "Measurement.h"
+#include "GlbExport.h"
+#include "TransferLock.h"
 
 // Qt UI Headers
 #include <QApplication>
@@ -16,6 +19,12 @@
 #include <QLabel>
 #include <QCheckBox>
 #include <QFileDialog>
+#include <QSpinBox>
+#include <QComboBox>
+#include <QtMath>
+#include <QFileInfo>
+#include <QDir>
+#include <QHBoxLayout>
 
 // Qt Printing & Export Headers
 #include <QTextStream>
@@ -44,6 +53,7 @@ OcctQMainWindowSample::OcctQMainWindowSample()
             [this](const QString& fileName) {
                 statusBar()->showMessage("Loaded: " + fileName, 4000);
                 setWindowTitle("CAD Viewer - " + fileName);
+                myAssemblyTree->clear();
             });
 
     connect(myViewer, &OcctQWidgetViewer::errorOccurred, this,
@@ -53,6 +63,42 @@ OcctQMainWindowSample::OcctQMainWindowSample()
 
     connect(myViewer, &OcctQWidgetViewer::measurementsUpdated, this, &OcctQMainWindowSample::onMeasurementsUpdated);
 
+    // Asynchronous load feedback
+    myLoadProgressBar = new QProgressBar(this);
+    myLoadProgressBar->setRange(0, 100);
+    myLoadProgressBar->setMaximumWidth(240);
+    myLoadProgressBar->setTextVisible(true);
+    myLoadProgressBar->hide();
+    statusBar()->addPermanentWidget(myLoadProgressBar);
+
+    connect(myViewer, &OcctQWidgetViewer::loadStarted, this, &OcctQMainWindowSample::onLoadStarted);
+    connect(myViewer, &OcctQWidgetViewer::loadProgress, this, &OcctQMainWindowSample::onLoadProgress);
+    connect(myViewer, &OcctQWidgetViewer::loadFinished, this, &OcctQMainWindowSample::onLoadFinished);
+    connect(myViewer, &OcctQWidgetViewer::stepPrescanned, this, &OcctQMainWindowSample::onStepPrescanned);
+    // Lazy assemblies: one row per subassembly, activated rows are loaded
+    connect(myViewer, &OcctQWidgetViewer::assemblyOpened, this, [this](const QStringList& theNames) {
+        myAssemblyTree->clear();
+        for (const QString& aName : theNames) {
+            new QTreeWidgetItem(myAssemblyTree, QStringList() << aName << "Placeholder");
+        }
+        myDockAssembly->show();
+        myDockAssembly->raise();
+    });
+    connect(myViewer, &OcctQWidgetViewer::assemblyNodeLoaded, this, [this](int theIndex, bool theSuccess) {
+        if (QTreeWidgetItem* anItem = myAssemblyTree->topLevelItem(theIndex)) {
+            anItem->setText(1, theSuccess ? "Loaded" : "Placeholder");
+        }
+    });
+    connect(myAssemblyTree, &QTreeWidget::itemActivated, this, [this](QTreeWidgetItem* theItem, int) {
+        if (theItem->text(1) != "Placeholder") return;
+        theItem->setText(1, "Loading...");
+        myViewer->loadAssemblyNode(myAssemblyTree->indexOfTopLevelItem(theItem));
+    });
+
+    connect(myViewer, &OcctQWidgetViewer::loadReport, this, [this](const QString& theSummary) {
+        if (!theSummary.isEmpty()) statusBar()->showMessage(statusBar()->currentMessage() + " (" + theSummary + ")", 4000);
+    });
+
     // Initial status
     statusBar()->showMessage("Ready");
 }
@@ -75,6 +121,19 @@ void OcctQMainWindowSample::createMenuBar()
     connect(aLoadAction, &QAction::triggered, this, &OcctQMainWindowSample::loadCADModel);
     aFileMenu->addAction(aLoadAction);
 
+    QAction* aLoadDirAction = new QAction("Open &Directory...", this);
+    aLoadDirAction->setShortcut(Qt::CTRL | Qt::SHIFT | Qt::Key_O);
+    connect(aLoadDirAction, &QAction::triggered, this, &OcctQMainWindowSample::loadCADDirectory);
+    aFileMenu->addAction(aLoadDirAction);
+
+    myCancelLoadAction = new QAction("Cancel &Loading", this);
+    myCancelLoadAction->setShortcut(Qt::CTRL | Qt::Key_Period);
+    myCancelLoadAction->setEnabled(false);
+    connect(myCancelLoadAction, &QAction::triggered, this, [this]() {
+        if (myViewer) myViewer->cancelLoad();
+    });
+    aFileMenu->addAction(myCancelLoadAction);
+
     // --- NEW: EXPORT MENU ---
     QMenu* aSaveMenu = menuBar()->addMenu("&Save");
     QMenu* aExportMenu = aSaveMenu->addMenu("Export As");
@@ -86,8 +145,19 @@ void OcctQMainWindowSample::createMenuBar()
     QAction* aPdfAction = new QAction("PDF (*.pdf)", this);
     connect(aPdfAction, &QAction::triggered, this, &OcctQMainWindowSample::exportToPDF);
     aExportMenu->addAction(aPdfAction);
+
+    QAction* aGlbAction = new QAction("glTF Binary Mesh (*.glb)", this);
+    connect(aGlbAction, &QAction::triggered, this, &OcctQMainWindowSample::exportToGLB);
+    aExportMenu->addAction(aGlbAction);
     // ------------------------
 
+    QAction* aClearCacheAction = new QAction("Clear Model Cache", this);
+    connect(aClearCacheAction, &QAction::triggered, this, [this]() {
+        if (myViewer) myViewer->clearModelCache();
+        statusBar()->showMessage("Model cache cleared", 3000);
+    });
+    aFileMenu->addAction(aClearCacheAction);
+
     QAction* aClearAction = new QAction("&Clear", this);
     connect(aClearAction, &QAction::triggered, this, &OcctQMainWindowSample::clearAllShapes);
     aFileMenu->addAction(aClearAction);
@@ -107,6 +177,20 @@ void OcctQMainWindowSample::createMenuBar()
     });
     aViewMenu->addAction(aFitAction);
 
+    QAction* aFrameStatsAction = new QAction("Frame Statistics", this);
+    aFrameStatsAction->setToolTip("Frames drawn, redraw requests merged, CPU use while idle and hover pick latency,\nsince the last reset");
+    connect(aFrameStatsAction, &QAction::triggered, this, [this]() {
+        if (!myViewer) return;
+        statusBar()->showMessage(myViewer->frameStats().summary() + "; hover: " + myViewer->hoverStats().summary(), 8000);
+    });
+    aViewMenu->addAction(aFrameStatsAction);
+
+    QAction* aResetStatsAction = new QAction("Reset Frame Statistics", this);
+    connect(aResetStatsAction, &QAction::triggered, this, [this]() {
+        if (myViewer) myViewer->resetFrameStats();
+    });
+    aViewMenu->addAction(aResetStatsAction);
+
     // --- WINDOWS MENU ---
     QMenu* aWindowMenu = menuBar()->addMenu("&Windows");
 
@@ -114,6 +198,7 @@ void OcctQMainWindowSample::createMenuBar()
     if (myDockDescription) aWindowMenu->addAction(myDockDescription->toggleViewAction());
     if (myDockModelData) aWindowMenu->addAction(myDockModelData->toggleViewAction());
     if (myDockTools) aWindowMenu->addAction(myDockTools->toggleViewAction());
+    if (myDockAssembly) aWindowMenu->addAction(myDockAssembly->toggleViewAction());
 }
 
 void OcctQMainWindowSample::createLayoutOverViewer()
@@ -199,11 +284,259 @@ void OcctQMainWindowSample::createDockWidgets()
     });
     toolsLayout->addWidget(myOriginVisBox);
 
+    myParallelTransferBox = new QCheckBox("Parallel Transfer");
+    myParallelTransferBox->setToolTip("Transfer STEP roots on all cores and merge them into one compound (OCCT 7.8 or later;\nolder versions keep STEP units in process-wide state, IGES always does).\nPer-root timings are written to the log.");
+    connect(myParallelTransferBox, &QCheckBox::toggled, this, [this](bool checked){
+        if(myViewer) myViewer->setParallelTransfer(checked);
+    });
+    if (!TransferLock::isParallelSafe(TransferLock::Step)) {
+        // The loader would transfer the roots one at a time anyway
+        myParallelTransferBox->setEnabled(false);
+        myParallelTransferBox->setToolTip("Needs OCCT 7.8 or later: this build keeps STEP units in process-wide state,\nso STEP roots are transferred one at a time.");
+    }
+    toolsLayout->addWidget(myParallelTransferBox);
+
+    myStreamingDisplayBox = new QCheckBox("Streaming Display");
+    myStreamingDisplayBox->setToolTip("Show each STEP/IGES root as soon as it is transferred.\nSelection and measurements are enabled once the model is complete.");
+    connect(myStreamingDisplayBox, &QCheckBox::toggled, this, [this](bool checked){
+        if(myViewer) myViewer->setStreamingDisplay(checked);
+    });
+    toolsLayout->addWidget(myStreamingDisplayBox);
+
+    myAssemblyInstancingBox = new QCheckBox("Assembly Instancing");
+    myAssemblyInstancingBox->setToolTip("Load STEP assemblies with their product structure.\nEach unique part is meshed once and shared by all of its instances.");
+    connect(myAssemblyInstancingBox, &QCheckBox::toggled, this, [this](bool checked){
+        if(myViewer) myViewer->setAssemblyInstancing(checked);
+    });
+    toolsLayout->addWidget(myAssemblyInstancingBox);
+
+    myLazyAssemblyBox = new QCheckBox("Lazy Assembly Loading");
+    myLazyAssemblyBox->setToolTip("Open STEP assemblies as bounding box placeholders.\nDouble-click a subassembly in the Assembly window to load its geometry.");
+    connect(myLazyAssemblyBox, &QCheckBox::toggled, this, [this](bool checked){
+        if(myViewer) myViewer->setLazyAssembly(checked);
+    });
+    toolsLayout->addWidget(myLazyAssemblyBox);
+
+    myModelCacheBox = new QCheckBox("Use Model Cache");
+    myModelCacheBox->setToolTip("Reopen STEP/IGES files from a binary BRep cache keyed by file content");
+    myModelCacheBox->setChecked(true);
+    connect(myModelCacheBox, &QCheckBox::toggled, this, [this](bool checked){
+        if(myViewer) myViewer->setModelCacheEnabled(checked);
+    });
+    toolsLayout->addWidget(myModelCacheBox);
+
+    myShapeHealingBox = new QCheckBox("Heal Imported Shapes");
+    myShapeHealingBox->setToolTip("Run ShapeFix on STEP/IGES solids and faces on all cores after the transfer.\nWhat was fixed is written to the log; the healed model is cached.");
+    connect(myShapeHealingBox, &QCheckBox::toggled, this, [this](bool checked){
+        if(myViewer) myViewer->setShapeHealing(checked);
+    });
+    toolsLayout->addWidget(myShapeHealingBox);
+
+    QHBoxLayout* aHealLayout = new QHBoxLayout();
+    QLabel* aHealLabel = new QLabel("Healing budget (s)");
+    QSpinBox* aHealSpin = new QSpinBox();
+    aHealSpin->setRange(0, 3600);
+    aHealSpin->setValue(60);
+    aHealSpin->setSpecialValueText("No limit");
+    aHealSpin->setToolTip("Parts not started within this time are left as read (and the result is not cached)");
+    connect(aHealSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, [this](int theSeconds){
+        if(myViewer) myViewer->setHealTimeBudget(qint64(theSeconds) * 1000);
+    });
+    aHealLayout->addWidget(aHealLabel);
+    aHealLayout->addWidget(aHealSpin);
+    toolsLayout->addLayout(aHealLayout);
+
+    // Display tessellation, applied from the next load on
+    QHBoxLayout* aDeflLayout = new QHBoxLayout();
+    QComboBox* aDeflModeCombo = new QComboBox();
+    aDeflModeCombo->addItem("Deflection / model size", int(MeshParameters::ModelRelative));
+    aDeflModeCombo->addItem("Deflection / solid size", int(MeshParameters::SolidRelative));
+    aDeflModeCombo->addItem("Deflection (mm)", int(MeshParameters::AbsoluteDeflection));
+    aDeflModeCombo->addItem("Triangle budget (M)", int(MeshParameters::TriangleBudget));
+    aDeflModeCombo->setToolTip("Chord deflection as a fraction of the model or of each solid's bounding box diagonal,\nor in model units. Per-solid keeps small parts of large assemblies smooth.\nA triangle budget fits deflection and angle to the model from a quick sample mesh.");
+    QDoubleSpinBox* aDeflSpin = new QDoubleSpinBox();
+    aDeflSpin->setDecimals(5);
+    aDeflSpin->setRange(0.00001, 100.0);
+    aDeflSpin->setSingleStep(0.0001);
+    aDeflSpin->setValue(myViewer->meshParameters().deflection);
+    QDoubleSpinBox* aBudgetSpin = new QDoubleSpinBox();
+    aBudgetSpin->setDecimals(2);
+    aBudgetSpin->setRange(0.01, 1000.0);
+    aBudgetSpin->setSingleStep(0.5);
+    aBudgetSpin->setValue(myViewer->meshParameters().triangleBudget / 1.0e6);
+    aBudgetSpin->setToolTip("Millions of triangles for the whole model");
+    aBudgetSpin->setVisible(false);
+    connect(aDeflModeCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this, aDeflModeCombo, aDeflSpin, aBudgetSpin](int){
+        if(!myViewer) return;
+        MeshParameters aParams = myViewer->meshParameters();
+        aParams.mode = MeshParameters::DeflectionMode(aDeflModeCombo->currentData().toInt());
+        const bool isBudget = aParams.mode == MeshParameters::TriangleBudget;
+        aDeflSpin->setVisible(!isBudget);
+        aBudgetSpin->setVisible(isBudget);
+        if (!isBudget) {
+            // A relative fraction makes no sense as millimetres and the other way round
+            aParams.deflection = aParams.mode == MeshParameters::AbsoluteDeflection ? 0.01 : MeshParameters().deflection;
+            aDeflSpin->setValue(aParams.deflection);
+        }
+        myViewer->setMeshParameters(aParams);
+    });
+    connect(aDeflSpin, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, [this](double theValue){
+        if(myViewer) myViewer->setMeshDeflection(theValue);
+    });
+    connect(aBudgetSpin, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, [this](double theMillions){
+        if(!myViewer) return;
+        MeshParameters aParams = myViewer->meshParameters();
+        aParams.triangleBudget = qint64(theMillions * 1.0e6);
+        myViewer->setMeshParameters(aParams);
+    });
+    aDeflLayout->addWidget(aDeflModeCombo);
+    aDeflLayout->addWidget(aDeflSpin);
+    aDeflLayout->addWidget(aBudgetSpin);
+    toolsLayout->addLayout(aDeflLayout);
+
+    // Applies to the displayed model right away, unlike the settings above
+    QHBoxLayout* aQualityLayout = new QHBoxLayout();
+    QLabel* aQualityLabel = new QLabel("Display quality");
+    QComboBox* aQualityCombo = new QComboBox();
+    aQualityCombo->addItem("Draft", 8.0);
+    aQualityCombo->addItem("Coarse", 3.0);
+    aQualityCombo->addItem("Normal", 1.0);
+    aQualityCombo->addItem("Fine", 1.0 / 3.0);
+    aQualityCombo->addItem("Very fine", 0.1);
+    aQualityCombo->setCurrentIndex(2);
+    aQualityCombo->setToolTip("Scales the deflection above. The displayed model is re-meshed in the background:\nrefining keeps the faces that are fine enough already, and levels shown before\nare swapped back at once.");
+    connect(aQualityCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this, aQualityCombo](int){
+        if(myViewer) myViewer->setMeshQuality(aQualityCombo->currentData().toDouble());
+    });
+    aQualityLayout->addWidget(aQualityLabel);
+    aQualityLayout->addWidget(aQualityCombo);
+    toolsLayout->addLayout(aQualityLayout);
+
+    myProgressiveMeshBox = new QCheckBox("Progressive Meshing");
+    myProgressiveMeshBox->setToolTip("Show a coarse mesh first and refine it in the background.\nSelection and measurements work on the exact geometry meanwhile;\nfirst-frame and final-quality times are written to the log.");
+    connect(myProgressiveMeshBox, &QCheckBox::toggled, this, [this](bool checked){
+        if(myViewer) myViewer->setProgressiveMesh(checked);
+    });
+    toolsLayout->addWidget(myProgressiveMeshBox);
+
+    myLevelOfDetailBox = new QCheckBox("Level of Detail");
+    myLevelOfDetailBox->setToolTip("Mesh every solid at three coarser levels as well and draw the level\nthat suits its size on screen. Selection always uses the exact geometry.");
+    connect(myLevelOfDetailBox, &QCheckBox::toggled, this, [this](bool checked){
+        if(myViewer) myViewer->setLevelOfDetail(checked);
+    });
+    toolsLayout->addWidget(myLevelOfDetailBox);
+
+    QHBoxLayout* aCullingLayout = new QHBoxLayout();
+    QCheckBox* aCullingBox = new QCheckBox("Size Culling");
+    aCullingBox->setToolTip("Skip objects whose projected size is below the threshold.\nThe stats overlay shows drawn against total objects, Frame Statistics the culled count.");
+    QComboBox* aCullingModeCombo = new QComboBox();
+    aCullingModeCombo->addItem("While moving");
+    aCullingModeCombo->addItem("Always");
+    aCullingModeCombo->setToolTip("While moving: everything is drawn again once the camera comes to rest");
+    QSpinBox* aCullingSpin = new QSpinBox();
+    aCullingSpin->setRange(1, 100);
+    aCullingSpin->setValue(8);
+    aCullingSpin->setSuffix(" px");
+    auto applyCulling = [this, aCullingBox, aCullingModeCombo, aCullingSpin]() {
+        if(myViewer) myViewer->setSizeCulling(aCullingBox->isChecked() ? aCullingSpin->value() : 0.0,
+                                              aCullingModeCombo->currentIndex() == 0);
+    };
+    connect(aCullingBox, &QCheckBox::toggled, this, applyCulling);
+    connect(aCullingModeCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, applyCulling);
+    connect(aCullingSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, applyCulling);
+    aCullingLayout->addWidget(aCullingBox);
+    aCullingLayout->addWidget(aCullingModeCombo);
+    aCullingLayout->addWidget(aCullingSpin);
+    toolsLayout->addLayout(aCullingLayout);
+
+    QCheckBox* aDegradationBox = new QCheckBox("Light Navigation");
+    aDegradationBox->setToolTip("While rotating, panning or zooming a model that misses the display refresh, draw it opaque\nand, with Level of Detail, at the coarsest level without face boundaries;\nfar parts become boxes if that is still too slow. Full quality returns when the camera rests.");
+    connect(aDegradationBox, &QCheckBox::toggled, this, [this](bool checked){
+        if(myViewer) myViewer->setInteractionDegradation(checked);
+    });
+    toolsLayout->addWidget(aDegradationBox);
+
+    QHBoxLayout* aResolutionLayout = new QHBoxLayout();
+    QCheckBox* aResolutionBox = new QCheckBox("Dynamic Resolution");
+    aResolutionBox->setToolTip("While navigating, lower MSAA and then the render resolution to hold the frame time,\nthe image upscaled to the window. The current scale is shown in the lower left corner;\none full-quality frame is drawn when the camera rests.");
+    QSpinBox* aTargetSpin = new QSpinBox();
+    aTargetSpin->setRange(0, 100);
+    aTargetSpin->setValue(0);
+    aTargetSpin->setSuffix(" ms");
+    aTargetSpin->setSpecialValueText("Refresh");
+    aTargetSpin->setToolTip("Frame time target. Refresh follows the display: with vsync a frame takes\na whole refresh interval, so targets below it (16.7 ms at 60 Hz) are never met");
+    auto applyResolution = [this, aResolutionBox, aTargetSpin]() {
+        if(myViewer) myViewer->setDynamicResolution(aResolutionBox->isChecked(), aTargetSpin->value());
+    };
+    connect(aResolutionBox, &QCheckBox::toggled, this, applyResolution);
+    connect(aTargetSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, applyResolution);
+    aResolutionLayout->addWidget(aResolutionBox);
+    aResolutionLayout->addWidget(aTargetSpin);
+    toolsLayout->addLayout(aResolutionLayout);
+
+    QHBoxLayout* aMeshLayout = new QHBoxLayout();
+    QLabel* anAngleLabel = new QLabel("Angle (deg)");
+    QDoubleSpinBox* anAngleSpin = new QDoubleSpinBox();
+    anAngleSpin->setDecimals(1);
+    anAngleSpin->setRange(1.0, 90.0);
+    anAngleSpin->setValue(qRadiansToDegrees(myViewer->meshParameters().angle));
+    anAngleSpin->setToolTip("Angular deflection of the display mesh; fitted automatically with a triangle budget");
+    connect(anAngleSpin, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, [this](double theDegrees){
+        if(!myViewer) return;
+        MeshParameters aParams = myViewer->meshParameters();
+        aParams.angle = qDegreesToRadians(theDegrees);
+        myViewer->setMeshParameters(aParams);
+    });
+    QLabel* aThreadsLabel = new QLabel("Threads");
+    QSpinBox* aThreadsSpin = new QSpinBox();
+    aThreadsSpin->setRange(0, 256);
+    aThreadsSpin->setSpecialValueText("All");
+    aThreadsSpin->setToolTip("Meshing threads, 1 = single-threaded.\nA cap above 1 applies to models made of separate parts; a single part,\nor parts sharing edges, is meshed by BRepMesh on all cores.");
+    connect(aThreadsSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, [this](int theThreads){
+        if(!myViewer) return;
+        MeshParameters aParams = myViewer->meshParameters();
+        aParams.threads = theThreads;
+        myViewer->setMeshParameters(aParams);
+    });
+    aMeshLayout->addWidget(anAngleLabel);
+    aMeshLayout->addWidget(anAngleSpin);
+    aMeshLayout->addWidget(aThreadsLabel);
+    aMeshLayout->addWidget(aThreadsSpin);
+    toolsLayout->addLayout(aMeshLayout);
+
+    QHBoxLayout* aLimitLayout = new QHBoxLayout();
+    QLabel* aLimitLabel = new QLabel("Max STEP entities (M)");
+    QSpinBox* aLimitSpin = new QSpinBox();
+    aLimitSpin->setRange(0, 10000);
+    aLimitSpin->setSpecialValueText("No limit");
+    aLimitSpin->setToolTip("Refuse STEP files whose pre-scan finds more entities (millions)");
+    connect(aLimitSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, [this](int theMillions){
+        if(myViewer) myViewer->setMaxStepEntities(qint64(theMillions) * 1000000);
+    });
+    aLimitLayout->addWidget(aLimitLabel);
+    aLimitLayout->addWidget(aLimitSpin);
+    toolsLayout->addLayout(aLimitLayout);
+
     toolsLayout->addStretch(); // Push checkbox to top of this small area
 
     myDockTools->setWidget(toolsContainer);
     addDockWidget(Qt::RightDockWidgetArea, myDockTools);
 
+    // =========================================================
+    // 4. DOCK: ASSEMBLY (lazy loading, hidden until used)
+    // =========================================================
+    myDockAssembly = new QDockWidget("Assembly", this);
+    setupDock(myDockAssembly);
+
+    myAssemblyTree = new QTreeWidget();
+    myAssemblyTree->setColumnCount(2);
+    myAssemblyTree->setHeaderLabels(QStringList() << "Subassembly" << "State");
+    myAssemblyTree->setRootIsDecorated(false);
+    myAssemblyTree->header()->setSectionResizeMode(0, QHeaderView::Stretch);
+    myDockAssembly->setWidget(myAssemblyTree);
+    addDockWidget(Qt::LeftDockWidgetArea, myDockAssembly);
+    myDockAssembly->hide();
+
     // =========================================================
     // INITIAL DOCK SIZING & ORDER
     // =========================================================
@@ -213,24 +546,124 @@ void OcctQMainWindowSample::createDockWidgets()
 
 void OcctQMainWindowSample::loadCADModel()
 {
-    QString aFileName = QFileDialog::getOpenFileName(this, "Open CAD File", "",
-                                                     "CAD Files (*.step *.stp *.iges *.igs *.brep *.STEP *.STP *.IGES *.IGS *.BREP)");
-    if (!aFileName.isEmpty()) {
-        QApplication::setOverrideCursor(Qt::WaitCursor);
-        myViewer->loadCADModel(aFileName);
-        QApplication::restoreOverrideCursor();
+    const QStringList aFileNames = QFileDialog::getOpenFileNames(this, "Open CAD Files", "",
+                                                                 "All Supported (*.step *.stp *.iges *.igs *.brep *.stl *.obj *.ply "
+                                                                 "*.STEP *.STP *.IGES *.IGS *.BREP *.STL *.OBJ *.PLY);;"
+                                                                 "CAD Files (*.step *.stp *.iges *.igs *.brep *.STEP *.STP *.IGES *.IGS *.BREP);;"
+                                                                 "Mesh Files (*.stl *.obj *.ply *.STL *.OBJ *.PLY)");
+    if (aFileNames.size() == 1) {
+        // Runs in the background; the current model stays interactive meanwhile
+        myViewer->loadCADModelAsync(aFileNames.first());
+    } else if (aFileNames.size() > 1) {
+        myViewer->loadCADModelsAsync(aFileNames);
+    }
+}
+
+void OcctQMainWindowSample::loadCADDirectory()
+{
+    const QString aDirName = QFileDialog::getExistingDirectory(this, "Open CAD Directory");
+    if (aDirName.isEmpty()) return;
+
+    const QDir aDir(aDirName);
+    const QStringList aNames = aDir.entryList(QStringList() << "*.step" << "*.stp" << "*.iges" << "*.igs" << "*.brep"
+                                                            << "*.stl" << "*.obj" << "*.ply",
+                                              QDir::Files, QDir::Name);
+    if (aNames.isEmpty()) {
+        QMessageBox::information(this, "Open Directory", "No CAD or mesh files in " + aDirName);
+        return;
+    }
+
+    QStringList aFileNames;
+    for (const QString& aName : aNames) {
+        aFileNames << aDir.absoluteFilePath(aName);
+    }
+    myViewer->loadCADModelsAsync(aFileNames);
+}
+
+void OcctQMainWindowSample::onLoadStarted(const QString& theFileName)
+{
+    myLoadProgressBar->setValue(0);
+    myLoadProgressBar->setFormat(theFileName + " - %p%");
+    myLoadProgressBar->show();
+    myCancelLoadAction->setEnabled(true);
+    statusBar()->showMessage("Loading " + theFileName + "...");
+}
+
+void OcctQMainWindowSample::onLoadProgress(int thePercent, const QString& theStep)
+{
+    myLoadProgressBar->setValue(thePercent);
+    if (!theStep.isEmpty()) {
+        statusBar()->showMessage(theStep + "...");
+    }
+}
+
+void OcctQMainWindowSample::onLoadFinished(bool theSuccess)
+{
+    myLoadProgressBar->hide();
+    myCancelLoadAction->setEnabled(false);
+    if (!theSuccess) {
+        statusBar()->showMessage("Loading cancelled or failed", 4000);
     }
 }
 
+void OcctQMainWindowSample::onStepPrescanned(const StepPrescanResult& theResult)
+{
+    myLastPrescan = theResult;
+    myLastPrescanFile = QFileInfo(theResult.filePath).fileName();
+
+    // Shown right away, the full load can take minutes
+    myPropertiesTable->setRowCount(0);
+    addPropertyRow("Filename", myLastPrescanFile);
+    addPropertyRow("Size", QString::number(theResult.fileSize / (1024.0 * 1024.0), 'f', 2) + " MB");
+    appendPrescanRows();
+}
+
+void OcctQMainWindowSample::addPropertyRow(const QString& theName, const QString& theValue)
+{
+    if (theValue.isEmpty()) return;
+    const int aRow = myPropertiesTable->rowCount();
+    myPropertiesTable->insertRow(aRow);
+    myPropertiesTable->setItem(aRow, 0, new QTableWidgetItem(theName));
+    myPropertiesTable->setItem(aRow, 1, new QTableWidgetItem(theValue));
+}
+
+void OcctQMainWindowSample::appendPrescanRows()
+{
+    if (!myLastPrescan.isValid) return;
+
+    addPropertyRow("Schema", myLastPrescan.schema);
+    addPropertyRow("Units", myLastPrescan.lengthUnits);
+    addPropertyRow("Originating System", myLastPrescan.originatingSystem);
+    addPropertyRow("Entities", QString::number(myLastPrescan.entityCount));
+    addPropertyRow("Faces", QString::number(myLastPrescan.faceCount()));
+
+    QString aProducts = QString::number(myLastPrescan.productCount);
+    if (!myLastPrescan.productNames.isEmpty()) {
+        aProducts += ": " + myLastPrescan.productNames.mid(0, 5).join(", ");
+        if (myLastPrescan.productCount > 5) aProducts += ", ...";
+    }
+    addPropertyRow("Products", aProducts);
+
+    const QVector<QPair<QString, qint64>> aTypes = myLastPrescan.topTypes(5);
+    for (const QPair<QString, qint64>& aType : aTypes) {
+        addPropertyRow("  " + aType.first, QString::number(aType.second));
+    }
+    addPropertyRow("Pre-scan Time", QString::number(myLastPrescan.scanMs) + " ms");
+}
+
 void OcctQMainWindowSample::clearAllShapes()
 {
+    myViewer->cancelLoad();
     myViewer->clearAllShapes();
     myPropertiesTable->setRowCount(0);
     mySelectionDataTable->setRowCount(0);
     myPointsTable->setRowCount(0);
+    myAssemblyTree->clear();
 
     // Clear cached export data
     myLastPointData.clear();
+    myLastPrescan = StepPrescanResult();
+    myLastPrescanFile.clear();
 
     if (myOriginVisBox) myOriginVisBox->setChecked(true);
 
@@ -258,6 +691,9 @@ void OcctQMainWindowSample::onMeasurementsUpdated(const ModelProperties& props,
     addRow(myPropertiesTable, "Filename", props.filename);
     addRow(myPropertiesTable, "Location", props.location);
     addRow(myPropertiesTable, "Size", props.size);
+    if (!myLastPrescanFile.isEmpty() && myLastPrescanFile == props.filename) {
+        appendPrescanRows();
+    }
 
     // 2. Update Model Data (Middle Dock)
     mySelectionDataTable->setRowCount(0);
@@ -349,60 +785,50 @@ void OcctQMainWindowSample::exportToCSV()
         fileName += ".csv";
     }
 
-    QFile file(fileName);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+    // 3. Same writer as the headless batch mode
+    if (!MeasurementManager::writeCSV(fileName, myLastProps, myLastPointData)) {
         QMessageBox::critical(this, "Export Error", "Could not open file for writing.");
         return;
     }
 
-    QTextStream out(&file);
-
-    // 3. Helper Lambda: Sanitize fields for CSV
-    // Wraps text in quotes if it contains commas, newlines, or double quotes
-    auto csvEscape = [](const QString& val) -> QString {
-        QString temp = val;
-        // If data contains special characters, escape quotes and wrap in quotes
-        if (temp.contains(',') || temp.contains('"') || temp.contains('\n')) {
-            temp.replace("\"", "\"\""); // Escape existing quotes (e.g. 5" -> 5"")
-            return "\"" + temp + "\"";
-        }
-        return temp;
-    };
-
-    // 4. Write Header/Metadata Section
-    // Using a key-value pair format for the top section
-    out << "Report Property,Value\n";
-    out << "Date," << csvEscape(QDate::currentDate().toString(Qt::ISODate)) << "\n";
-    out << "Filename," << csvEscape(myLastProps.filename) << "\n";
-    out << "Origin X," << QString::number(myLastProps.originX, 'f', 6) << "\n";
-    out << "Origin Y," << QString::number(myLastProps.originY, 'f', 6) << "\n";
-    out << "Origin Z," << QString::number(myLastProps.originZ, 'f', 6) << "\n";
-    out << "\n"; // Blank line separator
+    statusBar()->showMessage("Exported to CSV successfully: " + fileName, 3000);
+}
 
-    // 5. Write Data Table Headers
-    out << "ID,X,Y,Z,Distance,Curve Data\n";
 
-    // 6. Write Data Rows
-    QStringList lines = myLastPointData.split('\n', Qt::SkipEmptyParts);
-    for (const QString& line : lines) {
-        QStringList cols = line.split('|');
-        if (cols.size() < 6) continue;
-
-        // Build the CSV row
-        QStringList outputRow;
-        for(const QString& col : cols) {
-            outputRow << csvEscape(col);
-        }
+void OcctQMainWindowSample::exportToGLB()
+{
+    if (myViewer->getLoadedShape().IsNull()) {
+        QMessageBox::warning(this, "Export Warning", "No model loaded.");
+        return;
+    }
 
-        // Join with comma
-        out << outputRow.join(",") << "\n";
+    const QString aPlainFilter = "glTF Binary (*.glb)";
+    const QString aQuantizedFilter = "glTF Binary, quantized attributes (*.glb)";
+    QString aSelectedFilter;
+    QString fileName = QFileDialog::getSaveFileName(this, "Save GLB", "", aPlainFilter + ";;" + aQuantizedFilter,
+                                                    &aSelectedFilter);
+    if (fileName.isEmpty()) return;
+    if (!fileName.endsWith(".glb", Qt::CaseInsensitive)) {
+        fileName += ".glb";
     }
 
-    file.close();
-    statusBar()->showMessage("Exported to CSV successfully: " + fileName, 3000);
+    // Exports the triangulation already on screen; nothing is re-meshed
+    GlbExportOptions anOptions;
+    anOptions.quantize = aSelectedFilter == aQuantizedFilter;
+    GlbExportStats aStats;
+    QString anError;
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    const bool isDone = GlbExport::write(myViewer->getLoadedShape(), fileName, anOptions, aStats, anError);
+    QApplication::restoreOverrideCursor();
+
+    if (!isDone) {
+        QMessageBox::critical(this, "Export Error", anError);
+        return;
+    }
+    statusBar()->showMessage(QString("Exported %1 meshes, %2 triangles to GLB: %3")
+                                 .arg(aStats.meshes).arg(aStats.triangles).arg(fileName), 5000);
 }
 
-
 void OcctQMainWindowSample::exportToPDF()
 {
     if (myLastPointData.isEmpty()) {
@@ -3,8 +3,12 @@
 #include "Core.h"
 #include "OcctGlTools.h"
 #include "Measurement.h"
+#include "Assembly.h"
+#include "LazyAssembly.h"
+#include "CadModel.h"
 
 #include <QPaintEvent>
+#include <QElapsedTimer>
 #include <QDebug>
 #include <QApplication>
 
@@ -15,8 +19,10 @@
 #include <V3d_View.hxx>
 #include <AIS_InteractiveContext.hxx>
 #include <AIS_Shape.hxx>
+#include <AIS_ConnectedInteractive.hxx>
 #include <AIS_ViewCube.hxx>
 #include <AIS_Axis.hxx>
+#include <AIS_TextLabel.hxx>
 #include <AIS_Trihedron.hxx>          // --- NEW ---
 #include <Geom_Axis2Placement.hxx>    // --- NEW ---
 #include <Geom_Axis1Placement.hxx>
@@ -24,13 +30,65 @@
 #include <Prs3d_LineAspect.hxx>
 #include <Prs3d_DatumAspect.hxx>      // --- NEW ---
 #include <BRepPrimAPI_MakeBox.hxx>
-#include <BRepMesh_IncrementalMesh.hxx>
+#include <BRep_Builder.hxx>
+#include <TopoDS_Compound.hxx>
 #include <BRepBndLib.hxx>
+#include <BRepTools.hxx>
 #include <Message.hxx>
+#include <OpenGl_Context.hxx>
+#include <OpenGl_FrameStats.hxx>
+#include <PrsMgr_PresentationManager.hxx>
+#include <Graphic3d_TransformPers.hxx>
+#include <Precision.hxx>
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_set>
+#include <vector>
+
+namespace
+{
+    //! Camera unchanged for this long ends a navigation
+    const int THE_NAVIGATION_REST_MS = 150;
+    //! Full quality comes back this long after a navigation ended
+    const int THE_DEGRADATION_RESTORE_MS = 250;
+    //! Weight of the newest frame in the smoothed frame times
+    const double THE_FRAME_TIME_SMOOTHING = 0.3;
+    //! Projected diameter below which a degraded part is drawn as its bounding box
+    const double THE_DEGRADED_BOX_PIXELS = 32.0;
+    //! AIS_Shape display mode drawing the bounding box
+    const int THE_BOX_DISPLAY_MODE = 2;
+    const double THE_MODEL_TRANSPARENCY = 0.25;
+    //! Lowest render resolution while navigating, a quarter of the pixels at 0.5
+    const double THE_MIN_RENDER_SCALE = 0.35;
+    //! Frames faster than this fraction of the target get more resolution back
+    const double THE_UPSCALE_MARGIN = 0.6;
+    //! Headroom of the frame budget over one display refresh
+    const double THE_REFRESH_MARGIN = 1.25;
+    //! Fast frames in a row before resolution is raised again
+    const int THE_UPSCALE_FRAMES = 8;
+    //! GUI thread time per event loop pass spent computing coarse LOD presentations ahead
+    const int THE_LOD_PRECOMPUTE_SLICE_MS = 8;
+
+    double smoothedFrameTime(double theAverage, double theSample)
+    {
+        return theAverage <= 0.0 ? theSample
+                                 : theAverage + THE_FRAME_TIME_SMOOTHING * (theSample - theAverage);
+    }
+}
 
 RenderManager::RenderManager(OcctQWidgetViewer* viewer)
-    : m_viewer(viewer), myIsOriginVisible(true)
+    : m_viewer(viewer), myScheduler(viewer), myIsOriginVisible(true)
 {
+    myNavigationTimer.setSingleShot(true);
+    QObject::connect(&myNavigationTimer, &QTimer::timeout, viewer, [this]() {
+        myIsNavigating = false;
+        onNavigationChanged();
+    });
+    myRestoreTimer.setSingleShot(true);
+    QObject::connect(&myRestoreTimer, &QTimer::timeout, viewer, [this]() { setDegraded(false); });
+    // Zero interval: one slice per event loop pass, input and frames get through in between
+    QObject::connect(&myLodPrecomputeTimer, &QTimer::timeout, viewer, [this]() { precomputeLevelsOfDetail(); });
 }
 
 void RenderManager::initializeGL()
@@ -80,12 +138,18 @@ void RenderManager::initializeGL()
 
 void RenderManager::paintEvent(QPaintEvent*)
 {
-    if (m_viewer->myView.IsNull()) return;
+    if (m_viewer->myView.IsNull()) {
+        myScheduler.frameSkipped();
+        return;
+    }
 
     // Lazy Initialization
     if (m_viewer->myView->Window().IsNull()) {
         initializeGL();
-        if (m_viewer->myView->Window().IsNull()) return;
+        if (m_viewer->myView->Window().IsNull()) {
+            myScheduler.frameSkipped();
+            return;
+        }
     }
 
     try {
@@ -116,9 +180,13 @@ void RenderManager::paintEvent(QPaintEvent*)
 
         Handle(V3d_View) aView = !m_viewer->myFocusView.IsNull() ? m_viewer->myFocusView : m_viewer->myView;
         aView->InvalidateImmediate();
+        myScheduler.frameStarted();
         m_viewer->AIS_ViewController::FlushViewEvents(m_viewer->myContext, aView, true);
+        myScheduler.frameFinished();
+        recordFrameTime(myScheduler.lastFrameMs());
 
     } catch (const Standard_Failure& e) {
+        myScheduler.frameFinished();
         Message::SendFail() << "Paint error: " << e.GetMessageString();
     }
 }
@@ -154,18 +222,326 @@ void RenderManager::dumpGlInfo(bool theIsBasic, bool theToPrint)
 
 void RenderManager::updateView()
 {
-    m_viewer->QWidget::update();
+    myScheduler.requestFrame();
 }
 
 void RenderManager::handleViewRedraw(const Handle(AIS_InteractiveContext)& theCtx,
                                      const Handle(V3d_View)& theView)
 {
+    updateNavigationState(theView);
+    updateLevelsOfDetail(theView);
+    // Highlighting alone only redraws the immediate layer; those frames say nothing about the model
+    myIsFullRedraw = !theView.IsNull() && theView->IsInvalidated();
+    if (myIsFullRedraw && myIsDegraded) myScheduler.countDegradedFrame();
     m_viewer->AIS_ViewController::handleViewRedraw(theCtx, theView);
+    updateCulledCount(theView);
     if (m_viewer->myToAskNextFrame) {
+        // Paced at the animation rate; without it the view redraws as fast as it can
+        myScheduler.requestAnimationFrame();
+    }
+}
+
+void RenderManager::updateNavigationState(const Handle(V3d_View)& theView)
+{
+    if (theView.IsNull()) return;
+    const Graphic3d_WorldViewProjState& aState = theView->Camera()->WorldViewProjState();
+    if (aState == myNavCameraState) return;
+    myNavCameraState = aState;
+
+    // Frames keep coming while the user drags or zooms; the timer fires after the last one
+    myNavigationTimer.start(THE_NAVIGATION_REST_MS);
+    if (!myIsNavigating) {
+        myIsNavigating = true;
+        onNavigationChanged();
+    }
+}
+
+void RenderManager::onNavigationChanged()
+{
+    if (myIsDynamicResolution) {
+        applyRenderResolution();
+        // The final frame at rest is drawn at full resolution and MSAA
+        if (!myIsNavigating) updateView();
+    }
+    if (myIsNavigating) {
+        myRestoreTimer.stop();
+        // Only worth it for a model that cannot keep up at full quality
+        if (myIsDegradationEnabled && myFullFrameMs > frameBudgetMs()) setDegraded(true);
+    } else if (myIsDegraded) {
+        myRestoreTimer.start(THE_DEGRADATION_RESTORE_MS);
+    }
+
+    const bool isActive = myCullingPixels > 0.0 && (myIsNavigating || !myIsCullingWhileMoving);
+    if (isActive == myIsCullingActive) return;
+    applySizeCulling();
+    // At rest the skipped objects come back with the next frame
+    if (!myIsNavigating) updateView();
+}
+
+void RenderManager::applySizeCulling()
+{
+    if (m_viewer->myViewer.IsNull() || m_viewer->myView.IsNull()) return;
+    const bool isActive = myCullingPixels > 0.0 && (myIsNavigating || !myIsCullingWhileMoving);
+    myIsCullingActive = isActive;
+
+    Graphic3d_ZLayerSettings aSettings = m_viewer->myViewer->ZLayerSettings(Graphic3d_ZLayerId_Default);
+    aSettings.SetCullingSize(isActive ? myCullingPixels : Precision::Infinite());
+    m_viewer->myViewer->SetZLayerSettings(Graphic3d_ZLayerId_Default, aSettings);
+
+    // Structure counts on the stats overlay show how many are drawn against the total
+    Graphic3d_RenderingParams& aParams = m_viewer->myView->ChangeRenderingParams();
+    aParams.CollectedStats = Graphic3d_RenderingParams::PerfCounters(
+        isActive ? aParams.CollectedStats | Graphic3d_RenderingParams::PerfCounters_Structures
+                 : aParams.CollectedStats & ~Graphic3d_RenderingParams::PerfCounters_Structures);
+    if (!isActive) myScheduler.setCulled(0);
+}
+
+void RenderManager::setSizeCulling(double thePixels, bool theOnlyWhileMoving)
+{
+    myCullingPixels = thePixels;
+    myIsCullingWhileMoving = theOnlyWhileMoving;
+    applySizeCulling();
+    updateView();
+}
+
+void RenderManager::updateCulledCount(const Handle(V3d_View)& theView)
+{
+    if (!myIsCullingActive || theView.IsNull() || theView->Window().IsNull()) return;
+    try {
+        const Handle(OpenGl_Context) aGlCtx = OcctGlTools::GetGlContext(theView);
+        if (aGlCtx.IsNull() || aGlCtx->FrameStats().IsNull()) return;
+        const Graphic3d_FrameStatsData& aData = aGlCtx->FrameStats()->LastDataFrame();
+        myScheduler.setCulled(int(aData[Graphic3d_FrameStatsCounter_NbStructs]
+                                  - aData[Graphic3d_FrameStatsCounter_NbStructsNotCulled]));
+    } catch (const Standard_Failure&) {
+        // No statistics for this frame
+    }
+}
+
+void RenderManager::setInteractionDegradation(bool theEnabled)
+{
+    myIsDegradationEnabled = theEnabled;
+    if (!theEnabled) setDegraded(false);
+}
+
+void RenderManager::recordFrameTime(double theMs)
+{
+    if (!myIsFullRedraw) return;
+    myIsFullRedraw = false;
+    if (myIsDynamicResolution && myIsNavigating) {
+        // The resolution holds the frame time now; these frames say nothing about full quality
+        adaptRenderResolution(theMs);
+        return;
+    }
+
+    const double aBudgetMs = frameBudgetMs();
+    if (!myIsDegraded) {
+        myFullFrameMs = smoothedFrameTime(myFullFrameMs, theMs);
+        // A model that got heavy in the middle of a navigation
+        if (myIsNavigating && myIsDegradationEnabled && myFullFrameMs > aBudgetMs) setDegraded(true);
+        return;
+    }
+    if (myIsBoxingFarParts) return;
+
+    myDegradedFrameMs = smoothedFrameTime(myDegradedFrameMs, theMs);
+    if (myDegradedFrameMs > aBudgetMs && !myLodShapes.isEmpty()) {
+        Message::SendTrace() << "Degraded frames take " << myDegradedFrameMs << " ms, drawing far parts as boxes";
+        myIsBoxingFarParts = true;
+        myLodCameraState = Graphic3d_WorldViewProjState();
         updateView();
     }
 }
 
+void RenderManager::setDegraded(bool theIsDegraded)
+{
+    if (theIsDegraded == myIsDegraded) return;
+    myIsDegraded = theIsDegraded;
+    myRestoreTimer.stop();
+    // Boxes right away if the coarse meshes were too slow last time
+    myIsBoxingFarParts = theIsDegraded && myDegradedFrameMs > frameBudgetMs();
+    Message::SendTrace() << (theIsDegraded ? "Light representation while navigating, full frames take "
+                                           : "Full quality restored, full frames took ")
+                         << myFullFrameMs << " ms";
+
+    // Transparency is an aspect: changing it costs no recomputation, unlike face boundaries,
+    // which are dropped by the coarse LOD presentations instead
+    if (theIsDegraded) {
+        // Assembly instances draw their prototype's presentation, which holds the aspect
+        std::unordered_set<const Standard_Transient*> aVisited;
+        for (const Handle(AIS_InteractiveObject)& anObject : m_viewer->myDisplayedShapes) {
+            const Handle(AIS_ConnectedInteractive) anInstance = Handle(AIS_ConnectedInteractive)::DownCast(anObject);
+            const Handle(AIS_Shape) aShape = Handle(AIS_Shape)::DownCast(anInstance.IsNull() ? anObject
+                                                                                                : anInstance->ConnectedTo());
+            if (aShape.IsNull() || !aVisited.insert(aShape.get()).second) continue;
+            myFullTransparency.emplace_back(aShape, aShape->Transparency());
+            aShape->SetTransparency(0.0);
+        }
+    } else {
+        for (const auto& aSaved : myFullTransparency) aSaved.first->SetTransparency(aSaved.second);
+        myFullTransparency.clear();
+    }
+    // The next frame picks every LOD part's display mode again
+    myLodCameraState = Graphic3d_WorldViewProjState();
+    updateView();
+}
+
+void RenderManager::setDynamicResolution(bool theEnabled, double theTargetMs)
+{
+    myTargetFrameMs = theTargetMs;
+    if (theEnabled == myIsDynamicResolution || m_viewer->myView.IsNull()) return;
+
+    if (theEnabled) {
+        myFullMsaa = m_viewer->myView->RenderingParams().NbMsaaSamples;
+        myMotionScale = 1.0;
+        myNbFastFrames = 0;
+        myMotionMsaa = myFullMsaa;
+    }
+    myIsDynamicResolution = theEnabled;
+    applyRenderResolution();
+    updateView();
+}
+
+void RenderManager::applyRenderResolution()
+{
+    if (m_viewer->myView.IsNull() || m_viewer->myContext.IsNull()) return;
+    const bool isReduced = myIsDynamicResolution && myIsNavigating;
+    const double aScale = isReduced ? myMotionScale : 1.0;
+    const int aMsaa = isReduced ? myMotionMsaa : myFullMsaa;
+
+    // Rendered into an offscreen buffer of the scaled size and blitted to the window with filtering
+    Graphic3d_RenderingParams& aParams = m_viewer->myView->ChangeRenderingParams();
+    aParams.RenderResolutionScale = float(aScale);
+    aParams.NbMsaaSamples = aMsaa;
+
+    if (!myIsDynamicResolution) {
+        if (!myResolutionLabel.IsNull()) m_viewer->myContext->Remove(myResolutionLabel, Standard_False);
+        myResolutionLabel.Nullify();
+        return;
+    }
+    if (myResolutionLabel.IsNull()) {
+        myResolutionLabel = new AIS_TextLabel();
+        myResolutionLabel->SetColor(Quantity_NOC_WHITE);
+        myResolutionLabel->SetHeight(14);
+        myResolutionLabel->SetZLayer(Graphic3d_ZLayerId_TopOSD);
+        myResolutionLabel->SetTransformPersistence(
+            new Graphic3d_TransformPers(Graphic3d_TMF_2d, Aspect_TOTP_LEFT_LOWER, Graphic3d_Vec2i(20, 20)));
+    }
+    myResolutionLabel->SetText(TCollection_ExtendedString(
+        QString("Render scale %1%, MSAA %2")
+            .arg(qRound(aScale * 100.0))
+            .arg(aMsaa > 0 ? QString("%1x").arg(aMsaa) : QString("off"))
+            .toUtf8().constData(), Standard_True));
+    if (m_viewer->myContext->IsDisplayed(myResolutionLabel)) {
+        m_viewer->myContext->Redisplay(myResolutionLabel, Standard_False);
+    } else {
+        m_viewer->myContext->Display(myResolutionLabel, 0, -1, Standard_False);
+    }
+}
+
+double RenderManager::frameBudgetMs() const
+{
+    // Frame times include the buffer swap: synced to the display, even a light frame takes a whole
+    // refresh interval, and only a missed refresh means the frame was too slow
+    const double aMaxFps = myScheduler.maxAnimationFps();
+    return std::max(myScheduler.refreshIntervalMs(), aMaxFps > 0.0 ? 1000.0 / aMaxFps : 0.0) * THE_REFRESH_MARGIN;
+}
+
+void RenderManager::adaptRenderResolution(double theMs)
+{
+    const double aTargetMs = myTargetFrameMs > 0.0 ? myTargetFrameMs : frameBudgetMs();
+    // A frame never measures below the refresh interval; one that fits it is fast enough
+    const double aFastMs = std::max(aTargetMs * THE_UPSCALE_MARGIN, myScheduler.refreshIntervalMs() * 1.05);
+    myNbFastFrames = theMs < aFastMs ? myNbFastFrames + 1 : 0;
+
+    double aScale = myMotionScale;
+    int aMsaa = myMotionMsaa;
+    if (theMs > aTargetMs) {
+        // MSAA goes first: it multiplies the fill cost at any resolution
+        if (aMsaa > 0) {
+            aMsaa = aMsaa > 2 ? aMsaa / 2 : 0;
+        } else {
+            // Fill cost goes with the pixel count, the square of the scale
+            aScale = std::max(THE_MIN_RENDER_SCALE, aScale * std::max(0.7, std::sqrt(aTargetMs / theMs)));
+        }
+    } else if (myNbFastFrames >= THE_UPSCALE_FRAMES) {
+        // Several in a row, or a model right at the budget would see-saw between two scales
+        myNbFastFrames = 0;
+        if (aScale < 1.0) {
+            aScale = std::min(1.0, aScale * 1.1);
+        } else if (aMsaa < myFullMsaa) {
+            aMsaa = std::min(myFullMsaa, aMsaa > 0 ? aMsaa * 2 : 2);
+        }
+    }
+    if (aScale == myMotionScale && aMsaa == myMotionMsaa) return;
+
+    Message::SendTrace() << "Frame took " << theMs << " ms, render scale " << aScale << ", MSAA " << aMsaa;
+    myMotionScale = aScale;
+    myMotionMsaa = aMsaa;
+    applyRenderResolution();
+}
+
+int RenderManager::degradedDisplayMode(const Handle(LodShape)& theLod, double thePixels) const
+{
+    if (myIsBoxingFarParts && thePixels < THE_DEGRADED_BOX_PIXELS) return THE_BOX_DISPLAY_MODE;
+    return theLod->displayModeOf(theLod->nbLevels() - 1);
+}
+
+void RenderManager::updateLevelsOfDetail(const Handle(V3d_View)& theView)
+{
+    if (myLodShapes.isEmpty() || theView.IsNull() || theView->Window().IsNull()) return;
+
+    const Handle(Graphic3d_Camera)& aCamera = theView->Camera();
+    Standard_Integer aWidth = 0, aHeight = 0;
+    theView->Window()->Size(aWidth, aHeight);
+    if (aCamera->WorldViewProjState() == myLodCameraState && aHeight == myLodViewHeight) return;
+    myLodCameraState = aCamera->WorldViewProjState();
+    myLodViewHeight = aHeight;
+
+    // Presentations of every level stay computed, a switch only changes what is drawn
+    QVector<int> aCounts;
+    int aNbSwitched = 0;
+    for (const Handle(LodShape)& aLod : std::as_const(myLodShapes)) {
+        const double aPixels = aLod->projectedSize(aCamera, aHeight);
+        const int aLevel = aLod->levelForSize(aPixels);
+        if (aCounts.size() <= aLevel) aCounts.resize(aLevel + 1);
+        ++aCounts[aLevel];
+        aLod->setLevel(aLevel);
+
+        // Levels keep following the camera while degraded, so restoring needs no new pass
+        const int aMode = myIsDegraded ? degradedDisplayMode(aLod, aPixels) : aLod->displayModeOf(aLevel);
+        if (aMode == aLod->DisplayMode()) continue;
+        m_viewer->myContext->SetDisplayMode(aLod, aMode, Standard_False);
+        ++aNbSwitched;
+    }
+    if (aNbSwitched > 0) {
+        Message::SendTrace() << "LOD: " << aNbSwitched << " switched, "
+                             << LevelOfDetail::summary(aCounts).toStdString();
+    }
+}
+
+void RenderManager::precomputeLevelsOfDetail()
+{
+    // Computed on first use, a level would cost its whole presentation inside a navigation frame
+    QElapsedTimer aTimer;
+    aTimer.start();
+    const Handle(PrsMgr_PresentationManager)& aPrsMgr = m_viewer->myContext->MainPrsMgr();
+    try {
+        for (; myLodPrecomputed < myLodShapes.size(); ++myLodPrecomputed) {
+            if (aTimer.elapsed() >= THE_LOD_PRECOMPUTE_SLICE_MS) return;
+            const Handle(LodShape)& aLod = myLodShapes.at(myLodPrecomputed);
+            for (int aLevel = 1; aLevel < aLod->nbLevels(); ++aLevel) {
+                // Created hidden; SetDisplayMode() later only shows it
+                aPrsMgr->Presentation(aLod, aLod->displayModeOf(aLevel), Standard_True);
+            }
+        }
+    } catch (const Standard_Failure& e) {
+        // The remaining levels are computed on first use
+        Message::SendWarning() << "LOD presentations not precomputed: " << e.GetMessageString();
+    }
+    myLodPrecomputeTimer.stop();
+    Message::SendTrace() << "LOD presentations of " << myLodShapes.size() << " parts precomputed";
+}
+
 void RenderManager::displayOriginAxis()
 {
     Handle(Geom_Axis1Placement) xAxis = new Geom_Axis1Placement(gp::OX());
@@ -254,58 +630,234 @@ void RenderManager::displayModelOrigin(const gp_Pnt& thePnt)
 
 // ----------------------------------------------
 
-void RenderManager::displayShape(const TopoDS_Shape& theShape)
+void RenderManager::displayShape(const TopoDS_Shape& theShape, CadStageTimings* theStages, bool theToMesh,
+                                 const QVector<LodPart>& theLodParts)
 {
     if (theShape.IsNull()) return;
 
     try {
+        QElapsedTimer aTimer;
+        aTimer.start();
         clearAllShapes();
         m_viewer->myLoadedShape = theShape;
 
-        m_viewer->myMesher = new BRepMesh_IncrementalMesh(theShape, 0.005);
-        if (m_viewer->myMesher->IsDone()) {
-            Message::SendInfo() << "High-quality mesh generated";
+        // Triangulation from the load pipeline or the cache already meets the tolerance
+        if (!theToMesh) {
+            Message::SendInfo() << "Displaying the attached coarse triangulation";
+        } else if (Tessellation::isMeshed(theShape, displayMeshParameters())) {
+            Message::SendInfo() << "Reusing attached triangulation, meshing skipped";
+        } else {
+            aTimer.restart();
+            Tessellation::mesh(theShape, displayMeshParameters());
+            if (theStages != nullptr) theStages->mesh = aTimer.elapsed();
         }
 
+        aTimer.restart();
         m_viewer->m_measurement->extractMeshTopology();
+        if (theStages != nullptr) theStages->topology = aTimer.restart();
 
-        Handle(AIS_Shape) aShapeAIS = new AIS_Shape(theShape);
+        if (myIsLodEnabled && theLodParts.isEmpty()) {
+            // Meshing three levels of every solid here would stall the GUI thread
+            Message::SendInfo() << "No LOD parts from the load pipeline, model drawn at full detail";
+        }
+        if (!theLodParts.isEmpty()) {
+            // Every solid starts at full detail; the first frame picks the levels
+            for (const LodPart& aPart : theLodParts) {
+                Handle(LodShape) aLod = new LodShape(aPart);
+                styleModelPresentation(aLod);
+                m_viewer->myContext->Display(aLod, AIS_Shaded, 0, Standard_False);
+                activateModelSelection(aLod);
+                m_viewer->myDisplayedShapes.append(aLod);
+                myLodShapes.append(aLod);
+            }
+            myLodCameraState = Graphic3d_WorldViewProjState();
+            myLodPrecomputed = 0;
+            myLodPrecomputeTimer.start(0);
+        } else {
+            Handle(AIS_Shape) aShapeAIS = createModelPresentation(theShape);
+            m_viewer->myContext->Display(aShapeAIS, AIS_Shaded, 0, Standard_False);
+            activateModelSelection(aShapeAIS);
+            m_viewer->myDisplayedShapes.append(aShapeAIS);
+        }
+        m_viewer->myContext->UpdateCurrentViewer();
+        if (theStages != nullptr) theStages->display = aTimer.elapsed();
 
-        aShapeAIS->SetColor(Quantity_NOC_LIGHTGRAY);
-        aShapeAIS->SetTransparency(0.25);
-        aShapeAIS->SetMaterial(Graphic3d_NOM_PLASTIC);
+        Message::SendInfo() << "Shape displayed"
+                            << (!myLodShapes.isEmpty() ? QString(" as %1 LOD parts").arg(myLodShapes.size()).toStdString()
+                                               : std::string())
+                            << " - Face/Edge selection enabled";
 
-        Handle(Prs3d_Drawer) aDrawer = aShapeAIS->Attributes();
-        aDrawer->SetFaceBoundaryDraw(Standard_True);
-        aDrawer->SetFaceBoundaryAspect(new Prs3d_LineAspect(Quantity_NOC_BLACK, Aspect_TOL_SOLID, 1.0));
+    } catch (const Standard_Failure& e) {
+        Message::SendFail() << "Display error: " << e.GetMessageString();
+    }
+}
 
-        m_viewer->myContext->Display(aShapeAIS, AIS_Shaded, 0, Standard_False);
-        m_viewer->myContext->Deactivate(aShapeAIS, 0);
-        m_viewer->myContext->Activate(aShapeAIS, 4, Standard_True);
-        m_viewer->myContext->Activate(aShapeAIS, 2, Standard_True);
-        m_viewer->myContext->SetPixelTolerance(5);
-        m_viewer->myDisplayedShapes.append(aShapeAIS);
+Handle(AIS_Shape) RenderManager::createModelPresentation(const TopoDS_Shape& theShape) const
+{
+    Handle(AIS_Shape) aShapeAIS = new AIS_Shape(theShape);
+    styleModelPresentation(aShapeAIS);
+    return aShapeAIS;
+}
+
+void RenderManager::styleModelPresentation(const Handle(AIS_Shape)& theShapeAIS) const
+{
+    theShapeAIS->SetColor(Quantity_NOC_LIGHTGRAY);
+    // Shown while degraded, it stays transparent: only the objects setDegraded() saw change
+    theShapeAIS->SetTransparency(THE_MODEL_TRANSPARENCY);
+    theShapeAIS->SetMaterial(Graphic3d_NOM_PLASTIC);
+
+    Handle(Prs3d_Drawer) aDrawer = theShapeAIS->Attributes();
+    aDrawer->SetFaceBoundaryDraw(Standard_True);
+    aDrawer->SetFaceBoundaryAspect(new Prs3d_LineAspect(Quantity_NOC_BLACK, Aspect_TOL_SOLID, 1.0));
+    // The presentation draws the mesh parameters' triangulation, it never re-meshes on its own
+    aDrawer->SetAutoTriangulation(Standard_False);
+}
+
+void RenderManager::activateModelSelection(const Handle(AIS_InteractiveObject)& theObject)
+{
+    // Faces (4) and edges (2) only, the whole-shape mode would swallow the picks
+    m_viewer->myContext->Deactivate(theObject, 0);
+    m_viewer->myContext->Activate(theObject, 4, Standard_True);
+    m_viewer->myContext->Activate(theObject, 2, Standard_True);
+    m_viewer->myContext->SetPixelTolerance(5);
+}
+
+void RenderManager::displayAssembly(const CadAssembly& theAssembly)
+{
+    if (theAssembly.isEmpty()) return;
+
+    try {
+        clearAllShapes();
+        m_viewer->myLoadedShape = theAssembly.toShape();
+        m_viewer->myCADDocument = theAssembly.document;
+        m_viewer->m_measurement->extractMeshTopology();
+
+        // Prototypes are never displayed themselves; every instance connects to the
+        // prototype presentation, so its triangles exist once on the GPU
+        std::vector<Handle(AIS_Shape)> aPrototypes;
+        aPrototypes.reserve(theAssembly.prototypes.size());
+        for (const CadAssembly::Prototype& aPrototype : theAssembly.prototypes) {
+            aPrototypes.push_back(createModelPresentation(aPrototype.shape));
+        }
+
+        for (const CadAssembly::Instance& anInstance : theAssembly.instances) {
+            Handle(AIS_ConnectedInteractive) anObject = new AIS_ConnectedInteractive();
+            anObject->Connect(aPrototypes[anInstance.prototype], anInstance.location.Transformation());
+            m_viewer->myContext->Display(anObject, AIS_Shaded, 0, Standard_False);
+            activateModelSelection(anObject);
+            m_viewer->myDisplayedShapes.append(anObject);
+        }
         m_viewer->myContext->UpdateCurrentViewer();
 
-        Message::SendInfo() << "Shape displayed - Face/Edge selection enabled";
+        Message::SendInfo() << "Assembly displayed: " << theAssembly.instances.size() << " instances of "
+                            << theAssembly.prototypes.size() << " parts - Face/Edge selection enabled";
 
     } catch (const Standard_Failure& e) {
-        Message::SendFail() << "Display error: " << e.GetMessageString();
+        Message::SendFail() << "Assembly display error: " << e.GetMessageString();
     }
 }
 
-void RenderManager::meshShape(const TopoDS_Shape& theShape, double theDeflection)
+// ----------------------------------------------
+// Streaming display
+// ----------------------------------------------
+
+void RenderManager::beginStreamedDisplay()
+{
+    myStreamedBox.SetVoid();
+}
+
+void RenderManager::appendStreamedShape(const TopoDS_Shape& thePiece)
 {
+    if (thePiece.IsNull() || m_viewer->myContext.IsNull()) return;
+
     try {
-        BRepMesh_IncrementalMesh aMesher(theShape, theDeflection);
-        if (aMesher.IsDone()) {
-            Message::SendInfo() << "Mesh generated with deflection: " << theDeflection;
+        // Not selectable yet: measurements need the topology maps of the whole model
+        Handle(AIS_Shape) aShapeAIS = createModelPresentation(thePiece);
+        m_viewer->myContext->Display(aShapeAIS, AIS_Shaded, -1, Standard_False);
+        m_viewer->myDisplayedShapes.append(aShapeAIS);
+
+        // The camera follows the growing model; the triangulation gives a cheap box
+        BRepBndLib::Add(thePiece, myStreamedBox, Standard_True);
+        if (!myStreamedBox.IsVoid() && !m_viewer->myView.IsNull()) {
+            m_viewer->myView->FitAll(myStreamedBox, 0.01, Standard_False);
         }
+
+        // Coalesced by Qt, so a burst of small roots costs one frame
+        updateView();
+
+    } catch (const Standard_Failure& e) {
+        Message::SendFail() << "Streaming display error: " << e.GetMessageString();
+    }
+}
+
+void RenderManager::finishStreamedDisplay(const TopoDS_Shape& theWholeShape)
+{
+    m_viewer->myLoadedShape = theWholeShape;
+    m_viewer->m_measurement->extractMeshTopology();
+
+    for (const Handle(AIS_InteractiveObject)& aShape : m_viewer->myDisplayedShapes) {
+        activateModelSelection(aShape);
+    }
+    m_viewer->myContext->UpdateCurrentViewer();
+
+    Message::SendInfo() << "Streamed model complete: " << m_viewer->myDisplayedShapes.size()
+                        << " pieces - Face/Edge selection enabled";
+}
+
+void RenderManager::meshShape(const TopoDS_Shape& theShape)
+{
+    try {
+        if (!Tessellation::mesh(theShape, displayMeshParameters())) return;
+        redisplayModel(theShape);
     } catch (const Standard_Failure& aException) {
         Message::SendWarning() << "Mesh Error: " << aException.GetMessageString();
     }
 }
 
+bool RenderManager::applyMeshLevel(const TopoDS_Shape& theShape, const TopoDS_Shape& theLevel)
+{
+    try {
+        // The B-Rep is untouched: picking and measurements keep working across the swap
+        if (!Tessellation::transferTriangulation(theLevel, theShape)) return false;
+        redisplayModel(theShape);
+        return true;
+    } catch (const Standard_Failure& aException) {
+        Message::SendWarning() << "Mesh level not applied: " << aException.GetMessageString();
+        return false;
+    }
+}
+
+bool RenderManager::isModelDisplayed(const TopoDS_Shape& theShape) const
+{
+    if (theShape.IsNull()) return false;
+    if (!myLodShapes.isEmpty()) return m_viewer->myLoadedShape.IsSame(theShape);
+    for (const Handle(AIS_InteractiveObject)& anObject : m_viewer->myDisplayedShapes) {
+        const Handle(AIS_Shape) aShapeAIS = Handle(AIS_Shape)::DownCast(anObject);
+        if (!aShapeAIS.IsNull() && aShapeAIS->Shape().IsSame(theShape)) return true;
+    }
+    return false;
+}
+
+void RenderManager::redisplayModel(const TopoDS_Shape& theShape)
+{
+    for (const Handle(AIS_InteractiveObject)& anObject : m_viewer->myDisplayedShapes) {
+        const Handle(AIS_Shape) aShapeAIS = Handle(AIS_Shape)::DownCast(anObject);
+        // LOD parts are pieces of the model; their coarse levels are separate copies and stay valid
+        const bool isModelPart = !Handle(LodShape)::DownCast(anObject).IsNull()
+                              && m_viewer->myLoadedShape.IsSame(theShape);
+        if (aShapeAIS.IsNull() || (!aShapeAIS->Shape().IsSame(theShape) && !isModelPart)) continue;
+        if (isModelPart) {
+            aShapeAIS->SetToUpdate(AIS_Shaded);
+        } else {
+            aShapeAIS->SetToUpdate();
+        }
+        m_viewer->myContext->Redisplay(aShapeAIS, Standard_False);
+        // Sensitive triangles follow the new mesh, the active face/edge modes stay
+        m_viewer->myContext->RecomputeSelectionOnly(aShapeAIS);
+    }
+    m_viewer->myContext->UpdateCurrentViewer();
+}
+
 void RenderManager::clearAllShapes()
 {
     if (m_viewer->myContext.IsNull()) return;
@@ -315,12 +867,17 @@ void RenderManager::clearAllShapes()
         m_viewer->myContext->ClearSelected(Standard_False);
 
         // 2. Remove all displayed shapes safely
-        for (const Handle(AIS_Shape)& aShape : m_viewer->myDisplayedShapes) {
+        for (const Handle(AIS_InteractiveObject)& aShape : m_viewer->myDisplayedShapes) {
             if (!aShape.IsNull() && m_viewer->myContext->IsDisplayed(aShape)) {
                 m_viewer->myContext->Remove(aShape, Standard_False);
             }
         }
 
+        for (const Handle(AIS_Shape)& aPlaceholder : myPlaceholders) {
+            if (!aPlaceholder.IsNull()) m_viewer->myContext->Remove(aPlaceholder, Standard_False);
+        }
+        myPlaceholders.clear();
+
         // 3. Remove the Origin Visual
         if (!myModelOriginVis.IsNull()) {
             m_viewer->myContext->Remove(myModelOriginVis, Standard_False);
@@ -329,7 +886,14 @@ void RenderManager::clearAllShapes()
 
         // 4. Reset Data Structures
         m_viewer->myDisplayedShapes.clear();
+        myLodShapes.clear();
+        myLodPrecomputeTimer.stop();
+        myFullTransparency.clear();
         m_viewer->myLoadedShape.Nullify();
+        // Per-model caches must not keep the old geometry alive
+        setModelBox(TopoDS_Shape(), Bnd_Box());
+        m_viewer->m_measurement->setModelMassProperties(TopoDS_Shape(), ModelMassProperties());
+        CadAssembly::closeDocument(m_viewer->myCADDocument);
         m_viewer->myCADDocument.Nullify();
 
         // --- FIX: CLEAR FILE PATH ---
@@ -368,12 +932,21 @@ void RenderManager::fitViewToModel()
         return;
     }
 
-    Bnd_Box aBox;
-    BRepBndLib::Add(m_viewer->myLoadedShape, aBox);
+    // Fit the model itself, not the helpers around it; the box is computed once per model
+    if (!myBoxShape.IsSame(m_viewer->myLoadedShape)) {
+        Bnd_Box aBox;
+        BRepBndLib::Add(m_viewer->myLoadedShape, aBox, Standard_True);
+        setModelBox(m_viewer->myLoadedShape, aBox);
+    }
+    if (myModelBox.IsVoid()) return;
 
-    if (aBox.IsVoid()) return;
+    m_viewer->myView->FitAll(myModelBox, 0.01, false);
+}
 
-    m_viewer->myView->FitAll(0.01, false);
+void RenderManager::setModelBox(const TopoDS_Shape& theShape, const Bnd_Box& theBox)
+{
+    myBoxShape = theShape;
+    myModelBox = theBox;
 }
 
 // Add this new function
@@ -395,3 +968,66 @@ void RenderManager::setOriginTrihedronVisible(bool theVisible)
     m_viewer->myContext->UpdateCurrentViewer();
     m_viewer->updateView();
 }
+
+// ----------------------------------------------
+// Lazy assembly placeholders
+// ----------------------------------------------
+
+void RenderManager::displayPlaceholders(const QVector<LazyAssemblyNode>& theNodes)
+{
+    if (m_viewer->myContext.IsNull()) return;
+
+    myPlaceholders.clear();
+    for (const LazyAssemblyNode& aNode : theNodes) {
+        Handle(AIS_Shape) aPlaceholder;
+        if (!aNode.box.IsVoid()) {
+            try {
+                // Flat parts give a degenerate box, which MakeBox refuses
+                Bnd_Box aBox = aNode.box;
+                aBox.Enlarge(1.0e-3);
+                aPlaceholder = new AIS_Shape(BRepPrimAPI_MakeBox(aBox.CornerMin(), aBox.CornerMax()).Shape());
+                aPlaceholder->SetColor(Quantity_NOC_GRAY50);
+                m_viewer->myContext->Display(aPlaceholder, AIS_WireFrame, -1, Standard_False);
+            } catch (const Standard_Failure& e) {
+                Message::SendWarning() << "Placeholder for " << aNode.name.toStdString()
+                                       << " skipped: " << e.GetMessageString();
+                aPlaceholder.Nullify();
+            }
+        }
+        myPlaceholders.append(aPlaceholder);
+    }
+    m_viewer->myContext->UpdateCurrentViewer();
+    Message::SendInfo() << "Displayed " << theNodes.size() << " subassembly placeholders";
+}
+
+void RenderManager::replacePlaceholder(int theIndex, const TopoDS_Shape& theShape)
+{
+    if (m_viewer->myContext.IsNull() || theShape.IsNull()) return;
+
+    try {
+        if (theIndex >= 0 && theIndex < myPlaceholders.size() && !myPlaceholders[theIndex].IsNull()) {
+            m_viewer->myContext->Remove(myPlaceholders[theIndex], Standard_False);
+            myPlaceholders[theIndex].Nullify();
+        }
+
+        Handle(AIS_Shape) aShapeAIS = createModelPresentation(theShape);
+        m_viewer->myContext->Display(aShapeAIS, AIS_Shaded, 0, Standard_False);
+        activateModelSelection(aShapeAIS);
+        m_viewer->myDisplayedShapes.append(aShapeAIS);
+
+        // Measurements see the loaded part of the model only
+        BRep_Builder aBuilder;
+        TopoDS_Compound aCompound;
+        aBuilder.MakeCompound(aCompound);
+        for (const Handle(AIS_InteractiveObject)& anObject : m_viewer->myDisplayedShapes) {
+            Handle(AIS_Shape) aLoaded = Handle(AIS_Shape)::DownCast(anObject);
+            if (!aLoaded.IsNull()) aBuilder.Add(aCompound, aLoaded->Shape());
+        }
+        m_viewer->myLoadedShape = aCompound;
+        m_viewer->m_measurement->extractMeshTopology();
+        m_viewer->myContext->UpdateCurrentViewer();
+
+    } catch (const Standard_Failure& e) {
+        Message::SendFail() << "Display error: " << e.GetMessageString();
+    }
+}
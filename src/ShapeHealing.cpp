@@ -0,0 +1,194 @@
+// ShapeHealing.cpp
+#include "ShapeHealing.h"
+
+#include <BRepBuilderAPI_Copy.hxx>
+#include <BRepTools_ReShape.hxx>
+#include <Message.hxx>
+#include <Message_ProgressScope.hxx>
+#include <OSD_Parallel.hxx>
+#include <ShapeAnalysis_ShapeTolerance.hxx>
+#include <ShapeExtend_Status.hxx>
+#include <ShapeFix_Shape.hxx>
+#include <ShapeUpgrade_ShapeDivideContinuity.hxx>
+#include <Standard_ErrorHandler.hxx>
+#include <Standard_Failure.hxx>
+#include <TopExp.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopLoc_Location.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+
+#include <QElapsedTimer>
+#include <QStringList>
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+    struct HealPart {
+        TopoDS_Shape part;          // unlocated and forward, the key of the substitution
+        int faces = 0;
+        bool isStarted = false;
+        bool isFailed = false;
+        TopoDS_Shape result;        // null = nothing to fix
+        int facesAfter = 0;
+        double toleranceBefore = 0.0;
+        double toleranceAfter = 0.0;
+    };
+
+    int countFaces(const TopoDS_Shape& theShape)
+    {
+        TopTools_IndexedMapOfShape aFaces;
+        TopExp::MapShapes(theShape, TopAbs_FACE, aFaces);
+        return aFaces.Extent();
+    }
+
+    //! Solids, shells outside solids and faces outside shells; instances of one part appear once
+    void collectParts(const TopoDS_Shape& theShape, TopTools_IndexedMapOfShape& theParts)
+    {
+        const auto addParts = [&](TopAbs_ShapeEnum theType, TopAbs_ShapeEnum theAvoid) {
+            for (TopExp_Explorer anExp(theShape, theType, theAvoid); anExp.More(); anExp.Next()) {
+                theParts.Add(anExp.Current().Located(TopLoc_Location()).Oriented(TopAbs_FORWARD));
+            }
+        };
+        addParts(TopAbs_SOLID, TopAbs_SHAPE);
+        addParts(TopAbs_SHELL, TopAbs_SOLID);
+        addParts(TopAbs_FACE, TopAbs_SHELL);
+    }
+
+    void healPart(HealPart& thePart, const Message_ProgressRange& theProgress)
+    {
+        Message_ProgressScope aPS(theProgress, nullptr, 2);
+        thePart.toleranceBefore = ShapeAnalysis_ShapeTolerance().Tolerance(thePart.part, 1);
+
+        // ShapeFix updates tolerances in place, a private copy keeps other threads out
+        const TopoDS_Shape aCopy = BRepBuilderAPI_Copy(thePart.part).Shape();
+        Handle(ShapeFix_Shape) aFix = new ShapeFix_Shape(aCopy);
+        aFix->Perform(aPS.Next());
+        TopoDS_Shape aHealed = aFix->Shape();
+        bool isChanged = aFix->Status(ShapeExtend_DONE);
+        if (aPS.UserBreak()) return;
+
+        // C0 surfaces and curves are what the mesher trips over in broken IGES; split them to C1
+        ShapeUpgrade_ShapeDivideContinuity aDivide(aHealed);
+        aDivide.SetBoundaryCriterion(GeomAbs_C1);
+        aDivide.SetPCurveCriterion(GeomAbs_C1);
+        aDivide.SetSurfaceCriterion(GeomAbs_C1);
+        if (aDivide.Perform() && aDivide.Status(ShapeExtend_DONE)) {
+            aHealed = aDivide.Result();
+            isChanged = true;
+        }
+        aPS.Next();
+
+        if (!isChanged) return;
+        thePart.result = aHealed;
+        thePart.facesAfter = countFaces(aHealed);
+        thePart.toleranceAfter = ShapeAnalysis_ShapeTolerance().Tolerance(aHealed, 1);
+    }
+}
+
+QString ShapeHealReport::summary() const
+{
+    if (fromCache) return "Healed shape from model cache";
+
+    QStringList aParts;
+    aParts << QString("%1 of %2 parts healed").arg(healedParts).arg(parts);
+    if (healedParts > 0) {
+        QStringList aKinds;
+        if (fixedSolids > 0) aKinds << QString("%1 solids").arg(fixedSolids);
+        if (fixedShells > 0) aKinds << QString("%1 shells").arg(fixedShells);
+        if (fixedFaces > 0) aKinds << QString("%1 faces").arg(fixedFaces);
+        aParts.last() += " (" + aKinds.join(", ") + ")";
+    }
+    if (facesAfter != facesBefore) {
+        aParts << QString("faces %1 -> %2").arg(facesBefore).arg(facesAfter);
+    }
+    if (maxToleranceAfter != maxToleranceBefore) {
+        aParts << QString("max tolerance %1 -> %2").arg(maxToleranceBefore, 0, 'g', 3)
+                                                   .arg(maxToleranceAfter, 0, 'g', 3);
+    }
+    if (skippedParts > 0) aParts << QString("%1 left as read (time budget)").arg(skippedParts);
+    if (failedParts > 0) aParts << QString("%1 failed").arg(failedParts);
+    aParts << QString("%1 ms").arg(elapsedMs);
+    return aParts.join(", ");
+}
+
+TopoDS_Shape ShapeHealing::heal(const TopoDS_Shape& theShape, qint64 theTimeBudgetMs,
+                                const Message_ProgressRange& theProgress, ShapeHealReport& theReport)
+{
+    theReport = ShapeHealReport();
+    if (theShape.IsNull()) return theShape;
+
+    QElapsedTimer aTimer;
+    aTimer.start();
+
+    TopTools_IndexedMapOfShape aPartMap;
+    collectParts(theShape, aPartMap);
+    std::vector<HealPart> aParts(aPartMap.Extent());
+    for (int anIdx = 0; anIdx < aPartMap.Extent(); ++anIdx) {
+        aParts[anIdx].part = aPartMap(anIdx + 1);
+        aParts[anIdx].faces = countFaces(aParts[anIdx].part);
+    }
+    // Largest first: they bound the wall time, and a budget should go to the parts that matter
+    std::stable_sort(aParts.begin(), aParts.end(),
+                     [](const HealPart& a, const HealPart& b) { return a.faces > b.faces; });
+    theReport.parts = int(aParts.size());
+    if (aParts.empty()) return theShape;
+
+    // Ranges must be created up-front to be used from several threads
+    Message_ProgressScope aPS(theProgress, "Healing shapes", double(aParts.size()));
+    std::vector<Message_ProgressRange> aRanges;
+    aRanges.reserve(aParts.size());
+    for (size_t anIdx = 0; anIdx < aParts.size(); ++anIdx) {
+        aRanges.push_back(aPS.Next());
+    }
+
+    OSD_Parallel::For(0, int(aParts.size()), [&](int theIndex) {
+        HealPart& aPart = aParts[theIndex];
+        if (aRanges[theIndex].UserBreak()) return;
+        if (theTimeBudgetMs > 0 && aTimer.elapsed() > theTimeBudgetMs) return;
+
+        aPart.isStarted = true;
+        try {
+            OCC_CATCH_SIGNALS
+            healPart(aPart, aRanges[theIndex]);
+        } catch (const Standard_Failure&) {
+            // Reported below, the part stays as read
+            aPart.isFailed = true;
+            aPart.result.Nullify();
+        }
+    });
+    if (aPS.UserBreak()) return TopoDS_Shape();
+
+    Handle(BRepTools_ReShape) aReShape = new BRepTools_ReShape();
+    for (const HealPart& aPart : aParts) {
+        theReport.facesBefore += aPart.faces;
+        if (!aPart.isStarted || aPart.isFailed || aPart.result.IsNull()) {
+            theReport.facesAfter += aPart.faces;
+            if (!aPart.isStarted) ++theReport.skippedParts;
+            if (aPart.isFailed) ++theReport.failedParts;
+            if (aPart.isStarted && !aPart.isFailed) {
+                theReport.maxToleranceBefore = std::max(theReport.maxToleranceBefore, aPart.toleranceBefore);
+                theReport.maxToleranceAfter = std::max(theReport.maxToleranceAfter, aPart.toleranceBefore);
+            }
+            continue;
+        }
+
+        ++theReport.healedParts;
+        switch (aPart.part.ShapeType()) {
+        case TopAbs_SOLID: ++theReport.fixedSolids; break;
+        case TopAbs_SHELL: ++theReport.fixedShells; break;
+        default:           ++theReport.fixedFaces; break;
+        }
+        theReport.facesAfter += aPart.facesAfter;
+        theReport.maxToleranceBefore = std::max(theReport.maxToleranceBefore, aPart.toleranceBefore);
+        theReport.maxToleranceAfter = std::max(theReport.maxToleranceAfter, aPart.toleranceAfter);
+        // Every placed instance of the part picks up the healed version
+        aReShape->Replace(aPart.part, aPart.result);
+    }
+
+    const TopoDS_Shape aResult = theReport.healedParts > 0 ? aReShape->Apply(theShape) : theShape;
+    theReport.elapsedMs = aTimer.elapsed();
+    Message::SendInfo() << "Shape healing: " << theReport.summary().toStdString();
+    return aResult;
+}
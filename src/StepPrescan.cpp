@@ -0,0 +1,247 @@
+// StepPrescan.cpp
+#include "StepPrescan.h"
+
+#include <Message.hxx>
+
+#include <QElapsedTimer>
+#include <QFile>
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include <unordered_map>
+
+namespace
+{
+    inline bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+
+    inline bool isIdentChar(char c)
+    {
+        return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_';
+    }
+
+    //! Skip whitespace and /* comments */
+    const char* skipBlank(const char* p, const char* theEnd)
+    {
+        while (p < theEnd) {
+            if (isSpace(*p)) {
+                ++p;
+            } else if (*p == '/' && p + 1 < theEnd && p[1] == '*') {
+                for (p += 2; p + 1 < theEnd && !(p[0] == '*' && p[1] == '/'); ++p) {}
+                p += 2;
+            } else {
+                break;
+            }
+        }
+        return std::min(p, theEnd);
+    }
+
+    std::string_view identifierAt(const char* p, const char* theEnd)
+    {
+        const char* aStart = p;
+        while (p < theEnd && isIdentChar(*p)) ++p;
+        return std::string_view(aStart, size_t(p - aStart));
+    }
+
+    bool startsWith(const char* p, const char* theEnd, const char* thePrefix)
+    {
+        const size_t aLen = std::strlen(thePrefix);
+        return size_t(theEnd - p) >= aLen && std::memcmp(p, thePrefix, aLen) == 0;
+    }
+
+    bool contains(const char* theBegin, const char* theEnd, const char* theText)
+    {
+        const std::string_view aHay(theBegin, size_t(theEnd - theBegin));
+        return aHay.find(theText) != std::string_view::npos;
+    }
+
+    //! Quoted strings of a statement in order, '' unescaped
+    QStringList quotedStrings(const char* p, const char* theEnd, int theMax)
+    {
+        QStringList aList;
+        for (; p < theEnd && aList.size() < theMax; ++p) {
+            if (*p != '\'') continue;
+            QByteArray aValue;
+            for (++p; p < theEnd; ++p) {
+                if (*p == '\'') {
+                    if (p + 1 < theEnd && p[1] == '\'') { aValue += '\''; ++p; continue; }
+                    break;
+                }
+                aValue += *p;
+            }
+            aList << QString::fromUtf8(aValue);
+        }
+        return aList;
+    }
+
+    QString siLengthUnit(const char* theBegin, const char* theEnd)
+    {
+        static const struct { const char* Prefix; const char* Symbol; } THE_PREFIXES[] = {
+            { ".MILLI.", "mm" }, { ".CENTI.", "cm" }, { ".DECI.", "dm" },
+            { ".MICRO.", "um" }, { ".KILO.", "km" }
+        };
+        for (const auto& aPrefix : THE_PREFIXES) {
+            if (contains(theBegin, theEnd, aPrefix.Prefix)) return aPrefix.Symbol;
+        }
+        return "m";
+    }
+}
+
+qint64 StepPrescanResult::faceCount() const
+{
+    return typeHistogram.value("ADVANCED_FACE") + typeHistogram.value("FACE_SURFACE");
+}
+
+QVector<QPair<QString, qint64>> StepPrescanResult::topTypes(int theCount) const
+{
+    QVector<QPair<QString, qint64>> aTypes;
+    aTypes.reserve(typeHistogram.size());
+    for (auto anIter = typeHistogram.cbegin(); anIter != typeHistogram.cend(); ++anIter) {
+        aTypes.append(qMakePair(anIter.key(), anIter.value()));
+    }
+    std::sort(aTypes.begin(), aTypes.end(),
+              [](const QPair<QString, qint64>& a, const QPair<QString, qint64>& b) { return a.second > b.second; });
+    if (aTypes.size() > theCount) aTypes.resize(theCount);
+    return aTypes;
+}
+
+StepPrescanResult StepPrescan::scan(const QString& theFilePath)
+{
+    StepPrescanResult aResult;
+    aResult.filePath = theFilePath;
+    QElapsedTimer aTimer;
+    aTimer.start();
+
+    QFile aFile(theFilePath);
+    if (!aFile.open(QIODevice::ReadOnly) || aFile.size() == 0) return aResult;
+
+    aResult.fileSize = aFile.size();
+    uchar* aMapped = aFile.map(0, aResult.fileSize);
+    if (aMapped == nullptr) {
+        Message::SendWarning() << "STEP pre-scan: cannot map " << theFilePath.toStdString();
+        return aResult;
+    }
+
+    const char* const aData = reinterpret_cast<const char*>(aMapped);
+    const char* const anEnd = aData + aResult.fileSize;
+
+    enum Section { Section_None, Section_Header, Section_Data, Section_Done };
+    Section aSection = Section_None;
+
+    // Keys point into the mapping, no allocation per entity
+    std::unordered_map<std::string_view, qint64> aHistogram;
+    QStringList aUnits;
+
+    auto processStatement = [&](const char* theBegin, const char* theStmtEnd) {
+        const char* p = skipBlank(theBegin, theStmtEnd);
+        if (p >= theStmtEnd) return;
+
+        if (*p != '#') {
+            const std::string_view aKeyword = identifierAt(p, theStmtEnd);
+            if (aKeyword == "HEADER") {
+                aSection = Section_Header;
+            } else if (aKeyword == "DATA") {
+                aSection = Section_Data;
+            } else if (aKeyword == "ENDSEC") {
+                aSection = (aSection == Section_Data) ? Section_Done : Section_None;
+            } else if (aSection == Section_Header && aKeyword == "FILE_SCHEMA") {
+                const QStringList aStrings = quotedStrings(p, theStmtEnd, 1);
+                if (!aStrings.isEmpty()) aResult.schema = aStrings.first();
+            } else if (aSection == Section_Header && aKeyword == "FILE_NAME") {
+                // (name, time_stamp, (author), (organization), preprocessor, originating_system, authorization)
+                const QStringList aStrings = quotedStrings(p, theStmtEnd, 64);
+                if (aStrings.size() >= 2) aResult.originatingSystem = aStrings.at(aStrings.size() - 2);
+            }
+            return;
+        }
+        if (aSection != Section_Data) return;
+
+        // #123 = TYPE(...)  or  #123 = ( TYPE_A(...) TYPE_B(...) )
+        while (p < theStmtEnd && *p != '=') ++p;
+        p = skipBlank(p + 1, theStmtEnd);
+        if (p >= theStmtEnd) return;
+        ++aResult.entityCount;
+
+        if (*p != '(') {
+            const std::string_view aType = identifierAt(p, theStmtEnd);
+            ++aHistogram[aType];
+            if (aType == "PRODUCT") {
+                ++aResult.productCount;
+                if (aResult.productNames.size() < MaxProductNames) {
+                    const QStringList aStrings = quotedStrings(p, theStmtEnd, 2);
+                    if (aStrings.size() == 2 && !aStrings.at(1).isEmpty()) {
+                        aResult.productNames << aStrings.at(1);
+                    } else if (!aStrings.isEmpty()) {
+                        aResult.productNames << aStrings.first();
+                    }
+                }
+            }
+            return;
+        }
+
+        // Complex instance: collect the type names at depth one
+        bool isLengthUnit = false, isSiUnit = false, isConversionUnit = false;
+        int aDepth = 0;
+        for (; p < theStmtEnd; ++p) {
+            if (*p == '\'') {
+                for (++p; p < theStmtEnd && *p != '\''; ++p) {}
+            } else if (*p == '(') {
+                ++aDepth;
+            } else if (*p == ')') {
+                --aDepth;
+            } else if (aDepth == 1 && isIdentChar(*p)) {
+                const std::string_view aType = identifierAt(p, theStmtEnd);
+                ++aHistogram[aType];
+                isLengthUnit     |= (aType == "LENGTH_UNIT");
+                isSiUnit         |= (aType == "SI_UNIT");
+                isConversionUnit |= (aType == "CONVERSION_BASED_UNIT");
+                p += aType.size() - 1;
+            }
+        }
+
+        if (isLengthUnit) {
+            QString aUnit;
+            if (isConversionUnit) {
+                const QStringList aStrings = quotedStrings(theBegin, theStmtEnd, 1);
+                if (!aStrings.isEmpty()) aUnit = aStrings.first();
+            } else if (isSiUnit) {
+                aUnit = siLengthUnit(theBegin, theStmtEnd);
+            }
+            if (!aUnit.isEmpty() && !aUnits.contains(aUnit)) aUnits << aUnit;
+        }
+    };
+
+    // Statement boundaries: ';' outside of strings and comments
+    const char* aStmt = aData;
+    bool isInString = false;
+    for (const char* p = aData; p < anEnd && aSection != Section_Done; ++p) {
+        const char c = *p;
+        if (isInString) {
+            // '' toggles twice and stays inside the string
+            if (c == '\'') isInString = false;
+        } else if (c == '\'') {
+            isInString = true;
+        } else if (c == '/' && p + 1 < anEnd && p[1] == '*') {
+            for (p += 2; p + 1 < anEnd && !(p[0] == '*' && p[1] == '/'); ++p) {}
+            ++p;
+        } else if (c == ';') {
+            processStatement(aStmt, p);
+            aStmt = p + 1;
+        }
+    }
+
+    for (const auto& aPair : aHistogram) {
+        aResult.typeHistogram.insert(QString::fromLatin1(aPair.first.data(), int(aPair.first.size())),
+                                     aPair.second);
+    }
+    aFile.unmap(aMapped);
+
+    aResult.lengthUnits = aUnits.join(", ");
+    aResult.isValid = startsWith(skipBlank(aData, anEnd), anEnd, "ISO-10303-21") && aResult.entityCount > 0;
+    aResult.scanMs = aTimer.elapsed();
+
+    Message::SendInfo() << "STEP pre-scan: " << aResult.entityCount << " entities, "
+                        << aResult.productCount << " products, schema " << aResult.schema.toStdString()
+                        << " in " << aResult.scanMs << " ms";
+    return aResult;
+}
@@ -0,0 +1,455 @@
+// Tessellation.cpp
+#include "Tessellation.h"
+
+#include <BRepAdaptor_Surface.hxx>
+#include <BRepBndLib.hxx>
+#include <BRepBuilderAPI_Copy.hxx>
+#include <BRepLProp_SLProps.hxx>
+#include <BRepMesh_IncrementalMesh.hxx>
+#include <BRepTools.hxx>
+#include <BRep_Builder.hxx>
+#include <BRep_Tool.hxx>
+#include <IMeshTools_Parameters.hxx>
+#include <Message.hxx>
+#include <OSD_Parallel.hxx>
+#include <OSD_ThreadPool.hxx>
+#include <Poly_PolygonOnTriangulation.hxx>
+#include <Poly_Triangulation.hxx>
+#include <Precision.hxx>
+#include <Standard_ErrorHandler.hxx>
+#include <Standard_Failure.hxx>
+#include <TopExp.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <TopTools_MapOfShape.hxx>
+
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+    //! Floor for relative deflections, keeps flat or point-like boxes from asking for a dense mesh
+    const double THE_MIN_DEFLECTION = 1.0e-4;
+
+    //! Triangle budget: the sample mesh, relative to the model box, and the range of the fit
+    const double THE_SAMPLE_FRACTION = 0.005;
+    const double THE_SAMPLE_ANGLE = 0.5;
+    const double THE_MIN_BUDGET_FRACTION = 1.0e-5;
+    const double THE_MAX_BUDGET_FRACTION = 0.05;
+    const double THE_MIN_BUDGET_ANGLE = 0.05;
+    //! Curved faces meshed with fewer triangles than this in the sample are estimated from geometry
+    const qint64 THE_MIN_SAMPLE_TRIANGLES = 8;
+
+    //! Geometry only: the box must not change once the shape carries a triangulation
+    Bnd_Box geometryBox(const TopoDS_Shape& theShape)
+    {
+        Bnd_Box aBox;
+        BRepBndLib::Add(theShape, aBox, Standard_False);
+        return aBox;
+    }
+
+    double boxDeflection(const Bnd_Box& theBox, double theFraction)
+    {
+        if (theBox.IsVoid()) return THE_MIN_DEFLECTION;
+        return std::max(std::sqrt(theBox.SquareExtent()) * theFraction, THE_MIN_DEFLECTION);
+    }
+
+    //! Unique solids, shells outside solids and faces outside shells, without placement.
+    //! Returns false if two parts share an edge and so cannot be meshed concurrently.
+    bool collectParts(const TopoDS_Shape& theShape, std::vector<TopoDS_Shape>& theParts)
+    {
+        TopTools_IndexedMapOfShape aPartMap;
+        const auto addParts = [&](TopAbs_ShapeEnum theType, TopAbs_ShapeEnum theAvoid) {
+            for (TopExp_Explorer anExp(theShape, theType, theAvoid); anExp.More(); anExp.Next()) {
+                aPartMap.Add(anExp.Current().Located(TopLoc_Location()).Oriented(TopAbs_FORWARD));
+            }
+        };
+        addParts(TopAbs_SOLID, TopAbs_SHAPE);
+        addParts(TopAbs_SHELL, TopAbs_SOLID);
+        addParts(TopAbs_FACE, TopAbs_SHELL);
+
+        bool isDisjoint = true;
+        TopTools_MapOfShape anEdges;
+        theParts.reserve(aPartMap.Extent());
+        for (int anIdx = 1; anIdx <= aPartMap.Extent(); ++anIdx) {
+            theParts.push_back(aPartMap(anIdx));
+            if (!isDisjoint) continue;
+
+            TopTools_IndexedMapOfShape aPartEdges;
+            TopExp::MapShapes(aPartMap(anIdx), TopAbs_EDGE, aPartEdges);
+            for (int anEdge = 1; anEdge <= aPartEdges.Extent() && isDisjoint; ++anEdge) {
+                // Polygons live on the edge itself, whatever placement it is used with
+                isDisjoint = anEdges.Add(aPartEdges(anEdge).Located(TopLoc_Location()));
+            }
+        }
+        return isDisjoint;
+    }
+
+    double triangulationArea(const Handle(Poly_Triangulation)& theTri)
+    {
+        double anArea = 0.0;
+        for (int anIdx = 1; anIdx <= theTri->NbTriangles(); ++anIdx) {
+            int aNode1 = 0, aNode2 = 0, aNode3 = 0;
+            theTri->Triangle(anIdx).Get(aNode1, aNode2, aNode3);
+            const gp_Pnt aP1 = theTri->Node(aNode1);
+            const gp_Vec aSide1(aP1, theTri->Node(aNode2));
+            const gp_Vec aSide2(aP1, theTri->Node(aNode3));
+            anArea += 0.5 * aSide1.Crossed(aSide2).Magnitude();
+        }
+        return anArea;
+    }
+
+    //! Largest principal curvature in the middle of the face's parameter range, 0 if undefined
+    double faceCurvature(const TopoDS_Face& theFace)
+    {
+        Standard_Real aUMin = 0.0, aUMax = 0.0, aVMin = 0.0, aVMax = 0.0;
+        BRepTools::UVBounds(theFace, aUMin, aUMax, aVMin, aVMax);
+        const BRepAdaptor_Surface aSurface(theFace, Standard_False);
+        BRepLProp_SLProps aProps(aSurface, 0.5 * (aUMin + aUMax), 0.5 * (aVMin + aVMax), 2, Precision::Confusion());
+        if (!aProps.IsCurvatureDefined()) return 0.0;
+        return std::max(std::abs(aProps.MaxCurvature()), std::abs(aProps.MinCurvature()));
+    }
+
+    bool meshPart(const TopoDS_Shape& thePart, double theDeflection, double theAngle, bool theInParallel)
+    {
+        IMeshTools_Parameters aParams;
+        aParams.Deflection = theDeflection;
+        aParams.Angle = theAngle;
+        aParams.InParallel = theInParallel;
+        BRepMesh_IncrementalMesh aMesher(thePart, aParams);
+        return aMesher.IsDone();
+    }
+}
+
+MeshParameters MeshParameters::resolvedFor(const Bnd_Box& theModelBox) const
+{
+    MeshParameters aParams = *this;
+    if (mode == ModelRelative && !theModelBox.IsVoid()) {
+        aParams.mode = AbsoluteDeflection;
+        aParams.deflection = boxDeflection(theModelBox, deflection);
+    }
+    return aParams;
+}
+
+MeshParameters MeshParameters::coarsened(double theFactor) const
+{
+    MeshParameters aParams = *this;
+    if (mode == TriangleBudget) {
+        aParams.triangleBudget = std::max(qint64(triangleBudget / theFactor), qint64(1));
+        return aParams;
+    }
+    aParams.deflection = deflection * theFactor;
+    if (theFactor > 1.0) {
+        aParams.angle = std::max(angle, std::min(angle * 2.0, 1.0));
+    } else if (theFactor < 1.0) {
+        aParams.angle = angle * std::sqrt(theFactor);
+    }
+    return aParams;
+}
+
+QString MeshParameters::levelKey() const
+{
+    if (mode == TriangleBudget) return QString("b%1").arg(triangleBudget);
+    const char aMode = mode == AbsoluteDeflection ? 'a' : (mode == ModelRelative ? 'm' : 's');
+    return QString("%1%2-%3").arg(aMode).arg(deflection, 0, 'g', 6).arg(angle, 0, 'g', 6);
+}
+
+QString MeshParameters::summary() const
+{
+    if (mode == TriangleBudget) {
+        return QString("budget %1 triangles, %2")
+            .arg(triangleBudget)
+            .arg(threads > 0 ? QString("%1 threads").arg(threads) : QString("all cores"));
+    }
+    const QString aMode = mode == AbsoluteDeflection ? "absolute"
+                        : (mode == ModelRelative ? "model-relative" : "solid-relative");
+    return QString("%1 deflection %2, angle %3, %4")
+        .arg(aMode)
+        .arg(deflection, 0, 'g', 4)
+        .arg(angle, 0, 'g', 3)
+        .arg(threads > 0 ? QString("%1 threads").arg(threads) : QString("all cores"));
+}
+
+QString MeshRunStats::summary() const
+{
+    const QString aDeflection = minDeflection == maxDeflection
+        ? QString::number(minDeflection, 'g', 4)
+        : QString("%1-%2").arg(minDeflection, 0, 'g', 4).arg(maxDeflection, 0, 'g', 4);
+    return QString("%1 triangles, %2 parts, deflection %3, %4 threads, %5 ms")
+        .arg(triangles).arg(parts).arg(aDeflection).arg(threads).arg(elapsedMs);
+}
+
+bool Tessellation::mesh(const TopoDS_Shape& theShape, const MeshParameters& theParams)
+{
+    MeshRunStats aStats;
+    return mesh(theShape, theParams, aStats);
+}
+
+QString MeshBudgetFit::summary() const
+{
+    return QString("budget %1, sample %2 triangles at %3 (%4 fixed, %5 curved faces), "
+                   "deflection %6, angle %7, estimated %8 triangles, %9 ms")
+        .arg(budget).arg(sampleTriangles).arg(sampleDeflection, 0, 'g', 4)
+        .arg(fixedTriangles).arg(curvedFaces)
+        .arg(deflection, 0, 'g', 4).arg(angle, 0, 'g', 3)
+        .arg(estimatedTriangles).arg(elapsedMs);
+}
+
+bool Tessellation::mesh(const TopoDS_Shape& theShape, const MeshParameters& theParams, MeshRunStats& theStats)
+{
+    theStats = MeshRunStats();
+    if (theShape.IsNull()) return false;
+
+    if (theParams.mode == MeshParameters::TriangleBudget) {
+        MeshBudgetFit aFit;
+        const MeshParameters aFitted = fitToBudget(theShape, theParams, aFit);
+        const bool isDone = mesh(theShape, aFitted, theStats);
+        Message::SendInfo() << "Triangle budget " << theParams.triangleBudget << ": " << theStats.triangles
+                            << " triangles (estimated " << aFit.estimatedTriangles << ")";
+        return isDone;
+    }
+
+    QElapsedTimer aTimer;
+    aTimer.start();
+
+    std::vector<TopoDS_Shape> aParts;
+    const bool isDisjoint = collectParts(theShape, aParts);
+    const bool isPerSolid = theParams.mode == MeshParameters::SolidRelative;
+    const int aNbCores = OSD_Parallel::NbLogicalProcessors();
+    const bool isSerial = theParams.threads == 1;
+    // BRepMesh's face-parallel mode uses the whole default pool, whatever the configured cap
+    theStats.threads = isSerial ? 1 : aNbCores;
+
+    bool isDone = true;
+    if (!isPerSolid && (aParts.size() <= 1 || !isDisjoint || isSerial)) {
+        // One mesher over the whole shape, faces in parallel inside BRepMesh
+        const double aDeflection = absoluteDeflection(theShape, theParams);
+        isDone = meshPart(theShape, aDeflection, theParams.angle, !isSerial);
+        theStats.parts = 1;
+        theStats.minDeflection = theStats.maxDeflection = aDeflection;
+    } else {
+        std::vector<double> aDeflections(aParts.size());
+        const double aModelDeflection = isPerSolid ? 0.0 : absoluteDeflection(theShape, theParams);
+        for (size_t anIdx = 0; anIdx < aParts.size(); ++anIdx) {
+            aDeflections[anIdx] = isPerSolid ? boxDeflection(geometryBox(aParts[anIdx]), theParams.deflection)
+                                             : aModelDeflection;
+        }
+
+        std::vector<char> aPartDone(aParts.size(), 0);
+        if (!isDisjoint || isSerial || aParts.size() == 1) {
+            for (size_t anIdx = 0; anIdx < aParts.size(); ++anIdx) {
+                aPartDone[anIdx] = meshPart(aParts[anIdx], aDeflections[anIdx], theParams.angle, !isSerial);
+            }
+        } else {
+            // Parts share nothing, so each one is meshed single-threaded on a capped launcher
+            theStats.threads = theParams.threads > 0 ? std::min(theParams.threads, aNbCores) : aNbCores;
+            OSD_ThreadPool::Launcher aLauncher(*OSD_ThreadPool::DefaultPool(), theStats.threads);
+            aLauncher.Perform(0, int(aParts.size()), [&](int, int theIndex) {
+                try {
+                    OCC_CATCH_SIGNALS
+                    aPartDone[theIndex] = meshPart(aParts[theIndex], aDeflections[theIndex], theParams.angle, false);
+                } catch (const Standard_Failure&) {
+                    // Counted below, the remaining parts keep going
+                }
+            });
+        }
+
+        theStats.parts = int(aParts.size());
+        const int aNbFailed = int(std::count(aPartDone.begin(), aPartDone.end(), 0));
+        if (aNbFailed > 0) {
+            Message::SendWarning() << "Meshing failed for " << aNbFailed << " of " << aParts.size() << " parts";
+            isDone = false;
+        }
+        if (!aDeflections.empty()) {
+            const auto aRange = std::minmax_element(aDeflections.begin(), aDeflections.end());
+            theStats.minDeflection = *aRange.first;
+            theStats.maxDeflection = *aRange.second;
+        }
+    }
+
+    theStats.triangles = countTriangles(theShape);
+    theStats.elapsedMs = aTimer.elapsed();
+    Message::SendInfo() << "Mesh: " << theStats.summary().toStdString()
+                        << " (" << theParams.summary().toStdString() << ")";
+    return isDone;
+}
+
+bool Tessellation::isMeshed(const TopoDS_Shape& theShape, const MeshParameters& theParams)
+{
+    if (theShape.IsNull()) return false;
+    // The fitted deflection is not known without a new sample; any complete triangulation will do
+    if (theParams.mode == MeshParameters::TriangleBudget) return BRepTools::Triangulation(theShape, RealLast());
+    if (theParams.mode != MeshParameters::SolidRelative) {
+        return BRepTools::Triangulation(theShape, absoluteDeflection(theShape, theParams));
+    }
+
+    std::vector<TopoDS_Shape> aParts;
+    collectParts(theShape, aParts);
+    for (const TopoDS_Shape& aPart : aParts) {
+        if (!BRepTools::Triangulation(aPart, boxDeflection(geometryBox(aPart), theParams.deflection))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+double Tessellation::absoluteDeflection(const TopoDS_Shape& theShape, const MeshParameters& theParams)
+{
+    if (theParams.mode == MeshParameters::AbsoluteDeflection) return theParams.deflection;
+    return boxDeflection(geometryBox(theShape), theParams.deflection);
+}
+
+MeshParameters Tessellation::resolve(const TopoDS_Shape& theShape, const MeshParameters& theParams)
+{
+    if (theParams.mode == MeshParameters::TriangleBudget) {
+        MeshBudgetFit aFit;
+        return fitToBudget(theShape, theParams, aFit);
+    }
+    return theParams.resolvedFor(geometryBox(theShape));
+}
+
+MeshParameters Tessellation::fitToBudget(const TopoDS_Shape& theShape, const MeshParameters& theParams,
+                                         MeshBudgetFit& theFit)
+{
+    QElapsedTimer aTimer;
+    aTimer.start();
+
+    theFit = MeshBudgetFit();
+    theFit.budget = std::max(theParams.triangleBudget, qint64(1));
+
+    const Bnd_Box aBox = geometryBox(theShape);
+    MeshParameters aSample = theParams;
+    aSample.mode = MeshParameters::AbsoluteDeflection;
+    aSample.deflection = boxDeflection(aBox, THE_SAMPLE_FRACTION);
+    aSample.angle = THE_SAMPLE_ANGLE;
+    theFit.sampleDeflection = aSample.deflection;
+
+    // On a copy: theShape keeps whatever triangulation it has until the real run
+    const TopoDS_Shape aCopy = BRepBuilderAPI_Copy(theShape, Standard_False, Standard_False).Shape();
+    MeshRunStats aSampleStats;
+    mesh(aCopy, aSample, aSampleStats);
+    theFit.sampleTriangles = aSampleStats.triangles;
+
+    // Triangles of a curved face at deflection d: about aScaled / d. Placed faces, so an
+    // instanced part is charged once per instance, as countTriangles() does.
+    TopTools_IndexedMapOfShape aFaces;
+    TopExp::MapShapes(aCopy, TopAbs_FACE, aFaces);
+    double aScaled = 0.0;
+    for (int anIdx = 1; anIdx <= aFaces.Extent(); ++anIdx) {
+        const TopoDS_Face& aFace = TopoDS::Face(aFaces(anIdx));
+        TopLoc_Location aLoc;
+        const Handle(Poly_Triangulation) aTri = BRep_Tool::Triangulation(aFace, aLoc);
+        const qint64 aNbTriangles = aTri.IsNull() ? 0 : aTri->NbTriangles();
+
+        const BRepAdaptor_Surface aSurface(aFace, Standard_False);
+        if (aSurface.GetType() == GeomAbs_Plane) {
+            theFit.fixedTriangles += aNbTriangles;
+            continue;
+        }
+
+        ++theFit.curvedFaces;
+        double aCost = double(aNbTriangles) * aSample.deflection;
+        if (aNbTriangles < THE_MIN_SAMPLE_TRIANGLES && !aTri.IsNull()) {
+            // Too few triangles to extrapolate from: chords of length sqrt(8 d / k) on area A
+            // make about A k / (4 d) triangles
+            aCost = std::max(aCost, triangulationArea(aTri) * faceCurvature(aFace) / 4.0);
+        }
+        aScaled += aCost;
+    }
+
+    // Planar faces take their share first; what is left goes to the curved ones
+    const double aMinDeflection = boxDeflection(aBox, THE_MIN_BUDGET_FRACTION);
+    const double aMaxDeflection = boxDeflection(aBox, THE_MAX_BUDGET_FRACTION);
+    const double aLeft = double(theFit.budget - theFit.fixedTriangles);
+    double aDeflection = aMaxDeflection;
+    if (aScaled <= 0.0) {
+        aDeflection = aSample.deflection;
+    } else if (aLeft > 0.0) {
+        aDeflection = std::min(std::max(aScaled / aLeft, aMinDeflection), aMaxDeflection);
+    } else {
+        Message::SendWarning() << "Triangle budget " << theFit.budget << " is below the "
+                               << theFit.fixedTriangles << " triangles of the planar faces alone";
+    }
+
+    // Segments per radian grow as 1 / sqrt(d) under the chord criterion; the angle keeps pace
+    // so neither criterion alone decides the count
+    const double anAngle = std::min(std::max(THE_SAMPLE_ANGLE * std::sqrt(aDeflection / aSample.deflection),
+                                             THE_MIN_BUDGET_ANGLE), 1.0);
+
+    MeshParameters aParams = theParams;
+    aParams.mode = MeshParameters::AbsoluteDeflection;
+    aParams.deflection = aDeflection;
+    aParams.angle = anAngle;
+
+    theFit.deflection = aDeflection;
+    theFit.angle = anAngle;
+    theFit.estimatedTriangles = theFit.fixedTriangles + qint64(aScaled / aDeflection);
+    theFit.elapsedMs = aTimer.elapsed();
+    Message::SendInfo() << "Mesh budget fit: " << theFit.summary().toStdString();
+    return aParams;
+}
+
+qint64 Tessellation::countTriangles(const TopoDS_Shape& theShape)
+{
+    // Placed faces: an instanced part counts as often as it is drawn
+    TopTools_IndexedMapOfShape aFaces;
+    TopExp::MapShapes(theShape, TopAbs_FACE, aFaces);
+    qint64 aNbTriangles = 0;
+    for (int anIdx = 1; anIdx <= aFaces.Extent(); ++anIdx) {
+        TopLoc_Location aLoc;
+        const Handle(Poly_Triangulation) aTri = BRep_Tool::Triangulation(TopoDS::Face(aFaces(anIdx)), aLoc);
+        if (!aTri.IsNull()) aNbTriangles += aTri->NbTriangles();
+    }
+    return aNbTriangles;
+}
+
+bool Tessellation::transferTriangulation(const TopoDS_Shape& theFrom, const TopoDS_Shape& theTo)
+{
+    // A copy lists its faces, and the edges of each face, in the order of the original
+    TopTools_IndexedMapOfShape aFromFaces;
+    TopTools_IndexedMapOfShape aToFaces;
+    TopExp::MapShapes(theFrom, TopAbs_FACE, aFromFaces);
+    TopExp::MapShapes(theTo, TopAbs_FACE, aToFaces);
+    if (aFromFaces.Extent() != aToFaces.Extent()) {
+        Message::SendWarning() << "Mesh transfer skipped: " << aFromFaces.Extent() << " faces in the level, "
+                               << aToFaces.Extent() << " in the model";
+        return false;
+    }
+
+    // Polygons of the old triangulation would otherwise stay on the edges
+    BRepTools::Clean(theTo);
+
+    BRep_Builder aBuilder;
+    for (int anIdx = 1; anIdx <= aFromFaces.Extent(); ++anIdx) {
+        const TopoDS_Face& aFromFace = TopoDS::Face(aFromFaces(anIdx));
+        const TopoDS_Face& aToFace = TopoDS::Face(aToFaces(anIdx));
+        TopLoc_Location aFromLoc;
+        const Handle(Poly_Triangulation) aTri = BRep_Tool::Triangulation(aFromFace, aFromLoc);
+        if (aTri.IsNull()) continue;
+        aBuilder.UpdateFace(aToFace, aTri);
+
+        TopExp_Explorer aFromExp(aFromFace, TopAbs_EDGE);
+        TopExp_Explorer aToExp(aToFace, TopAbs_EDGE);
+        for (; aFromExp.More() && aToExp.More(); aFromExp.Next(), aToExp.Next()) {
+            const TopoDS_Edge aFromEdge = TopoDS::Edge(aFromExp.Current().Oriented(TopAbs_FORWARD));
+            const TopoDS_Edge aToEdge = TopoDS::Edge(aToExp.Current().Oriented(TopAbs_FORWARD));
+            const Handle(Poly_PolygonOnTriangulation) aPoly =
+                BRep_Tool::PolygonOnTriangulation(aFromEdge, aTri, aFromLoc);
+            if (aPoly.IsNull()) continue;
+
+            if (BRep_Tool::IsClosed(aFromEdge, aFromFace)) {
+                // Seam: one polygon per side, the reversed edge reads the second one
+                const Handle(Poly_PolygonOnTriangulation) aPoly2 =
+                    BRep_Tool::PolygonOnTriangulation(TopoDS::Edge(aFromEdge.Reversed()), aTri, aFromLoc);
+                aBuilder.UpdateEdge(aToEdge, aPoly, aPoly2, aTri, aToFace.Location());
+            } else {
+                aBuilder.UpdateEdge(aToEdge, aPoly, aTri, aToFace.Location());
+            }
+        }
+    }
+    return true;
+}
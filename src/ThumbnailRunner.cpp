@@ -0,0 +1,365 @@
+// ThumbnailRunner.cpp
+#include "ThumbnailRunner.h"
+#include "BatchRunner.h"
+#include "CadModel.h"
+#include "ModelCache.h"
+#include "OcctGlTools.h"
+#include "OcctQtTools.h"
+
+#include <AIS_InteractiveContext.hxx>
+#include <AIS_Shape.hxx>
+#include <Aspect_DisplayConnection.hxx>
+#include <Message.hxx>
+#include <Message_Messenger.hxx>
+#include <Message_Printer.hxx>
+#include <OpenGl_GraphicDriver.hxx>
+#include <OSD_Environment.hxx>
+#include <Prs3d_Drawer.hxx>
+#include <Prs3d_LineAspect.hxx>
+#include <Standard_Failure.hxx>
+#include <V3d_View.hxx>
+#include <V3d_Viewer.hxx>
+
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFileInfo>
+#include <QImage>
+#include <QMetaObject>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <memory>
+
+namespace
+{
+    const int THE_DEFAULT_SIZE = 256;
+
+    struct ViewPreset {
+        const char* name;
+        V3d_TypeOfOrientation orientation;
+    };
+    const ViewPreset THE_VIEW_PRESETS[] = {
+        { "iso",    V3d_XposYnegZpos },
+        { "front",  V3d_Yneg },
+        { "back",   V3d_Ypos },
+        { "top",    V3d_Zpos },
+        { "bottom", V3d_Zneg },
+        { "left",   V3d_Xneg },
+        { "right",  V3d_Xpos }
+    };
+
+    //! One GL context, view and framebuffer object for every thumbnail of the run
+    class OffscreenRenderer
+    {
+    public:
+        ~OffscreenRenderer()
+        {
+            // OCCT releases its GL resources with the view, which needs the context current
+            if (myGlContext.isValid()) myGlContext.makeCurrent(&mySurface);
+            myContext.Nullify();
+            if (!myView.IsNull()) myView->Remove();
+            myView.Nullify();
+            myViewer.Nullify();
+            myFbo.reset();
+            if (myGlContext.isValid()) myGlContext.doneCurrent();
+        }
+
+        bool init(const QSize& theSize, int theMsaaSamples, QString& theError)
+        {
+            myGlContext.setFormat(OcctQtTools::qtGlSurfaceFormat());
+            if (!myGlContext.create()) {
+                theError = "No OpenGL context; without a display run under xvfb-run";
+                return false;
+            }
+            mySurface.setFormat(myGlContext.format());
+            mySurface.create();
+            if (!mySurface.isValid() || !myGlContext.makeCurrent(&mySurface)) {
+                theError = "Offscreen surface could not be made current";
+                return false;
+            }
+
+            QOpenGLFramebufferObjectFormat aFboFormat;
+            aFboFormat.setAttachment(QOpenGLFramebufferObject::CombinedDepthStencil);
+            myFbo = std::make_unique<QOpenGLFramebufferObject>(theSize, aFboFormat);
+            if (!myFbo->isValid() || !myFbo->bind()) {
+                theError = QString("Framebuffer object of %1x%2 not supported").arg(theSize.width()).arg(theSize.height());
+                return false;
+            }
+
+            try {
+                Handle(OpenGl_GraphicDriver) aDriver = new OpenGl_GraphicDriver(new Aspect_DisplayConnection(), false);
+                OcctQtTools::qtGlCapsFromSurfaceFormat(aDriver->ChangeOptions(), myGlContext.format());
+                // The FBO is read back, never presented
+                aDriver->ChangeOptions().buffersNoSwap = true;
+
+                myViewer = new V3d_Viewer(aDriver);
+                myViewer->SetDefaultBackgroundColor(Quantity_NOC_WHITE);
+                myViewer->SetDefaultLights();
+                myViewer->SetLightOn();
+                myContext = new AIS_InteractiveContext(myViewer);
+
+                myView = myViewer->CreateView();
+                myView->SetImmediateUpdate(false);
+                myView->ChangeRenderingParams().NbMsaaSamples = theMsaaSamples;
+                if (!OcctGlTools::InitializeGlWindow(myView, 0, Graphic3d_Vec2i(theSize.width(), theSize.height()), 1.0)
+                    || !OcctGlTools::InitializeGlFbo(myView)) {
+                    theError = "OCCT could not wrap the offscreen GL context";
+                    return false;
+                }
+            } catch (const Standard_Failure& e) {
+                theError = QString("OCCT viewer setup failed: ") + e.GetMessageString();
+                return false;
+            }
+            return true;
+        }
+
+        bool render(const TopoDS_Shape& theShape, V3d_TypeOfOrientation theOrientation, QImage& theImage)
+        {
+            if (!myGlContext.makeCurrent(&mySurface) || !myFbo->bind()) return false;
+
+            Handle(AIS_Shape) aShapeAIS = new AIS_Shape(theShape);
+            try {
+                OcctGlTools::InitializeGlFbo(myView);
+
+                aShapeAIS->SetColor(Quantity_NOC_LIGHTGRAY);
+                aShapeAIS->SetMaterial(Graphic3d_NOM_PLASTIC);
+                Handle(Prs3d_Drawer) aDrawer = aShapeAIS->Attributes();
+                aDrawer->SetFaceBoundaryDraw(Standard_True);
+                aDrawer->SetFaceBoundaryAspect(new Prs3d_LineAspect(Quantity_NOC_BLACK, Aspect_TOL_SOLID, 1.0));
+                aDrawer->SetAutoTriangulation(Standard_False);
+                // Nothing is ever picked here: no selection structures
+                myContext->Display(aShapeAIS, AIS_Shaded, -1, Standard_False);
+
+                myView->SetProj(theOrientation, Standard_False);
+                myView->FitAll(0.05, Standard_False);
+
+                OcctGlTools::ResetGlStateBeforeOcct(myView);
+                myView->Redraw();
+                OcctGlTools::ResetGlStateAfterOcct(myView);
+                theImage = myFbo->toImage();
+            } catch (const Standard_Failure& e) {
+                Message::SendWarning() << "Thumbnail render failed: " << e.GetMessageString();
+                theImage = QImage();
+            }
+            myContext->Remove(aShapeAIS, Standard_False);
+            return !theImage.isNull();
+        }
+
+    private:
+        QOffscreenSurface mySurface;
+        QOpenGLContext myGlContext;
+        std::unique_ptr<QOpenGLFramebufferObject> myFbo;
+        Handle(V3d_Viewer) myViewer;
+        Handle(V3d_View) myView;
+        Handle(AIS_InteractiveContext) myContext;
+    };
+}
+
+bool ThumbnailRunner::isRequested(int theArgc, char* theArgv[])
+{
+    for (int anIdx = 1; anIdx < theArgc; ++anIdx) {
+        if (std::strcmp(theArgv[anIdx], "--thumbnails") == 0) return true;
+    }
+    return false;
+}
+
+void ThumbnailRunner::platformSetup()
+{
+    // No window is ever shown; an explicit QT_QPA_PLATFORM still wins
+    OSD_Environment aQpaPlat("QT_QPA_PLATFORM");
+    if (aQpaPlat.Value().IsEmpty()) {
+        aQpaPlat.SetValue("offscreen");
+        aQpaPlat.Build();
+    }
+    QSurfaceFormat::setDefaultFormat(OcctQtTools::qtGlSurfaceFormat());
+}
+
+int ThumbnailRunner::run(const QStringList& theArguments)
+{
+    QCommandLineParser aParser;
+    aParser.setApplicationDescription("Render PNG thumbnails of CAD files offscreen.");
+    aParser.addHelpOption();
+    const QCommandLineOption aThumbOption("thumbnails", "Render thumbnails of the given files or directories.");
+    const QCommandLineOption anOutOption(QStringList() << "o" << "out", "Directory for the PNG files.", "dir");
+    const QCommandLineOption aSizeOption("size", QString("Image width and height in pixels (default: %1).")
+                                                     .arg(THE_DEFAULT_SIZE), "px");
+    const QCommandLineOption aViewOption("view", "Camera preset: iso, front, back, top, bottom, left or right (default: iso).",
+                                         "preset");
+    const QCommandLineOption aMsaaOption("msaa", "Multisampling samples, 0 = off (default: 4).", "n");
+    const QCommandLineOption aJobsOption(QStringList() << "j" << "jobs",
+                                         "Files loaded and meshed concurrently (default: CPU cores); with OCCT before 7.8 "
+                                         "STEP/IGES transfers still run one at a time.", "n");
+    const QCommandLineOption aNoCacheOption("no-cache", "Bypass the model cache.");
+    const QCommandLineOption aVerboseOption("verbose", "Print the reader messages.");
+    aParser.addOptions({ aThumbOption, anOutOption, aSizeOption, aViewOption, aMsaaOption, aJobsOption,
+                         aNoCacheOption, aVerboseOption });
+    aParser.addPositionalArgument("inputs", "STEP, IGES, BREP, STL, OBJ or PLY files, or directories containing them.",
+                                  "[inputs...]");
+    aParser.process(theArguments);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QStringList aSkipped;
+    const QStringList aFiles = BatchRunner::collectInputs(aParser.positionalArguments(), aSkipped);
+    for (const QString& aPath : aSkipped) {
+        err << "Skipped (not a supported CAD file): " << aPath << "\n";
+    }
+    if (aFiles.isEmpty() || !aParser.isSet(anOutOption)) {
+        err << (aFiles.isEmpty() ? "No input files.\n" : "Missing --out directory.\n");
+        err << aParser.helpText();
+        return 2;
+    }
+
+    const auto intOption = [&](const QCommandLineOption& theOption, int theDefault, int theMin, int& theValue) {
+        theValue = theDefault;
+        if (!aParser.isSet(theOption)) return true;
+        bool isOk = false;
+        theValue = aParser.value(theOption).toInt(&isOk);
+        if (isOk && theValue >= theMin) return true;
+        err << "Invalid --" << theOption.names().constLast() << " value: " << aParser.value(theOption) << "\n";
+        return false;
+    };
+    int aSize = 0, aMsaa = 0, aJobs = 0;
+    if (!intOption(aSizeOption, THE_DEFAULT_SIZE, 16, aSize) || !intOption(aMsaaOption, 4, 0, aMsaa)
+        || !intOption(aJobsOption, QThread::idealThreadCount(), 1, aJobs)) {
+        return 2;
+    }
+
+    const QString aViewName = aParser.value(aViewOption).toLower();
+    const ViewPreset* aPreset = &THE_VIEW_PRESETS[0];
+    if (!aViewName.isEmpty()) {
+        aPreset = std::find_if(std::begin(THE_VIEW_PRESETS), std::end(THE_VIEW_PRESETS),
+                               [&aViewName](const ViewPreset& thePreset) { return aViewName == thePreset.name; });
+        if (aPreset == std::end(THE_VIEW_PRESETS)) {
+            err << "Unknown --view preset: " << aViewName << "\n";
+            return 2;
+        }
+    }
+
+    const QDir anOutDir(aParser.value(anOutOption));
+    if (!anOutDir.mkpath(".")) {
+        err << "Cannot create output directory " << anOutDir.path() << "\n";
+        return 2;
+    }
+
+    if (!aParser.isSet(aVerboseOption)) {
+        const Message_SequenceOfPrinters& aPrinters = Message::DefaultMessenger()->Printers();
+        for (Message_SequenceOfPrinters::Iterator anIter(aPrinters); anIter.More(); anIter.Next()) {
+            anIter.Value()->SetTraceLevel(Message_Warning);
+        }
+    }
+
+    OffscreenRenderer aRenderer;
+    QString anError;
+    if (!aRenderer.init(QSize(aSize, aSize), aMsaa, anError)) {
+        err << anError << "\n";
+        return 2;
+    }
+
+    CadLoadOptions anOptions;
+    anOptions.useModelCache = !aParser.isSet(aNoCacheOption);
+    anOptions.parallelTransfer = false;
+    // Half a pixel once the model fills the image; the level is cached under its own key
+    anOptions.mesh.deflection = 0.5 / aSize;
+    anOptions.mesh.threads = aJobs > 1 ? 1 : 0;
+
+    const QStringList aNames = BatchRunner::outputNames(aFiles, QStringList());
+    out << "Rendering " << aFiles.size() << " thumbnails of " << aSize << " px, " << aPreset->name << " view, "
+        << aJobs << " loader threads\n";
+    out.flush();
+
+    int aFinished = 0;
+    int aNbDone = 0;
+    qint64 aLoadMsTotal = 0;
+    qint64 aRenderMsTotal = 0;
+    QElapsedTimer aTotalTimer;
+    aTotalTimer.start();
+
+    // Loads run ahead on the pool, rendering follows on this thread in completion order
+    QEventLoop aLoop;
+    QThreadPool aPool;
+    aPool.setMaxThreadCount(aJobs);
+    for (int anIdx = 0; anIdx < aFiles.size(); ++anIdx) {
+        const QString aPath = aFiles.at(anIdx);
+        const QString aPngPath = anOutDir.absoluteFilePath(aNames.at(anIdx) + ".png");
+        aPool.start([&, aPath, aPngPath]() {
+            QElapsedTimer aTimer;
+            aTimer.start();
+            TopoDS_Shape aShape;
+            QString aLoadError;
+            try {
+                const QString aFormat = CadModelManager::getFileFormatFromExtension(aPath);
+                CadLoadOptions aLoadOptions = anOptions;
+                CadLoadReport aReport;
+                if (aFormat != "STEP" || CadModelManager::prescanStep(aPath, aLoadOptions, aReport)) {
+                    aShape = CadModelManager::loadShape(aPath, aFormat, aLoadOptions, Message_ProgressRange(), aReport);
+                }
+                if (aShape.IsNull()) {
+                    aLoadError = aReport.error.isEmpty() ? QString("No shape could be read") : aReport.error;
+                } else if (!aReport.meshFromCache && !aReport.meshFromFile) {
+                    Tessellation::mesh(aShape, aLoadOptions.mesh);
+                    if (aLoadOptions.useModelCache && !aReport.cacheKey.isEmpty()) {
+                        ModelCache aCache(aLoadOptions.cacheDirectory, aLoadOptions.cacheMaxBytes);
+                        aCache.store(ModelCache::meshKey(aReport.cacheKey, aLoadOptions.mesh.levelKey()), aShape, true);
+                    }
+                }
+            } catch (const Standard_Failure& e) {
+                aShape.Nullify();
+                aLoadError = QString("OCCT error: ") + e.GetMessageString();
+            }
+            const qint64 aLoadMs = aTimer.elapsed();
+
+            QMetaObject::invokeMethod(&aLoop, [&, aPath, aPngPath, aShape, aLoadError, aLoadMs]() {
+                QElapsedTimer aRenderTimer;
+                aRenderTimer.start();
+                QString aFileError = aLoadError;
+                if (aFileError.isEmpty()) {
+                    QImage anImage;
+                    if (!aRenderer.render(aShape, aPreset->orientation, anImage)) {
+                        aFileError = "Render failed";
+                    } else if (!anImage.save(aPngPath, "PNG")) {
+                        aFileError = "Could not write " + aPngPath;
+                    }
+                }
+                const qint64 aRenderMs = aRenderTimer.elapsed();
+                aLoadMsTotal += aLoadMs;
+                aRenderMsTotal += aRenderMs;
+                if (aFileError.isEmpty()) ++aNbDone;
+
+                ++aFinished;
+                out << QString("[%1/%2] %3 load %4 ms, render %5 ms  %6")
+                           .arg(aFinished, QString::number(aFiles.size()).size())
+                           .arg(aFiles.size())
+                           .arg(aFileError.isEmpty() ? QString("ok    ") : QString("FAILED"))
+                           .arg(aLoadMs, 6)
+                           .arg(aRenderMs, 4)
+                           .arg(QFileInfo(aPath).fileName());
+                if (!aFileError.isEmpty()) out << "  " << aFileError;
+                out << "\n";
+                out.flush();
+                if (aFinished == aFiles.size()) aLoop.quit();
+            }, Qt::QueuedConnection);
+        });
+    }
+    aLoop.exec();
+    aPool.waitForDone();
+
+    const double aSeconds = std::max(aTotalTimer.elapsed(), qint64(1)) / 1000.0;
+    out << QString("%1 of %2 thumbnails in %3 s, %4 thumbnails/s (load %5 ms, render %6 ms per file on average)\n")
+               .arg(aNbDone).arg(aFiles.size())
+               .arg(aSeconds, 0, 'f', 1)
+               .arg(aFiles.size() / aSeconds, 0, 'f', 1)
+               .arg(aLoadMsTotal / aFiles.size())
+               .arg(aRenderMsTotal / aFiles.size());
+    return aNbDone == aFiles.size() ? 0 : 1;
+}
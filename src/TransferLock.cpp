@@ -0,0 +1,26 @@
+// TransferLock.cpp
+#include "TransferLock.h"
+
+#include <Standard_Version.hxx>
+
+namespace
+{
+    std::mutex THE_TRANSFER_MUTEX;
+}
+
+TransferLock::TransferLock(Format theFormat)
+    : myLock(THE_TRANSFER_MUTEX, std::defer_lock)
+{
+    // From OCCT 7.8 on every STEP transfer has its own StepData_Factors
+    if (!isParallelSafe(theFormat)) myLock.lock();
+}
+
+bool TransferLock::isParallelSafe(Format theFormat)
+{
+#if (OCC_VERSION_HEX >= 0x070800)
+    return theFormat == Step;
+#else
+    (void)theFormat;
+    return false;
+#endif
+}
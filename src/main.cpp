@@ -5,9 +5,24 @@
 #include <QStyleFactory>
 #include "OcctQMainWindowSample.h"
 #include "OcctQtTools.h"
+#include "BatchRunner.h"
+#include "ThumbnailRunner.h"
 
 int main(int argc, char* argv[])
 {
+    // Headless batch mode: no GL platform setup and no widgets
+    if (BatchRunner::isRequested(argc, argv)) {
+        QCoreApplication app(argc, argv);
+        return BatchRunner::run(app.arguments());
+    }
+
+    // Offscreen thumbnails: a GL context but no window
+    if (ThumbnailRunner::isRequested(argc, argv)) {
+        ThumbnailRunner::platformSetup();
+        QGuiApplication app(argc, argv);
+        return ThumbnailRunner::run(app.arguments());
+    }
+
     // Setup Qt platform before creating QApplication
     OcctQtTools::qtGlPlatformSetup();
 